@@ -0,0 +1,148 @@
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__APPLE__)
+    #include <mach/mach.h>
+#elif defined(__linux__)
+    #include <unistd.h>
+#endif
+
+const char *const ALLOCATION_PHASE_NAMES[ALLOCATION_PHASE_COUNT] = { "other", "input", "update", "record", "present" };
+
+// Keeps the block behind it aligned like malloc's
+constexpr size_t HEADER_SIZE = 16;
+
+// Zero-initialised before any constructor runs, so allocations during static init are counted
+static std::atomic<uint64_t> s_allocations[ALLOCATION_PHASE_COUNT];
+static std::atomic<uint64_t> s_bytes[ALLOCATION_PHASE_COUNT];
+static std::atomic<uint64_t> s_frees[ALLOCATION_PHASE_COUNT];
+static std::atomic<int64_t>  s_live_bytes;
+
+static thread_local AllocationPhase t_phase = ALLOCATION_OTHER;
+
+// ————— TRACKED BLOCKS ————— //
+void *tracked_malloc(size_t size)
+{
+    unsigned char *block = (unsigned char *) malloc(size + HEADER_SIZE);
+    if (block == nullptr) return nullptr;
+
+    memcpy(block, &size, sizeof(size));
+    s_allocations[t_phase].fetch_add(1, std::memory_order_relaxed);
+    s_bytes[t_phase].fetch_add(size, std::memory_order_relaxed);
+    s_live_bytes.fetch_add((int64_t) size, std::memory_order_relaxed);
+    return block + HEADER_SIZE;
+}
+
+void tracked_free(void *pointer)
+{
+    if (pointer == nullptr) return;
+
+    unsigned char *block = (unsigned char *) pointer - HEADER_SIZE;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+
+    s_frees[t_phase].fetch_add(1, std::memory_order_relaxed);
+    s_live_bytes.fetch_sub((int64_t) size, std::memory_order_relaxed);
+    free(block);
+}
+
+void *tracked_realloc(void *pointer, size_t size)
+{
+    if (pointer == nullptr) return tracked_malloc(size);
+
+    size_t old_size;
+    memcpy(&old_size, (unsigned char *) pointer - HEADER_SIZE, sizeof(old_size));
+
+    void *resized = tracked_malloc(size);
+    if (resized == nullptr) return nullptr;
+
+    memcpy(resized, pointer, old_size < size ? old_size : size);
+    tracked_free(pointer);
+    return resized;
+}
+
+// ————— GLOBAL OPERATOR NEW / DELETE ————— //
+void *operator new(size_t size)
+{
+    void *pointer = tracked_malloc(size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept   { return tracked_malloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return tracked_malloc(size); }
+
+void operator delete(void *pointer) noexcept                          { tracked_free(pointer); }
+void operator delete[](void *pointer) noexcept                        { tracked_free(pointer); }
+void operator delete(void *pointer, size_t) noexcept                  { tracked_free(pointer); }
+void operator delete[](void *pointer, size_t) noexcept                { tracked_free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept   { tracked_free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { tracked_free(pointer); }
+
+// ————— COUNTS ————— //
+AllocationCounts allocation_phase_totals(AllocationPhase phase)
+{
+    AllocationCounts counts;
+    counts.allocations = s_allocations[phase].load(std::memory_order_relaxed);
+    counts.bytes       = s_bytes[phase].load(std::memory_order_relaxed);
+    counts.frees       = s_frees[phase].load(std::memory_order_relaxed);
+    return counts;
+}
+
+AllocationCounts allocation_totals()
+{
+    AllocationCounts totals;
+    for (int phase = 0; phase < ALLOCATION_PHASE_COUNT; phase++)
+    {
+        AllocationCounts counts = allocation_phase_totals((AllocationPhase) phase);
+        totals.allocations += counts.allocations;
+        totals.bytes       += counts.bytes;
+        totals.frees       += counts.frees;
+    }
+    return totals;
+}
+
+int64_t const allocation_live_bytes()
+{
+    return s_live_bytes.load(std::memory_order_relaxed);
+}
+
+AllocationPhaseScope::AllocationPhaseScope(AllocationPhase phase) : m_previous(t_phase)
+{
+    t_phase = phase;
+}
+
+AllocationPhaseScope::~AllocationPhaseScope()
+{
+    t_phase = m_previous;
+}
+
+// ————— RESIDENT SET ————— //
+size_t current_rss_bytes()
+{
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) return 0;
+    return (size_t) info.resident_size;
+#elif defined(__linux__)
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file == nullptr) return 0;
+
+    unsigned long total_pages = 0, resident_pages = 0;
+    int read = fscanf(file, "%lu %lu", &total_pages, &resident_pages);
+    fclose(file);
+    return read == 2 ? (size_t) resident_pages * (size_t) sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,56 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counts every heap allocation: global operator new/delete are replaced in
+// AllocationTracker.cpp, and stb_image is pointed at tracked_malloc and friends. Each block
+// carries a small header with its size, so frees are counted in bytes too.
+//
+// Allocations are charged to the phase set on the allocating thread, so a frame's numbers can
+// be split into input, update, recording and presenting.
+
+enum AllocationPhase
+{
+    ALLOCATION_OTHER,     // Startup, shutdown, and threads that never set a phase
+    ALLOCATION_INPUT,
+    ALLOCATION_UPDATE,
+    ALLOCATION_RECORD,    // Recording the frame's render commands
+    ALLOCATION_PRESENT,   // Executing them on the render thread
+    ALLOCATION_PHASE_COUNT
+};
+extern const char *const ALLOCATION_PHASE_NAMES[ALLOCATION_PHASE_COUNT];
+
+struct AllocationCounts
+{
+    uint64_t allocations = 0;
+    uint64_t bytes       = 0;
+    uint64_t frees       = 0;
+};
+
+// Since startup. Subtract two snapshots for a frame's or a phase's worth.
+AllocationCounts allocation_totals();
+AllocationCounts allocation_phase_totals(AllocationPhase phase);
+int64_t const    allocation_live_bytes();
+
+// Sets the calling thread's phase until the end of the scope
+class AllocationPhaseScope
+{
+private:
+    AllocationPhase m_previous;
+
+public:
+    explicit AllocationPhaseScope(AllocationPhase phase);
+    ~AllocationPhaseScope();
+};
+
+// For STBI_MALLOC, STBI_REALLOC and STBI_FREE
+void *tracked_malloc(size_t size);
+void *tracked_realloc(void *pointer, size_t size);
+void  tracked_free(void *pointer);
+
+// Resident set size of the process, or 0 where the platform doesn't say
+size_t current_rss_bytes();
+
+#endif // ALLOCATION_TRACKER_H
@@ -0,0 +1,165 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "AssetFileSystem.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "BinaryFile.h"
+
+AssetFileSystem g_assets;
+
+// File layout, all little-endian:
+//   "LLPK" | u32 version | u32 entry count | u32 path bytes |
+//   entries of u64 path hash | u64 offset | u64 size | u32 path offset | u32 path length |
+//   the paths, back to back with no terminators | each file's bytes, on DATA_ALIGNMENT boundaries
+constexpr char     PACK_MAGIC[4] = { 'L', 'L', 'P', 'K' };
+constexpr uint32_t PACK_VERSION  = 1;
+constexpr size_t   HEADER_SIZE    = 16;
+constexpr size_t   ENTRY_SIZE     = 32;
+constexpr size_t   DATA_ALIGNMENT = 16;
+
+// ————— MOUNTING ————— //
+bool AssetFileSystem::mount(const char *filename)
+{
+    unmount();
+
+    std::string candidates[] = { m_base_path + filename, filename };
+    for (const std::string &candidate : candidates)
+    {
+        if (!m_pack.open(candidate.c_str())) continue;
+
+        const unsigned char *data = m_pack.get_data();
+        size_t size = m_pack.get_size();
+        bool valid = size >= HEADER_SIZE &&
+                     memcmp(data, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                     get_u32(data + 4) == PACK_VERSION;
+
+        uint32_t count      = valid ? get_u32(data + 8)  : 0;
+        uint32_t path_bytes = valid ? get_u32(data + 12) : 0;
+        size_t   paths      = HEADER_SIZE + (size_t) count * ENTRY_SIZE;
+        valid = valid && paths + path_bytes <= size;
+
+        for (uint32_t i = 0; valid && i < count; i++)
+        {
+            const unsigned char *record = data + HEADER_SIZE + i * ENTRY_SIZE;
+            uint32_t path_offset = get_u32(record + 24), path_length = get_u32(record + 28);
+
+            Entry entry;
+            entry.path_hash = get_u64(record);
+            entry.offset    = get_u64(record + 8);
+            entry.size      = get_u64(record + 16);
+
+            // Nothing in a truncated or damaged pack may point past its end
+            valid = (uint64_t) path_offset + path_length <= path_bytes &&
+                    entry.offset <= size && entry.size <= size - entry.offset;
+            if (valid) entry.path.assign((const char *) data + paths + path_offset, path_length);
+            m_entries.push_back(entry);
+        }
+
+        if (valid)
+        {
+            m_pack_path = candidate;
+            return true;
+        }
+        unmount();
+    }
+    return false;
+}
+
+void AssetFileSystem::unmount()
+{
+    m_entries.clear();
+    m_pack.close();
+    m_pack_path.clear();
+}
+
+// ————— READING ————— //
+bool AssetFileSystem::open_loose(const char *path, AssetFile &file) const
+{
+    std::unique_ptr<MappedFile> loose(new MappedFile());
+    if (!loose->open((m_base_path + path).c_str()) && !loose->open(path)) return false;
+
+    file.m_data  = loose->get_data();
+    file.m_size  = loose->get_size();
+    file.m_loose = std::move(loose);
+    return true;
+}
+
+AssetFile AssetFileSystem::open(const char *path) const
+{
+    AssetFile file;
+    uint64_t path_hash = hash_bytes(path, strlen(path));
+    for (const Entry &entry : m_entries)
+    {
+        if (entry.path_hash != path_hash || entry.path != path) continue;
+
+        file.m_data = m_pack.get_data() + entry.offset;
+        file.m_size = (size_t) entry.size;
+        return file;
+    }
+
+    open_loose(path, file);
+    return file;
+}
+
+// ————— PACKING ————— //
+bool AssetFileSystem::build_pack(const char *pack_path, const std::vector<const char *> &paths,
+                                 const PackTransform &transform) const
+{
+    // Always from loose files, so a stale mounted pack can't end up inside the new one
+    std::vector<AssetFile> files(paths.size());
+    std::vector<std::vector<unsigned char>> transformed(paths.size());
+    std::vector<const unsigned char *> contents(paths.size());
+    std::vector<size_t> sizes(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        if (!open_loose(paths[i], files[i]))
+        {
+            LOG("Asset pack: could not read " << paths[i]);
+            return false;
+        }
+
+        bool replaced = transform && transform(paths[i], files[i], transformed[i]);
+        contents[i] = replaced ? transformed[i].data() : files[i].get_data();
+        sizes[i]    = replaced ? transformed[i].size() : files[i].get_size();
+    }
+
+    FILE *file = open_replacement(pack_path);
+    if (file == nullptr) return false;
+
+    size_t path_bytes = 0;
+    for (const char *path : paths) path_bytes += strlen(path);
+
+    fwrite(PACK_MAGIC, 1, sizeof(PACK_MAGIC), file);
+    write_u32(file, PACK_VERSION);
+    write_u32(file, (uint32_t) paths.size());
+    write_u32(file, (uint32_t) path_bytes);
+
+    size_t offset = align_up(HEADER_SIZE + paths.size() * ENTRY_SIZE + path_bytes, DATA_ALIGNMENT);
+    size_t path_offset = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        size_t path_length = strlen(paths[i]);
+        write_u64(file, hash_bytes(paths[i], path_length));
+        write_u64(file, offset);
+        write_u64(file, sizes[i]);
+        write_u32(file, (uint32_t) path_offset);
+        write_u32(file, (uint32_t) path_length);
+        offset       = align_up(offset + sizes[i], DATA_ALIGNMENT);
+        path_offset += path_length;
+    }
+    for (const char *path : paths) fwrite(path, 1, strlen(path), file);
+
+    static const unsigned char PADDING[DATA_ALIGNMENT] = {};
+    size_t written = HEADER_SIZE + paths.size() * ENTRY_SIZE + path_bytes;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        fwrite(PADDING, 1, align_up(written, DATA_ALIGNMENT) - written, file);
+        written = align_up(written, DATA_ALIGNMENT);
+
+        fwrite(contents[i], 1, sizes[i], file);
+        written += sizes[i];
+    }
+
+    return replace_file_atomically(file, pack_path);
+}
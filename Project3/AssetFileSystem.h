@@ -0,0 +1,79 @@
+#ifndef ASSET_FILE_SYSTEM_H
+#define ASSET_FILE_SYSTEM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// The bytes of one asset: a view into the mounted pack, or a loose file mapped on its own.
+// Either way nothing is copied; the view lasts as long as this object and the mount.
+class AssetFile
+{
+private:
+    std::unique_ptr<MappedFile> m_loose;
+    const unsigned char        *m_data = nullptr;
+    size_t                      m_size = 0;
+
+    friend class AssetFileSystem;
+
+public:
+    const unsigned char *const get_data() const { return m_data; }
+    size_t               const get_size() const { return m_size; }
+    bool                 const is_open()  const { return m_data != nullptr; }
+};
+
+// Where textures and shaders are read from. A mounted pack is one file mapped once, holding
+// every asset under the relative path the game asks for; anything not in it, or everything
+// when nothing is mounted, is looked up beside the executable and then in the working
+// directory. open() only reads shared state, so decode jobs can call it from any thread.
+class AssetFileSystem
+{
+public:
+    // Given a file going into a pack, fills `out` and returns true to store that instead
+    typedef std::function<bool(const char *path, const AssetFile &source, std::vector<unsigned char> &out)> PackTransform;
+
+private:
+    struct Entry
+    {
+        uint64_t    path_hash;
+        uint64_t    offset;
+        uint64_t    size;
+        std::string path;
+    };
+
+    MappedFile         m_pack;
+    std::vector<Entry> m_entries;
+    std::string        m_pack_path;
+    std::string        m_base_path;   // The executable's directory, with its trailing separator
+
+    bool open_loose(const char *path, AssetFile &file) const;
+
+public:
+    void set_base_path(const char *base_path) { m_base_path = base_path != nullptr ? base_path : ""; }
+
+    // Looks for `filename` beside the executable, then in the working directory. False if
+    // neither has a valid pack, which leaves loose files in use.
+    bool mount(const char *filename);
+    void unmount();
+
+    AssetFile open(const char *path) const;
+
+    // Packs the loose files at `paths` under those same paths, each passed through `transform`
+    // if there is one. Writes beside `pack_path` and renames over it, so a mounted copy is never
+    // half written.
+    bool build_pack(const char *pack_path, const std::vector<const char *> &paths,
+                    const PackTransform &transform = nullptr) const;
+
+    bool        const is_mounted()     const { return m_pack.is_open(); }
+    int         const get_file_count() const { return (int) m_entries.size(); }
+    size_t      const get_pack_size()  const { return m_pack.get_size(); }
+    const char *const get_pack_path()  const { return m_pack_path.c_str(); }
+};
+
+extern AssetFileSystem g_assets;
+
+#endif // ASSET_FILE_SYSTEM_H
@@ -0,0 +1,329 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "AssetLoader.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "AllocationTracker.h"
+#include "AssetFileSystem.h"
+#include "BinaryFile.h"
+#include "Profiler.h"
+#include "Qoi.h"
+#include "stb_image.h"
+
+// Every image allocation carries its size and where it came from, so a free on any thread
+// knows whether there is heap to give back
+constexpr size_t HEADER_SIZE  = 16;
+constexpr size_t ALIGNMENT    = 16;
+constexpr size_t REGION_SLACK = 4096;   // For the decoder's own bookkeeping
+
+struct ImageHeader
+{
+    size_t size;
+    size_t in_arena;
+};
+
+static thread_local LoadArena::Region *t_region = nullptr;
+
+// ————— LOAD ARENA ————— //
+LoadArena::Region LoadArena::reserve(size_t size)
+{
+    size = align_up(size, ALIGNMENT);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_blocks.empty() || m_blocks.back().size - m_blocks.back().used < size)
+    {
+        size_t block_size = std::max(size, BLOCK_SIZE);
+        unsigned char *data = (unsigned char *) tracked_malloc(block_size);
+        if (data == nullptr) return Region();
+        m_blocks.push_back({ data, block_size, 0 });
+    }
+
+    Block &block = m_blocks.back();
+    Region region;
+    region.begin  = block.data + block.used;
+    region.cursor = region.begin;
+    region.end    = region.begin + size;
+    block.used       += size;
+    m_reserved_bytes += size;
+    return region;
+}
+
+void LoadArena::release()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Block &block : m_blocks) tracked_free(block.data);
+    m_blocks.clear();
+    m_reserved_bytes = 0;
+}
+
+// ————— IMAGE ALLOCATIONS ————— //
+ArenaScope::ArenaScope(LoadArena::Region *region) : m_previous(t_region) { t_region = region; }
+ArenaScope::~ArenaScope() { t_region = m_previous; }
+
+void *image_malloc(size_t size)
+{
+    size_t block_size = HEADER_SIZE + align_up(size, ALIGNMENT);
+    unsigned char *block;
+    bool in_arena = t_region != nullptr && (size_t) (t_region->end - t_region->cursor) >= block_size;
+
+    if (in_arena)
+    {
+        block = t_region->cursor;
+        t_region->cursor += block_size;
+        t_region->last    = block;
+    }
+    else
+    {
+        block = (unsigned char *) tracked_malloc(block_size);
+        if (block == nullptr) return nullptr;
+    }
+
+    ImageHeader header = { size, in_arena ? 1u : 0u };
+    memcpy(block, &header, sizeof(header));
+    return block + HEADER_SIZE;
+}
+
+void image_free(void *pointer)
+{
+    if (pointer == nullptr) return;
+
+    unsigned char *block = (unsigned char *) pointer - HEADER_SIZE;
+    ImageHeader header;
+    memcpy(&header, block, sizeof(header));
+
+    if (!header.in_arena) tracked_free(block);
+    else if (t_region != nullptr && t_region->last == block)
+    {
+        // Undoing the newest allocation lets the next one reuse its space
+        t_region->cursor = block;
+        t_region->last   = nullptr;
+    }
+}
+
+void *image_realloc(void *pointer, size_t size)
+{
+    if (pointer == nullptr) return image_malloc(size);
+
+    unsigned char *block = (unsigned char *) pointer - HEADER_SIZE;
+    ImageHeader header;
+    memcpy(&header, block, sizeof(header));
+
+    // stb_image grows the buffer it is inflating into, which is nearly always the newest one
+    size_t block_size = HEADER_SIZE + align_up(size, ALIGNMENT);
+    if (header.in_arena && t_region != nullptr && t_region->last == block
+        && (size_t) (t_region->end - block) >= block_size)
+    {
+        t_region->cursor = block + block_size;
+        header.size = size;
+        memcpy(block, &header, sizeof(header));
+        return pointer;
+    }
+
+    void *resized = image_malloc(size);
+    if (resized == nullptr) return nullptr;
+
+    memcpy(resized, pointer, std::min(header.size, size));
+    image_free(pointer);
+    return resized;
+}
+
+// ————— ASSET LOADER ————— //
+void AssetLoader::decode(ImageLoad &load)
+{
+    PROFILE_SCOPE("decode image");
+    Uint64 start = SDL_GetPerformanceCounter();
+    DecodedImage &image = load.image;
+
+    // The source is hashed first, since that decides whether the cache can stand in for it
+    AssetFile source = g_assets.open(image.filepath);
+    const unsigned char *source_data = source.get_data();
+    size_t source_size = source.get_size();
+    CachedImage cached;
+    if (source.is_open())
+    {
+        load.source_hash = hash_bytes(source_data, source_size);
+        load.from_cache  = m_cache.find(image.filepath, load.source_hash, cached);
+    }
+
+    // A hit is already packed, and only needs unpacking if something wants the RGBA8 pixels
+    if (load.from_cache)
+    {
+        image.width   = cached.width;
+        image.height  = cached.height;
+        image.format  = cached.format;
+        image.texels  = cached.texels;
+        image.palette = cached.palette;
+        if (image.format == TEXTURE_RGBA8) image.pixels = image.texels;
+
+        if (image.pixels == nullptr && (m_keep_pixels || !m_pack_formats))
+        {
+            LoadArena::Region region = m_arena.reserve((size_t) image.width * image.height * 4);
+            if (region.begin != nullptr)
+            {
+                unpack_texture(image.format, image.texels, image.palette, image.width, image.height, region.begin);
+                image.pixels = region.begin;
+            }
+        }
+        if (!m_pack_formats)
+        {
+            image.format  = TEXTURE_RGBA8;
+            image.texels  = image.pixels;
+            image.palette = nullptr;
+        }
+
+        load.decode_ticks = SDL_GetPerformanceCounter() - start;
+        return;
+    }
+
+    // QOI is told apart by its magic bytes, whatever the file is called, and decodes in one
+    // pass straight into the pixels it returns
+    int width = 0, height = 0, components = 0;
+    if (source.is_open() && qoi_read_header(source_data, source_size, width, height))
+    {
+        size_t pixel_bytes = (size_t) width * height * 4;
+        LoadArena::Region region = m_arena.reserve(pixel_bytes + REGION_SLACK);
+
+        ArenaScope scope(&region);
+        unsigned char *pixels = (unsigned char *) image_malloc(pixel_bytes);
+        if (pixels != nullptr && qoi_decode(source_data, source_size, pixels, width, height))
+        {
+            image.pixels = pixels;
+            image.width  = width;
+            image.height = height;
+        }
+        else image_free(pixels);
+    }
+
+    // Room for the compressed data as stb_image collects it, the inflated rows, the unfiltered
+    // image and, unless it is RGBA already, its conversion; all are live at once
+    else if (source.is_open() && stbi_info_from_memory(source_data, (int) source_size, &width, &height, &components))
+    {
+        size_t pixel_bytes = (size_t) width * height * STBI_rgb_alpha;
+        size_t buffers     = components == STBI_rgb_alpha ? 2 : 3;
+        LoadArena::Region region = m_arena.reserve(source_size * 2 + pixel_bytes * buffers + height + REGION_SLACK);
+
+        ArenaScope scope(&region);
+        image.pixels = stbi_load_from_memory(source_data, (int) source_size, &image.width, &image.height,
+                                             &components, STBI_rgb_alpha);
+    }
+
+    // The packed copy lives in the arena too, and goes when loading is over
+    image.texels = image.pixels;
+    if (m_pack_formats && image.pixels != nullptr)
+    {
+        size_t texel_bytes = (size_t) image.width * image.height * 2;
+        LoadArena::Region region = m_arena.reserve(texel_bytes + PALETTE_BYTES);
+        if (region.begin != nullptr)
+        {
+            image.format = pack_texture(image.pixels, image.width, image.height, region.begin,
+                                        region.begin + texel_bytes);
+            if (image.format != TEXTURE_RGBA8) image.texels = region.begin;
+            if (image.format == TEXTURE_INDEXED) image.palette = region.begin + texel_bytes;
+        }
+    }
+
+    load.decode_ticks = SDL_GetPerformanceCounter() - start;
+}
+
+void AssetLoader::use_cache(const char *filepath)
+{
+    m_cache_path = filepath;
+    m_cache.open(filepath);
+}
+
+int AssetLoader::queue(const char *filepath)
+{
+    m_loads.emplace_back(new ImageLoad());
+    ImageLoad *load = m_loads.back().get();
+    load->image = { filepath, nullptr, 0, 0, TEXTURE_RGBA8, nullptr, nullptr };
+
+    // Without a running job system this decodes right away, which is still correct
+    if (m_parallel) g_job_system.submit([this, load]() { decode(*load); }, &load->done);
+    return (int) m_loads.size() - 1;
+}
+
+void AssetLoader::upload_all(const std::function<void(int index, const DecodedImage &image)> &upload)
+{
+    PROFILE_FUNCTION();
+    int remaining = 0;
+    for (const std::unique_ptr<ImageLoad> &load : m_loads) if (!load->uploaded) remaining++;
+
+    while (remaining > 0)
+    {
+        ImageLoad *first_pending = nullptr;
+        bool uploaded_any = false;
+        for (int i = 0; i < (int) m_loads.size(); i++)
+        {
+            ImageLoad &load = *m_loads[i];
+            if (load.uploaded) continue;
+
+            if (!m_parallel) decode(load);
+            else if (!load.done.is_done())
+            {
+                if (first_pending == nullptr) first_pending = &load;
+                continue;
+            }
+
+            upload(i, load.image);
+            load.uploaded   = true;
+            m_decode_ticks += load.decode_ticks;
+            uploaded_any    = true;
+            remaining--;
+            if (load.from_cache) m_cached_count++;
+            else                 m_decoded_count++;
+        }
+
+        // Nothing was ready, so lend a hand until the oldest decode is
+        if (!uploaded_any) g_job_system.wait(&first_pending->done);
+    }
+
+    update_cache();
+}
+
+// Rewrites the whole cache from what was just loaded, once anything had to be decoded. Without
+// packing there is nothing fit to store, since the cache holds what a packing run uploads.
+void AssetLoader::update_cache()
+{
+    bool any_decoded = false;
+    for (const std::unique_ptr<ImageLoad> &load : m_loads) any_decoded = any_decoded || !load->from_cache;
+    if (m_cache_path == nullptr || !m_pack_formats || !any_decoded) return;
+
+    // Images that did hit are copied out first, since the mapping has to go before the file is
+    // replaced. That only happens on the launch after a source changes.
+    std::vector<std::vector<unsigned char>> copies;
+    std::vector<CachedImage> images;
+    copies.reserve(m_loads.size());
+    for (const std::unique_ptr<ImageLoad> &load : m_loads)
+    {
+        const DecodedImage &image = load->image;
+        if (image.texels == nullptr) return;
+
+        CachedImage cached = { image.filepath, load->source_hash, image.width, image.height, image.format,
+                               image.texels, image.palette };
+        if (load->from_cache)
+        {
+            // The palette sits right after the texels in the mapping, so one copy takes both
+            const unsigned char *texels = image.texels;
+            copies.emplace_back(texels, texels + texture_bytes(image.format, image.width, image.height));
+            cached.texels = copies.back().data();
+            if (image.format == TEXTURE_INDEXED)
+                cached.palette = cached.texels + copies.back().size() - PALETTE_BYTES;
+        }
+        images.push_back(cached);
+    }
+
+    m_cache.close();
+    if (!TextureCache::write(m_cache_path, images)) LOG("ERROR: Could not write the texture cache to " << m_cache_path);
+}
+
+void AssetLoader::release()
+{
+    for (const std::unique_ptr<ImageLoad> &load : m_loads)
+        if (!load->from_cache) image_free((void *) load->image.pixels);
+    m_loads.clear();
+    m_cache.close();
+
+    m_arena_bytes = std::max(m_arena_bytes, m_arena.get_reserved_bytes());
+    m_arena.release();
+}
@@ -0,0 +1,157 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "JobSystem.h"
+#include "TextureCache.h"
+#include "TextureFormat.h"
+
+// ————— LOAD ARENA ————— //
+// Scratch for everything decoded while the game starts. Each decode reserves one region sized
+// from the image header and bumps through it, so stb_image's buffers cost no heap calls; the
+// whole arena goes back at once when loading is over.
+class LoadArena
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 4 * 1024 * 1024;   // Big enough for every image the game ships
+
+    struct Region
+    {
+        unsigned char *begin  = nullptr;
+        unsigned char *cursor = nullptr;
+        unsigned char *end    = nullptr;
+        unsigned char *last   = nullptr;   // The newest allocation, which can grow or be undone in place
+    };
+
+private:
+    struct Block
+    {
+        unsigned char *data;
+        size_t         size;
+        size_t         used;
+    };
+
+    std::mutex         m_mutex;
+    std::vector<Block> m_blocks;
+    size_t             m_reserved_bytes = 0;
+
+public:
+    ~LoadArena() { release(); }
+
+    // Safe to call from any thread
+    Region reserve(size_t size);
+    void   release();
+
+    size_t const get_reserved_bytes() const { return m_reserved_bytes; }
+    int    const get_block_count()    const { return (int) m_blocks.size(); }
+};
+
+// For STBI_MALLOC, STBI_REALLOC and STBI_FREE. Inside an ArenaScope allocations come from its
+// region while they fit; everything else, and anything the region can't hold, is tracked heap.
+// Either kind can be freed from any thread.
+void *image_malloc(size_t size);
+void *image_realloc(void *pointer, size_t size);
+void  image_free(void *pointer);
+
+// Points the calling thread's image allocations at `region` until the end of the scope
+class ArenaScope
+{
+private:
+    LoadArena::Region *m_previous;
+
+public:
+    explicit ArenaScope(LoadArena::Region *region);
+    ~ArenaScope();
+};
+
+// ————— ASSET LOADER ————— //
+struct DecodedImage
+{
+    const char          *filepath;
+    const unsigned char *pixels;   // RGBA8, top row first; null for a packed cache hit unless asked for
+    int                  width;
+    int                  height;
+
+    // What to upload: the pixels packed into `format`, which for RGBA8 are the pixels themselves.
+    // Null if the file couldn't be loaded.
+    TextureFormat        format;
+    const unsigned char *texels;
+    const unsigned char *palette;  // PALETTE_BYTES of RGBA8 for TEXTURE_INDEXED, else null
+};
+
+// Decodes images on the job system while the caller gets on with creating the GL context and
+// compiling shaders, then hands each one over for upload as soon as its decode finishes. With
+// a texture cache, an image whose source is unchanged is read from the cache's mapping instead,
+// already packed.
+// stb_image keeps no state between calls beyond its failure string, so decodes can overlap.
+// Each image is also packed into the smallest texture format that draws it exactly, on the
+// same job, so the GL thread only uploads.
+// Started serially, every decode waits for upload_all() and runs on the calling thread, which
+// is the baseline the startup time is compared against.
+class AssetLoader
+{
+private:
+    struct ImageLoad
+    {
+        DecodedImage image;
+        JobCounter   done;
+        uint64_t     source_hash  = 0;
+        uint64_t     decode_ticks = 0;
+        bool         from_cache   = false;
+        bool         uploaded     = false;
+    };
+
+    LoadArena                               m_arena;
+    std::vector<std::unique_ptr<ImageLoad>> m_loads;
+    TextureCache m_cache;
+    const char  *m_cache_path = nullptr;
+    bool     m_parallel = true;
+    bool     m_pack_formats = true;
+    bool     m_keep_pixels  = false;
+    uint64_t m_decode_ticks = 0;   // Summed over every load, so against the wall time it shows the overlap
+    size_t   m_arena_bytes  = 0;   // Kept past release() for the report
+    int      m_decoded_count = 0;
+    int      m_cached_count  = 0;
+
+    void decode(ImageLoad &load);
+    void update_cache();
+
+public:
+    void set_parallel(bool parallel) { m_parallel = parallel; }
+
+    // Off, every image is uploaded as RGBA8, and the cache is read but not rewritten
+    void set_pack_formats(bool pack_formats) { m_pack_formats = pack_formats; }
+
+    // On, every image comes with its RGBA8 pixels, unpacked again from the cache if it hit
+    void set_keep_pixels(bool keep_pixels) { m_keep_pixels = keep_pixels; }
+
+    // Looks images up in the cache at `filepath` before decoding them. Call before queue().
+    void use_cache(const char *filepath);
+
+    // `filepath` must outlive the loader; it becomes the texture's leak report label. Returns
+    // the index upload_all() reports the image under.
+    int queue(const char *filepath);
+
+    // Calls `upload` once for each queued image, in the order the decodes finish, helping with
+    // the decodes while none are ready, then rewrites the cache if any image missed it. Must be
+    // called on the GL thread.
+    void upload_all(const std::function<void(int index, const DecodedImage &image)> &upload);
+
+    // Frees the arena along with every decoded image in it, and unmaps the cache
+    void release();
+
+    int    const get_count()         const { return (int) m_loads.size(); }
+    bool   const is_parallel()       const { return m_parallel; }
+    float  const get_decode_ms()     const { return m_decode_ticks * 1000.0f / SDL_GetPerformanceFrequency(); }
+    size_t const get_arena_bytes()   const { return m_arena_bytes; }
+    int    const get_decoded_count() const { return m_decoded_count; }
+    int    const get_cached_count()  const { return m_cached_count; }
+};
+
+#endif // ASSET_LOADER_H
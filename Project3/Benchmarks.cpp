@@ -0,0 +1,664 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "Benchmarks.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "AssetFileSystem.h"
+#include "BinaryFile.h"
+#include "Entity.h"
+#include "Gravity.h"
+#include "Histogram.h"
+#include "JobSystem.h"
+#include "LevelGenerator.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "Qoi.h"
+#include "RenderCommands.h"
+#include "SoftwareRenderer.h"
+#include "stb_image.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+typedef std::chrono::steady_clock Clock;
+
+// ————— INTEGRATORS ————— //
+// The script is laid out in 0.2 s slots so that every tested rate lands on slot boundaries
+constexpr int SLOTS_PER_SECOND   = 5;
+constexpr int SCRIPT_SLOTS       = 30;   // Six seconds of flight
+constexpr int REFERENCE_RATE     = 1000;
+constexpr int TIMING_RUNS        = 2000;
+
+const char* const INTEGRATOR_NAMES[] = { "euler", "verlet", "closed-form" };
+
+// Thrust right, coast, thrust left, coast: exercises thrust, decay and friction
+static int const thrust_for_slot(int slot)
+{
+    if (slot < 3) return 1;
+    if (slot >= 10 && slot < 12) return -1;
+    return 0;
+}
+
+static void fly_script(int rate, Integrator integrator, float gravity, glm::vec2 *samples)
+{
+    g_integrator = integrator;
+
+    Entity lander = Entity(0, 1.0f, 9, 5, 3);
+    lander.set_acceleration(glm::vec3(0.0f, gravity, 0.0f));
+
+    int ticks_per_slot = rate / SLOTS_PER_SECOND;
+    float delta_time   = 1.0f / (float) rate;
+
+    for (int tick = 0; tick < SCRIPT_SLOTS * ticks_per_slot; tick++)
+    {
+        int thrust = thrust_for_slot(tick / ticks_per_slot);
+        if (thrust > 0) lander.move_right();
+        if (thrust < 0) lander.move_left();
+
+        lander.update(delta_time, nullptr, 0);
+
+        if ((tick + 1) % ticks_per_slot == 0) samples[tick / ticks_per_slot] = glm::vec2(lander.get_position());
+    }
+}
+
+int run_integrator_benchmark(float gravity)
+{
+    const int rates[]             = { 60, 30, 20, 15 };
+    const Integrator integrators[] = { SEMI_IMPLICIT_EULER, VELOCITY_VERLET, CLOSED_FORM };
+
+    glm::vec2 reference[SCRIPT_SLOTS], samples[SCRIPT_SLOTS];
+    fly_script(REFERENCE_RATE, SEMI_IMPLICIT_EULER, gravity, reference);
+
+    Integrator previous_integrator = g_integrator;
+    double baseline_us = 0.0;
+
+    LOG("Integrator   Rate   Max error   Final error   us/sim-second   CPU vs 60 Hz Euler");
+    for (Integrator integrator : integrators)
+    {
+        for (int rate : rates)
+        {
+            fly_script(rate, integrator, gravity, samples);
+
+            float max_error = 0.0f;
+            for (int slot = 0; slot < SCRIPT_SLOTS; slot++)
+                max_error = std::max(max_error, glm::length(samples[slot] - reference[slot]));
+            float final_error = glm::length(samples[SCRIPT_SLOTS - 1] - reference[SCRIPT_SLOTS - 1]);
+
+            Clock::time_point start = Clock::now();
+            for (int run = 0; run < TIMING_RUNS; run++) fly_script(rate, integrator, gravity, samples);
+            double total_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            double us_per_second = total_us / TIMING_RUNS / ((double) SCRIPT_SLOTS / SLOTS_PER_SECOND);
+            if (integrator == SEMI_IMPLICIT_EULER && rate == 60) baseline_us = us_per_second;
+
+            char line[128];
+            snprintf(line, sizeof(line), "%-12s %4d   %9.5f   %11.5f   %13.3f   %17.0f%%",
+                     INTEGRATOR_NAMES[integrator], rate, max_error, final_error, us_per_second,
+                     100.0 * us_per_second / baseline_us);
+            LOG(line);
+        }
+    }
+
+    g_integrator = previous_integrator;
+    return 0;
+}
+
+// ————— GRAVITY ————— //
+constexpr int   ACCURACY_SAMPLES = 1000;  // Direct sums are O(n) each, so only check a sample
+constexpr int   BUILD_RUNS       = 5;
+constexpr float FIELD_HALF_SIZE  = 100.0f;
+
+struct GravityTiming
+{
+    double serial_build_ms, parallel_build_ms, query_ms;
+};
+
+static GravityTiming time_gravity(BarnesHutTree &tree, const std::vector<glm::vec2> &positions,
+                                  const std::vector<float> &masses, float opening_angle)
+{
+    GravityTiming timing;
+    int count = (int) positions.size();
+
+    Clock::time_point start = Clock::now();
+    for (int run = 0; run < BUILD_RUNS; run++) tree.build(positions.data(), masses.data(), count, false);
+    timing.serial_build_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / BUILD_RUNS;
+
+    start = Clock::now();
+    for (int run = 0; run < BUILD_RUNS; run++) tree.build(positions.data(), masses.data(), count, true);
+    timing.parallel_build_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / BUILD_RUNS;
+
+    // Everything pulls on everything, as in the asteroid gravity mode
+    glm::vec2 checksum(0.0f);
+    start = Clock::now();
+    for (int body = 0; body < count; body++) checksum += tree.acceleration_at(positions[body], opening_angle, body);
+    timing.query_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Keeps the queries from being optimised away
+    if (std::isnan(checksum.x)) LOG("NaN in gravity field");
+    return timing;
+}
+
+static void make_field(int count, std::vector<glm::vec2> &positions, std::vector<float> &masses)
+{
+    Random random(count);
+    positions.resize(count);
+    masses.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        positions[i] = glm::vec2(random.next_range(-FIELD_HALF_SIZE, FIELD_HALF_SIZE),
+                                 random.next_range(-FIELD_HALF_SIZE, FIELD_HALF_SIZE));
+        masses[i]    = random.next_range(0.5f, 1.5f);
+    }
+}
+
+int run_gravity_benchmark(int body_count, float opening_angle)
+{
+    std::vector<glm::vec2> positions;
+    std::vector<float> masses;
+    BarnesHutTree tree;
+
+    // ————— SCALING ————— //
+    LOG("Bodies    Nodes    Build (1 thread)   Build (" << g_job_system.get_thread_count() << " threads)   Queries   ns/body");
+    for (int count : { body_count / 10, body_count })
+    {
+        make_field(count, positions, masses);
+        GravityTiming timing = time_gravity(tree, positions, masses, opening_angle);
+
+        char line[128];
+        snprintf(line, sizeof(line), "%-8d  %-7d  %13.2fms   %14.2fms   %6.1fms   %7.1f",
+                 count, tree.get_node_count(), timing.serial_build_ms, timing.parallel_build_ms,
+                 timing.query_ms, (timing.parallel_build_ms + timing.query_ms) * 1.0e6 / count);
+        LOG(line);
+    }
+
+    // ————— ACCURACY ————— //
+    // positions/masses still hold the full-size field
+    int count   = (int) positions.size();
+    int samples = std::min(ACCURACY_SAMPLES, count);
+    int stride  = std::max(count / samples, 1);
+
+    std::vector<glm::vec2> reference(samples);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < samples; i++)
+    {
+        int body = i * stride;
+        reference[i] = direct_acceleration(positions.data(), masses.data(), count, positions[body], body);
+    }
+    double direct_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() * count / samples;
+
+    char line[128];
+    snprintf(line, sizeof(line), "Direct O(n^2) sum over all %d bodies: ~%.0fms (extrapolated)", count, direct_ms);
+    LOG(line);
+
+    // Relative error blows up wherever the pulls nearly cancel, so the worst case is measured
+    // against the typical field strength instead of the body's own
+    double mean_strength = 0.0;
+    for (const glm::vec2 &acceleration : reference) mean_strength += glm::length(acceleration);
+    mean_strength /= samples;
+
+    tree.build(positions.data(), masses.data(), count, true);
+    LOG("Opening angle   Mean error   Max error (of mean |a|)   Queries");
+    for (float theta : { 0.3f, 0.5f, 0.7f, 1.0f })
+    {
+        double total_error = 0.0, max_error = 0.0;
+        for (int i = 0; i < samples; i++)
+        {
+            int body = i * stride;
+            double error = glm::length(tree.acceleration_at(positions[body], theta, body) - reference[i]);
+            total_error += error / std::max((double) glm::length(reference[i]), 1e-12);
+            max_error    = std::max(max_error, error / mean_strength);
+        }
+
+        start = Clock::now();
+        glm::vec2 checksum(0.0f);
+        for (int body = 0; body < count; body++) checksum += tree.acceleration_at(positions[body], theta, body);
+        double query_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (std::isnan(checksum.x)) LOG("NaN in gravity field");
+
+        snprintf(line, sizeof(line), "%-13.1f   %9.4f%%   %22.4f%%   %6.1fms%s", theta, 100.0 * total_error / samples,
+                 100.0 * max_error, query_ms, theta == opening_angle ? "  <- selected" : "");
+        LOG(line);
+    }
+
+    return 0;
+}
+
+// ————— JOBS ————— //
+constexpr int   JOB_GRAIN        = 1024;  // Entities per job: big enough to dwarf the queueing
+constexpr int   WARMUP_FRAMES    = 5;
+constexpr int   TIMED_FRAMES     = 30;
+constexpr float SCENE_HALF_SIZE  = 100.0f;
+constexpr float GRID_CELL_SIZE   = 1.0f;
+constexpr int   GRID_SIZE        = (int) (2.0f * SCENE_HALF_SIZE / GRID_CELL_SIZE);
+
+struct Scene
+{
+    std::vector<Entity> entities;
+    std::vector<float>  positions;             // Batched the way the game draws sprites
+    std::vector<float>  texture_coordinates;
+
+    // Uniform-grid broadphase, rebuilt from scratch every frame with a counting sort
+    std::vector<int> entity_cells;
+    std::vector<std::atomic<int>> cell_counts;
+    std::vector<int> cell_starts;
+    std::vector<int> sorted_entities;
+
+    Scene() : cell_counts(GRID_SIZE * GRID_SIZE), cell_starts(GRID_SIZE * GRID_SIZE + 1) {}
+};
+
+static void make_scene(Scene &scene, int count)
+{
+    Random random(count);
+    scene.entities.assign(count, Entity(0, 0.0f, 0, 4, 1));
+    scene.positions.resize((size_t) count * VERTICES_PER_QUAD * 3);
+    scene.texture_coordinates.resize((size_t) count * VERTICES_PER_QUAD * 2);
+    scene.entity_cells.resize(count);
+    scene.sorted_entities.resize(count);
+
+    for (Entity &entity : scene.entities)
+    {
+        entity.set_position(glm::vec3(random.next_range(-SCENE_HALF_SIZE, SCENE_HALF_SIZE),
+                                      random.next_range(-SCENE_HALF_SIZE, SCENE_HALF_SIZE), 0.0f));
+        entity.set_velocity(glm::vec3(random.next_range(-1.0f, 1.0f), random.next_range(-1.0f, 1.0f), 0.0f));
+        entity.set_acceleration(glm::vec3(0.0f));
+        entity.set_movement(glm::vec3(1.0f, 0.0f, 0.0f));
+        entity.set_animation_frames(4);
+        entity.set_scale(glm::vec3(0.5f, 0.5f, 0.0f));
+    }
+}
+
+static int const cell_of(glm::vec3 position)
+{
+    int x = (int) ((position.x + SCENE_HALF_SIZE) / GRID_CELL_SIZE);
+    int y = (int) ((position.y + SCENE_HALF_SIZE) / GRID_CELL_SIZE);
+    x = std::min(std::max(x, 0), GRID_SIZE - 1);
+    y = std::min(std::max(y, 0), GRID_SIZE - 1);
+    return y * GRID_SIZE + x;
+}
+
+// Motion and animation touch different fields, so they run side by side. The broadphase needs
+// the new positions, and the vertices need both the new model matrices and animation frames.
+static void run_frame(Scene &scene, float delta_time)
+{
+    int count = (int) scene.entities.size();
+    Entity *entities = scene.entities.data();
+
+    JobCounter motion, animation, binning, vertices, scatter;
+    g_job_system.parallel_for(count, JOB_GRAIN, [=](int begin, int end) {
+        for (int i = begin; i < end; i++) entities[i].step_motion(delta_time);
+    }, &motion);
+    g_job_system.parallel_for(count, JOB_GRAIN, [=](int begin, int end) {
+        for (int i = begin; i < end; i++) entities[i].step_animation(delta_time);
+    }, &animation);
+
+    for (std::atomic<int> &cell_count : scene.cell_counts) cell_count.store(0, std::memory_order_relaxed);
+
+    g_job_system.wait(&motion);
+    g_job_system.parallel_for(count, JOB_GRAIN, [&scene, entities](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            int cell = cell_of(entities[i].get_position());
+            scene.entity_cells[i] = cell;
+            scene.cell_counts[cell].fetch_add(1, std::memory_order_relaxed);
+        }
+    }, &binning);
+
+    g_job_system.wait(&animation);
+    float *positions = scene.positions.data(), *texture_coordinates = scene.texture_coordinates.data();
+    g_job_system.parallel_for(count, JOB_GRAIN, [=](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            SpritePayload sprite = make_sprite_payload(entities[i].get_model_matrix(), entities[i].get_sprite_uv_rect());
+            write_sprite_quad(sprite, positions + (size_t) i * VERTICES_PER_QUAD * 3,
+                              texture_coordinates + (size_t) i * VERTICES_PER_QUAD * 2);
+        }
+    }, &vertices);
+
+    // The prefix sum is short and serial; the vertex jobs keep the other threads busy meanwhile
+    g_job_system.wait(&binning);
+    int total = 0;
+    for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; cell++)
+    {
+        scene.cell_starts[cell] = total;
+        total += scene.cell_counts[cell].load(std::memory_order_relaxed);
+        scene.cell_counts[cell].store(scene.cell_starts[cell], std::memory_order_relaxed);
+    }
+    scene.cell_starts[GRID_SIZE * GRID_SIZE] = total;
+
+    // Order within a cell depends on scheduling, which a broadphase doesn't care about
+    g_job_system.parallel_for(count, JOB_GRAIN, [&scene](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            int slot = scene.cell_counts[scene.entity_cells[i]].fetch_add(1, std::memory_order_relaxed);
+            scene.sorted_entities[slot] = i;
+        }
+    }, &scatter);
+
+    g_job_system.wait(&scatter);
+    g_job_system.wait(&vertices);
+}
+
+int run_jobs_benchmark(int entity_count, int max_threads)
+{
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    float delta_time = 1.0f / 60.0f;
+    double single_thread_ms = 0.0;
+    uint64_t reference_hash = 0;
+    bool all_match = true;
+
+    LOG("Threads   ms/frame   Speedup   Efficiency   Vertex hash");
+    for (int threads : thread_counts)
+    {
+        g_job_system.start(threads);
+
+        // A fresh scene per run so every thread count simulates exactly the same frames
+        Scene scene;
+        make_scene(scene, entity_count);
+        for (int frame = 0; frame < WARMUP_FRAMES; frame++) run_frame(scene, delta_time);
+
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < TIMED_FRAMES; frame++) run_frame(scene, delta_time);
+        double frame_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / TIMED_FRAMES;
+
+        uint64_t hash = hash_bytes(scene.positions.data(), scene.positions.size() * sizeof(float));
+        hash = hash_bytes(scene.texture_coordinates.data(), scene.texture_coordinates.size() * sizeof(float), hash);
+        if (threads == 1)
+        {
+            single_thread_ms = frame_ms;
+            reference_hash   = hash;
+        }
+        all_match = all_match && hash == reference_hash;
+
+        double speedup = single_thread_ms / frame_ms;
+        char line[128];
+        snprintf(line, sizeof(line), "%-7d   %8.2f   %6.2fx   %9.0f%%   %016llx", threads, frame_ms,
+                 speedup, 100.0 * speedup / threads, (unsigned long long) hash);
+        LOG(line);
+    }
+
+    g_job_system.stop();
+    if (!all_match) LOG("MISMATCH: thread counts disagree on the frame's output");
+    return all_match ? 0 : 1;
+}
+
+// ————— SOFTWARE RASTERIZER ————— //
+constexpr int   RASTER_WIDTH        = 1280;   // The game's window
+constexpr int   RASTER_HEIGHT       = 800;
+constexpr int   RASTER_TIMED_FRAMES = 60;
+constexpr float RASTER_TARGET_FPS   = 60.0f;
+
+// The two sprite sheets the game draws from, then its font
+const char* const RASTER_TEXTURE_FILEPATHS[] = { "Asteroids.png", "Spaceships.png", "font1.png" };
+constexpr int RASTER_TEXTURE_COUNT = sizeof(RASTER_TEXTURE_FILEPATHS) / sizeof(RASTER_TEXTURE_FILEPATHS[0]);
+constexpr int RASTER_SHEET_COLUMNS[] = { 4, 5 };
+constexpr int RASTER_SHEET_ROWS[]    = { 1, 3 };
+
+struct RasterSprite
+{
+    GLuint    texture;
+    glm::vec4 uv_rect;
+    glm::vec2 position, velocity;
+    float     scale, angle, spin;
+};
+
+// Drifting, spinning sprites over the game's view, with a line of text on top
+static void record_raster_frame(RenderCommandList &commands, const std::vector<RasterSprite> &sprites, int frame)
+{
+    commands.reset();
+    commands.push_clear();
+    for (const RasterSprite &sprite : sprites)
+    {
+        glm::vec2 position = sprite.position + sprite.velocity * (float) frame;
+        position.x = std::fmod(position.x + 15.0f, 10.0f) - 5.0f;
+        position.y = std::fmod(position.y + 11.25f, 7.5f) - 3.75f;
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position, 0.0f));
+        model = glm::rotate(model, sprite.angle + sprite.spin * (float) frame, glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, glm::vec3(sprite.scale, sprite.scale, 1.0f));
+        commands.push_sprite(sprite.texture, model, sprite.uv_rect);
+    }
+    commands.push_text(3, "SOFTWARE RASTERIZER", 0.4f, 0.02f, glm::vec3(-4.0f, 3.25f, 0.0f));
+}
+
+int run_software_benchmark(int sprite_count, int max_threads)
+{
+    SoftwareRenderer renderer;
+    renderer.create(RASTER_WIDTH, RASTER_HEIGHT);
+    renderer.set_projection_matrix(glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f));
+    renderer.set_clear_colour(0.1f, 0.1f, 0.2f, 1.0f);
+    RasterPath best_path = renderer.get_path();
+
+    for (int i = 0; i < RASTER_TEXTURE_COUNT; i++)
+    {
+        int width, height, number_of_components;
+        unsigned char *image = stbi_load(RASTER_TEXTURE_FILEPATHS[i], &width, &height, &number_of_components, STBI_rgb_alpha);
+        if (image == nullptr)
+        {
+            LOG("ERROR: Could not load " << RASTER_TEXTURE_FILEPATHS[i] << "; run from the asset directory");
+            return 1;
+        }
+        renderer.add_texture((GLuint) (i + 1), image, width, height);
+        stbi_image_free(image);
+    }
+
+    Random random(sprite_count);
+    std::vector<RasterSprite> sprites(sprite_count);
+    for (RasterSprite &sprite : sprites)
+    {
+        int sheet = random.next_int(2);
+        int cell  = random.next_int(RASTER_SHEET_COLUMNS[sheet] * RASTER_SHEET_ROWS[sheet]);
+        float cell_width  = 1.0f / RASTER_SHEET_COLUMNS[sheet];
+        float cell_height = 1.0f / RASTER_SHEET_ROWS[sheet];
+
+        sprite.texture  = (GLuint) (1 + sheet);
+        sprite.uv_rect  = glm::vec4((cell % RASTER_SHEET_COLUMNS[sheet]) * cell_width,
+                                    (cell / RASTER_SHEET_COLUMNS[sheet]) * cell_height, cell_width, cell_height);
+        sprite.position = glm::vec2(random.next_range(-5.0f, 5.0f), random.next_range(-3.75f, 3.75f));
+        sprite.velocity = glm::vec2(random.next_range(-0.02f, 0.02f), random.next_range(-0.02f, 0.02f));
+        sprite.scale    = random.next_range(0.3f, 0.8f);
+        sprite.angle    = random.next_range(0.0f, 6.2831853f);
+        sprite.spin     = random.next_range(-0.05f, 0.05f);
+    }
+
+    // Every path at one thread, then the best one across thread counts
+    std::vector<std::pair<RasterPath, int>> runs;
+    for (int path = RASTER_SCALAR; path <= best_path; path++) runs.push_back({ (RasterPath) path, 1 });
+    for (int threads = 2; threads < max_threads; threads *= 2) runs.push_back({ best_path, threads });
+    if (max_threads > 1) runs.push_back({ best_path, max_threads });
+
+    RenderCommandList commands;
+    std::vector<unsigned char> pixels((size_t) RASTER_WIDTH * RASTER_HEIGHT * 4);
+    double scalar_ms = 0.0, best_ms = 0.0;
+    uint64_t reference_hash = 0;
+    bool all_match = true;
+
+    LOG("Software rasterizer: " << sprite_count << " sprites at " << RASTER_WIDTH << "x" << RASTER_HEIGHT);
+    LOG("Path     Threads   ms/frame   Frames/s   Speedup   Frame hash");
+    for (const std::pair<RasterPath, int> &run : runs)
+    {
+        g_job_system.start(run.second);
+        renderer.set_path(run.first);
+
+        // Recording stays out of the timing; it's the same list the game would hand over
+        record_raster_frame(commands, sprites, 0);
+        renderer.render(commands);
+
+        double total_ms = 0.0;
+        for (int frame = 0; frame < RASTER_TIMED_FRAMES; frame++)
+        {
+            record_raster_frame(commands, sprites, frame);
+            Clock::time_point start = Clock::now();
+            renderer.render(commands);
+            total_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        double frame_ms = total_ms / RASTER_TIMED_FRAMES;
+
+        renderer.copy_pixels(pixels.data());
+        uint64_t hash = hash_bytes(pixels.data(), pixels.size());
+        if (run.first == RASTER_SCALAR)
+        {
+            scalar_ms      = frame_ms;
+            reference_hash = hash;
+        }
+        all_match = all_match && hash == reference_hash;
+        best_ms   = best_ms == 0.0 ? frame_ms : std::min(best_ms, frame_ms);
+
+        char line[128];
+        snprintf(line, sizeof(line), "%-6s   %7d   %8.2f   %8.1f   %6.2fx   %016llx", RASTER_PATH_NAMES[run.first],
+                 run.second, frame_ms, 1000.0 / frame_ms, scalar_ms / frame_ms, (unsigned long long) hash);
+        LOG(line);
+    }
+
+    g_job_system.stop();
+    renderer.destroy();
+    LOG("Software rasterizer: best " << 1000.0 / best_ms << " frames/s, "
+        << (1000.0 / best_ms >= RASTER_TARGET_FPS ? "meets" : "MISSES") << " the " << RASTER_TARGET_FPS << " fps target");
+    if (!all_match) LOG("MISMATCH: paths or thread counts disagree on the frame");
+    return all_match ? 0 : 1;
+}
+
+// ————— QOI ————— //
+constexpr int QOI_DECODE_RUNS = 50;
+
+int run_qoi_benchmark(const char* const* filepaths, int count)
+{
+    LOG("image                              png bytes   qoi bytes    png ms    qoi ms   speedup");
+
+    size_t png_total_bytes = 0, qoi_total_bytes = 0;
+    double png_total_ms = 0.0, qoi_total_ms = 0.0;
+    bool all_match = true;
+    for (int i = 0; i < count; i++)
+    {
+        AssetFile source = g_assets.open(filepaths[i]);
+        int width, height, number_of_components;
+        unsigned char* reference = source.is_open()
+            ? stbi_load_from_memory(source.get_data(), (int) source.get_size(), &width, &height, &number_of_components, STBI_rgb_alpha)
+            : nullptr;
+        if (reference == nullptr)
+        {
+            LOG("ERROR: Could not read the image " << filepaths[i]);
+            return 1;
+        }
+
+        std::vector<unsigned char> encoded;
+        bool has_alpha = number_of_components == 2 || number_of_components == 4;
+        qoi_encode(reference, width, height, has_alpha ? 4 : 3, encoded);
+
+        // Best of many, so the table shows each decoder rather than the scheduler
+        double png_ms = 1e9;
+        for (int run = 0; run < QOI_DECODE_RUNS; run++)
+        {
+            Clock::time_point start = Clock::now();
+            int w, h, n;
+            unsigned char* pixels = stbi_load_from_memory(source.get_data(), (int) source.get_size(), &w, &h, &n, STBI_rgb_alpha);
+            png_ms = std::min(png_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            stbi_image_free(pixels);
+        }
+
+        std::vector<unsigned char> decoded((size_t) width * height * 4);
+        double qoi_ms = 1e9;
+        bool match = true;
+        for (int run = 0; run < QOI_DECODE_RUNS; run++)
+        {
+            Clock::time_point start = Clock::now();
+            int w, h;
+            match = qoi_read_header(encoded.data(), encoded.size(), w, h) &&
+                    qoi_decode(encoded.data(), encoded.size(), decoded.data(), w, h);
+            qoi_ms = std::min(qoi_ms, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        match = match && memcmp(decoded.data(), reference, decoded.size()) == 0;
+        all_match = all_match && match;
+        stbi_image_free(reference);
+
+        char line[160];
+        snprintf(line, sizeof(line), "%-32s %11zu %11zu %9.3f %9.3f %8.2fx%s", filepaths[i], source.get_size(),
+                 encoded.size(), png_ms, qoi_ms, png_ms / qoi_ms, match ? "" : "   MISMATCH");
+        LOG(line);
+
+        png_total_bytes += source.get_size();
+        qoi_total_bytes += encoded.size();
+        png_total_ms    += png_ms;
+        qoi_total_ms    += qoi_ms;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "%-32s %11zu %11zu %9.3f %9.3f %8.2fx", "total", png_total_bytes, qoi_total_bytes,
+             png_total_ms, qoi_total_ms, png_total_ms / qoi_total_ms);
+    LOG(line);
+    if (!all_match) LOG("MISMATCH: QOI decoded different pixels from the PNG");
+    return all_match ? 0 : 1;
+}
+
+// ————— PROFILER ————— //
+constexpr int PROFILER_ZONES = 10000000;
+
+int run_profiler_benchmark()
+{
+#ifdef ENABLE_PROFILER
+    // Nested pairs, like real zones, and enough of them to lap the ring many times over
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < PROFILER_ZONES / 2; i++)
+    {
+        PROFILE_SCOPE("outer");
+        PROFILE_SCOPE("inner");
+    }
+    double elapsed_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    // Most of a zone is its two timestamps, and those are much slower under some hypervisors
+    uint64_t checksum = 0;
+    start = Clock::now();
+    for (int i = 0; i < PROFILER_ZONES; i++) checksum += profiler_now();
+    double clock_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / PROFILER_ZONES;
+    volatile uint64_t sink = checksum; // Keeps the reads from being optimised away
+    (void) sink;
+
+    LOG("Profiler: " << elapsed_ns / PROFILER_ZONES << "ns per zone over " << PROFILER_ZONES << " zones, "
+        << 2.0 * clock_ns << "ns of it reading the clock");
+#else
+    LOG("Profiler: compiled out (build with ENABLE_PROFILER to enable it); zones cost nothing");
+#endif
+    return 0;
+}
+
+// ————— SESSION COMPARISON ————— //
+int run_stats_comparison(const char *baseline_filepath, const char *current_filepath)
+{
+    // Static: each holds a few dozen kilobytes of buckets
+    static SessionStats baseline, current;
+    if (!load_session_stats(baseline_filepath, baseline) || !load_session_stats(current_filepath, current))
+    {
+        LOG("ERROR: Could not load " << baseline_filepath << " and " << current_filepath);
+        return 1;
+    }
+
+    const double percentiles[]      = { 50.0, 95.0, 99.0, 99.9, 100.0 };
+    const char  *percentile_names[] = { "p50", "p95", "p99", "p99.9", "max" };
+    for (int metric = 0; metric < METRIC_COUNT; metric++)
+    {
+        const Histogram &before = baseline.metrics[metric];
+        const Histogram &after  = current.metrics[metric];
+        if (before.get_count() == 0 || after.get_count() == 0) continue;
+
+        LOG(SESSION_METRIC_NAMES[metric] << " (" << before.get_count() << " vs " << after.get_count() << " samples):");
+        for (int i = 0; i < (int) (sizeof(percentiles) / sizeof(percentiles[0])); i++)
+        {
+            double before_ms = before.value_at_percentile(percentiles[i]) / 1000.0;
+            double after_ms  = after.value_at_percentile(percentiles[i]) / 1000.0;
+            double change    = before_ms > 0.0 ? 100.0 * (after_ms - before_ms) / before_ms : 0.0;
+            LOG("  " << percentile_names[i] << ": " << before_ms << "ms -> " << after_ms << "ms ("
+                << (change >= 0.0 ? "+" : "") << change << "%)");
+        }
+
+        double before_over = 100.0 * before.get_over_budget() / before.get_count();
+        double after_over  = 100.0 * after.get_over_budget() / after.get_count();
+        LOG("  over budget: " << before_over << "% -> " << after_over << "%");
+    }
+    return 0;
+}
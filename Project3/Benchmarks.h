@@ -0,0 +1,34 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Headless measurement modes, selected from the command line. None of them need a window or
+// a GL context, and each returns the process exit code.
+
+// Trajectory error of every integrator at 60/30/20/15 Hz against a 1 kHz reference run, plus
+// the CPU time each configuration spends per simulated second
+int run_integrator_benchmark(float gravity);
+
+// Barnes-Hut build and query cost for `body_count` bodies, its scaling against a field a tenth
+// the size, and its error against the direct O(n²) sum at several opening angles
+int run_gravity_benchmark(int body_count, float opening_angle);
+
+// One frame of an `entity_count`-entity scene (motion, animation, broadphase rebuild and sprite
+// vertices as dependent jobs) at 1, 2, 4... up to `max_threads`, with the speedup over 1 thread
+int run_jobs_benchmark(int entity_count, int max_threads);
+
+// The software rasterizer drawing `sprite_count` spinning sprites at the game's resolution: every
+// SIMD path on one thread, then the best one at 2, 4... up to `max_threads`. Each run must draw
+// the same frame.
+int run_software_benchmark(int sprite_count, int max_threads);
+
+// Decode time and size of each image as stb_image PNG and as QOI, best of many runs, with the
+// QOI pixels checked against the PNG ones
+int run_qoi_benchmark(const char* const* filepaths, int count);
+
+// Cost of an empty profiler zone, or a note that the profiler is compiled out
+int run_profiler_benchmark();
+
+// Percentiles of two sessions saved with --stats-out side by side, with the change in each
+int run_stats_comparison(const char *baseline_filepath, const char *current_filepath);
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,82 @@
+#include "BinaryFile.h"
+#include <string>
+#include <sys/stat.h>
+
+#ifdef _WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #include <direct.h>
+#endif
+
+// ————— LITTLE-ENDIAN VALUES ————— //
+void write_u32(FILE *file, uint32_t value)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++) bytes[i] = (uint8_t) (value >> (8 * i));
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+void write_u64(FILE *file, uint64_t value)
+{
+    write_u32(file, (uint32_t) value);
+    write_u32(file, (uint32_t) (value >> 32));
+}
+
+bool read_u32(FILE *file, uint32_t &value)
+{
+    unsigned char bytes[4];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return false;
+
+    value = get_u32(bytes);
+    return true;
+}
+
+bool read_u64(FILE *file, uint64_t &value)
+{
+    unsigned char bytes[8];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return false;
+
+    value = get_u64(bytes);
+    return true;
+}
+
+// ————— REPLACING FILES ————— //
+static std::string replacement_path(const char *filepath)
+{
+    return std::string(filepath) + ".tmp";
+}
+
+FILE *open_replacement(const char *filepath)
+{
+    return fopen(replacement_path(filepath).c_str(), "wb");
+}
+
+bool replace_file_atomically(FILE *file, const char *filepath)
+{
+    std::string temporary = replacement_path(filepath);
+    bool success = ferror(file) == 0;
+    success = fclose(file) == 0 && success;
+
+#ifdef _WINDOWS
+    // rename() won't replace an existing file there
+    if (success) success = MoveFileExA(temporary.c_str(), filepath, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    if (success) success = rename(temporary.c_str(), filepath) == 0;
+#endif
+    if (!success) remove(temporary.c_str());
+    return success;
+}
+
+// ————— DIRECTORIES ————— //
+bool ensure_directory(const char *path)
+{
+#ifdef _WINDOWS
+    _mkdir(path);
+    struct _stat info;
+    return _stat(path, &info) == 0 && (info.st_mode & _S_IFDIR) != 0;
+#else
+    mkdir(path, 0755);
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
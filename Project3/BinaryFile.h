@@ -0,0 +1,63 @@
+#ifndef BINARY_FILE_H
+#define BINARY_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// ————— LITTLE-ENDIAN VALUES ————— //
+// Every file the game writes stores its numbers little-endian, whatever the machine
+inline uint32_t get_u32(const unsigned char *bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= (uint32_t) bytes[i] << (8 * i);
+    return value;
+}
+
+inline uint64_t get_u64(const unsigned char *bytes)
+{
+    return ((uint64_t) get_u32(bytes + 4) << 32) | get_u32(bytes);
+}
+
+void write_u32(FILE *file, uint32_t value);
+void write_u64(FILE *file, uint64_t value);
+
+// False at the end of the file, leaving `value` alone
+bool read_u32(FILE *file, uint32_t &value);
+bool read_u64(FILE *file, uint64_t &value);
+
+// `alignment` must be a power of two
+inline size_t align_up(size_t offset, size_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+// ————— HASHING ————— //
+// 64-bit FNV-1a. Keys the caches and packs by path and content, and fingerprints replay state.
+constexpr uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+constexpr uint64_t FNV_PRIME        = 0x100000001B3ull;
+
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// ————— REPLACING FILES ————— //
+// Caches and packs are written beside their file and only moved over it once complete, so a
+// crash or a full disk partway through leaves the old file rather than half of a new one.
+// Opens the file to write for `filepath`, or null.
+FILE *open_replacement(const char *filepath);
+
+// Closes `file` from open_replacement() and puts it in place of `filepath`. On any write
+// error it is thrown away instead, and `filepath` is untouched.
+bool replace_file_atomically(FILE *file, const char *filepath);
+
+// ————— DIRECTORIES ————— //
+// Creates the directory at `path` if it isn't there yet. Doesn't create its parents.
+// False if it can't be made or something else is in the way.
+bool ensure_directory(const char *path);
+
+#endif // BINARY_FILE_H
@@ -12,6 +12,11 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
 #include "Entity.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "RenderCommands.h"
+
+Integrator g_integrator = SEMI_IMPLICIT_EULER;
 
 // Default constructor
 Entity::Entity()
@@ -49,46 +54,6 @@ Entity::Entity(GLuint texture_id, float speed, int index, int cols, int rows)
         for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
 }
 
-Entity::~Entity() { }
-
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index)
-{
-    // Step 1: Calculate the UV location of the indexed frame
-    float u_coord = (float) (index % m_animation_cols) / (float) m_animation_cols;
-    float v_coord = (float) (index / m_animation_cols) / (float) m_animation_rows;
-    
-    // Step 2: Calculate its UV size
-    float width = 1.0f / (float) m_animation_cols;
-    float height = 1.0f / (float) m_animation_rows;
-    
-    // Step 3: Just as we have done before, match the texture coordinates to the vertices
-    float tex_coords[] =
-    {
-        u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
-        u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
-    };
-    
-    float vertices[] =
-    {
-        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
-        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
-    };
-    
-    // Step 4: And render
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
-    
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
-    
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
-}
-
 void Entity::face_up() {
     if (m_animation_indices != NULL) {
         m_animation_indices = m_walking[UP];
@@ -135,6 +100,8 @@ bool const Entity::check_collision(Entity* other) const
 
 int Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count)
 {
+    PROFILE_SCOPE("Entity::update");
+
     for (int i = 0; i < collidable_entity_count; i++)
     {
         if (check_collision(&collidable_entities[i])) {
@@ -150,7 +117,15 @@ int Entity::update(float delta_time, Entity* collidable_entities, int collidable
         };
     }
 
-    if (m_animation_indices != NULL)
+    step_animation(delta_time);
+    step_motion(delta_time);
+    return 0;
+}
+
+void Entity::step_animation(float delta_time)
+{
+    // Walk cycles step through m_animation_indices, plain sprite sheets through their first frames
+    if (m_animation_indices != NULL || m_animation_frames > 0)
     {
         if (glm::length(m_movement) != 0)
         {
@@ -169,39 +144,13 @@ int Entity::update(float delta_time, Entity* collidable_entities, int collidable
             }
         }
     }
-    
-    // Decelerate acceleration towards 0
-    if (m_acceleration.x > 0) {
-        m_acceleration.x -= 0.15;
-        if (m_acceleration.x < 0) {
-            m_acceleration.x = 0;
-        }
-    }
-    else if (m_acceleration.x < 0) {
-        m_acceleration.x += 0.15;
-        if (m_acceleration.x > 0) {
-            m_acceleration.x = 0;
-        }
-    }
-
-    // Decelerate velocity towards 0 only when acceleration is 0
-    if (m_acceleration.x == 0) {
-        if (m_velocity.x > 0) {
-            m_velocity.x -= 0.05;
-            if (m_velocity.x < 0) {
-                m_velocity.x = 0;
-            }
-        }
-        else if (m_velocity.x < 0) {
-            m_velocity.x += 0.05;
-            if (m_velocity.x > 0) {
-                m_velocity.x = 0;
-            }
-        }
-    }
+}
 
-    m_velocity += m_acceleration * delta_time;
-    m_position += m_velocity * delta_time;
+void Entity::step_motion(float delta_time)
+{
+    integrate_motion<physics_scalar>(m_position, m_velocity, m_acceleration, delta_time,
+                                     g_integrator, !m_thrusting, m_field_acceleration);
+    m_thrusting = false;
     
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
@@ -218,35 +167,21 @@ int Entity::update(float delta_time, Entity* collidable_entities, int collidable
         m_model_matrix = glm::rotate(m_model_matrix, glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     }
     m_model_matrix = glm::scale(m_model_matrix, m_scale);
-    return 0;
 }
 
-void Entity::render(ShaderProgram *program)
+glm::vec4 const Entity::get_sprite_uv_rect() const
 {
-    program->set_model_matrix(m_model_matrix);
-    
-    if (m_animation_indices == NULL && (m_animation_cols != 0 || m_animation_rows != 0)) {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_index);
-        return;
-    }
-    if (m_animation_indices != NULL)
-    {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
-        return;
-    }
-    
-    float vertices[]   = { -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5 };
-    float tex_coords[] = {  0.0,  1.0, 1.0,  1.0, 1.0, 0.0,  0.0,  1.0, 1.0, 0.0,  0.0, 0.0 };
-    
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
-    
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
-    
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    // The frame the animation is on, or the whole texture for an entity without a sprite sheet
+    if (m_animation_cols == 0 || m_animation_rows == 0) return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+    int index    = m_animation_indices != NULL ? m_animation_indices[m_animation_index] : m_animation_index;
+    float width  = 1.0f / (float) m_animation_cols;
+    float height = 1.0f / (float) m_animation_rows;
+    return glm::vec4((float) (index % m_animation_cols) * width, (float) (index / m_animation_cols) * height,
+                     width, height);
+}
+
+void Entity::record_render(RenderCommandList &commands) const
+{
+    commands.push_sprite(m_texture_id, m_model_matrix, get_sprite_uv_rect());
 }
@@ -4,6 +4,8 @@
 #include "glm/glm.hpp"
 #include "ShaderProgram.h"
 
+class RenderCommandList;
+
 enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
 
 class Entity
@@ -17,11 +19,13 @@ private:
     glm::vec3 m_scale;
     glm::vec3 m_velocity;
     glm::vec3 m_acceleration;
+    glm::vec3 m_field_acceleration = glm::vec3(0.0f); // External pull (asteroid gravity), never decays
     
     glm::mat4 m_model_matrix;
     
     float     m_speed;
     bool      landingSpot;
+    bool      m_thrusting = false; // Thrust holds acceleration steady; it only decays once released
 
     // ————— TEXTURES ————— //
     GLuint    m_texture_id;
@@ -51,13 +55,16 @@ public:
            int animation_rows);
     Entity(GLuint texture_id, float speed, bool landingSpot); // Simpler constructor
     Entity(GLuint texture_id, float speed, int m_animation_index, int animation_cols, int animation_rows); // Simple using only static sprite form sprite sheet
-    ~Entity();
+    ~Entity() = default; // Trivial, so entities can be snapshotted bytewise for rollback
 
-    void draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index);
     bool const check_collision(Entity* other) const;
 
     int update(float delta_time, Entity* collidable_entities, int collidable_entity_count);
-    void render(ShaderProgram *program);
+    void record_render(RenderCommandList &commands) const; // Drawn later, on the render thread
+
+    // The two halves of update() after collisions, split out so they can run as separate jobs
+    void step_animation(float delta_time);
+    void step_motion(float delta_time);
     
     void normalise_movement() { m_movement = glm::normalize(m_movement); }
     
@@ -67,8 +74,8 @@ public:
     void face_up();
     void face_down();
     
-    void move_left()  { m_acceleration.x = -2.5f; face_left(); }
-    void move_right() { m_acceleration.x = 2.5f;  face_right(); }
+    void move_left()  { m_acceleration.x = -2.5f; m_thrusting = true; face_left(); }
+    void move_right() { m_acceleration.x = 2.5f;  m_thrusting = true; face_right(); }
     void move_up()    { m_movement.y = 1.0f;  face_up(); }
     void move_down()  { m_movement.y = -1.0f; face_down(); }
 
@@ -76,8 +83,11 @@ public:
     glm::vec3 const get_position()     const { return m_position; }
     glm::vec3 const get_velocity()     const { return m_velocity; }
     glm::vec3 const get_acceleration() const { return m_acceleration; }
+    glm::vec3 const get_field_acceleration() const { return m_field_acceleration; }
     glm::vec3 const get_movement()     const { return m_movement; }
     glm::vec3 const get_scale()        const { return m_scale; }
+    glm::vec4 const get_sprite_uv_rect() const;   // u, v, width, height of the current frame
+    glm::mat4 const get_model_matrix()   const { return m_model_matrix; }
     GLuint    const get_texture_id()   const { return m_texture_id; }
     float     const get_speed()        const { return m_speed; }
     float     const get_width()        const { return m_width; }
@@ -88,6 +98,7 @@ public:
     void const set_position(glm::vec3 new_position)     { m_position = new_position; }
     void const set_velocity(glm::vec3 new_velocity)     { m_velocity = new_velocity; }
     void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration; }
+    void const set_field_acceleration(glm::vec3 new_field)  { m_field_acceleration = new_field; }
     void const set_movement(glm::vec3 new_movement)     { m_movement = new_movement; }
     void const set_scale(glm::vec3 new_scale)           { m_scale = new_scale; }
     void const set_texture_id(GLuint new_texture_id)    { m_texture_id = new_texture_id; }
@@ -0,0 +1,60 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cmath>
+#include <cstdint>
+
+// Signed fixed-point number with FRACTION_BITS bits after the binary point. Every operation
+// is plain integer arithmetic, so results are bit-identical on every compiler, flag set and
+// CPU, which is what replays need. `Wide` must hold the product of two `Raw` values.
+template <int FRACTION_BITS, typename Raw, typename Wide>
+class Fixed
+{
+private:
+    Raw m_raw;
+
+    static constexpr Wide ONE = (Wide) 1 << FRACTION_BITS;
+
+public:
+    Fixed() : m_raw(0) { }
+
+    // Conversions from float are exact scalings by a power of two followed by one rounding,
+    // so the same float always lands on the same fixed value.
+    explicit Fixed(float value)  : m_raw((Raw) std::llround((double) value * (double) ONE)) { }
+    explicit Fixed(double value) : m_raw((Raw) std::llround(value * (double) ONE)) { }
+
+    static Fixed from_raw(Raw raw) { Fixed result; result.m_raw = raw; return result; }
+
+    Raw const get_raw() const { return m_raw; }
+
+    explicit operator float() const { return (float) ((double) m_raw / (double) ONE); }
+
+    // ————— ARITHMETIC ————— //
+    Fixed operator+(Fixed other) const { return from_raw(m_raw + other.m_raw); }
+    Fixed operator-(Fixed other) const { return from_raw(m_raw - other.m_raw); }
+    Fixed operator-()            const { return from_raw(-m_raw); }
+    Fixed operator*(Fixed other) const { return from_raw((Raw) (((Wide) m_raw * other.m_raw) >> FRACTION_BITS)); }
+    Fixed operator/(Fixed other) const { return from_raw((Raw) (((Wide) m_raw * ONE) / other.m_raw)); }
+
+    Fixed &operator+=(Fixed other) { m_raw += other.m_raw; return *this; }
+    Fixed &operator-=(Fixed other) { m_raw -= other.m_raw; return *this; }
+    Fixed &operator*=(Fixed other) { return *this = *this * other; }
+    Fixed &operator/=(Fixed other) { return *this = *this / other; }
+
+    // ————— COMPARISON ————— //
+    bool operator==(Fixed other) const { return m_raw == other.m_raw; }
+    bool operator!=(Fixed other) const { return m_raw != other.m_raw; }
+    bool operator< (Fixed other) const { return m_raw <  other.m_raw; }
+    bool operator> (Fixed other) const { return m_raw >  other.m_raw; }
+    bool operator<=(Fixed other) const { return m_raw <= other.m_raw; }
+    bool operator>=(Fixed other) const { return m_raw >= other.m_raw; }
+};
+
+// Q16.16 covers ±32768 with a resolution of ~0.000015, plenty for a 10x7.5 unit screen
+typedef Fixed<16, int32_t, int64_t> Fixed16_16;
+
+#ifdef __SIZEOF_INT128__
+typedef Fixed<32, int64_t, __int128> Fixed32_32;
+#endif
+
+#endif // FIXED_H
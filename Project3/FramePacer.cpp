@@ -0,0 +1,97 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+constexpr double SPIN_TAIL_SECONDS = 0.0015; // SDL_Delay is trusted up to this close to the deadline
+
+VsyncMode apply_swap_interval(VsyncMode requested)
+{
+    // Adaptive vsync tears instead of stalling a whole frame when we run late
+    if (requested == VSYNC_ADAPTIVE)
+    {
+        if (SDL_GL_SetSwapInterval(-1) == 0) return VSYNC_ADAPTIVE;
+        requested = VSYNC_ON;
+    }
+    if (requested == VSYNC_ON)
+    {
+        if (SDL_GL_SetSwapInterval(1) == 0) return VSYNC_ON;
+    }
+
+    SDL_GL_SetSwapInterval(0);
+    return VSYNC_OFF;
+}
+
+void FramePacer::start(float target_fps, bool sleeps)
+{
+    m_counter_frequency = (double) SDL_GetPerformanceFrequency();
+    m_frame_period      = (Uint64) (m_counter_frequency / std::max(target_fps, 1.0f));
+    m_sleeps            = sleeps;
+
+    m_start_counter  = SDL_GetPerformanceCounter();
+    m_start_cpu      = std::clock();
+    m_last_frame_end = m_start_counter;
+    m_next_deadline  = m_start_counter + m_frame_period;
+}
+
+void FramePacer::sleep_until(Uint64 deadline)
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now >= deadline) return;
+
+    double remaining = (double) (deadline - now) / m_counter_frequency;
+    if (remaining > SPIN_TAIL_SECONDS)
+    {
+        SDL_Delay((Uint32) ((remaining - SPIN_TAIL_SECONDS) * 1000.0));
+    }
+
+    while (SDL_GetPerformanceCounter() < deadline) {}
+}
+
+bool FramePacer::end_frame()
+{
+    if (m_sleeps)
+    {
+        sleep_until(m_next_deadline);
+
+        // After a long frame, start afresh rather than rushing to catch up
+        Uint64 now = SDL_GetPerformanceCounter();
+        m_next_deadline += m_frame_period;
+        if (m_next_deadline < now) m_next_deadline = now + m_frame_period;
+    }
+
+    Uint64 frame_end = SDL_GetPerformanceCounter();
+    double interval  = (double) (frame_end - m_last_frame_end) / m_counter_frequency;
+    m_last_frame_end = frame_end;
+    m_last_interval  = interval;
+
+    if (m_skip_interval)
+    {
+        m_skip_interval = false;
+        return false;
+    }
+
+    m_frame_count++;
+    double delta     = interval - m_interval_mean;
+    m_interval_mean += delta / (double) m_frame_count;
+    m_interval_m2   += delta * (interval - m_interval_mean);
+    m_interval_max   = std::max(m_interval_max, interval);
+    return true;
+}
+
+void FramePacer::log_stats() const
+{
+    if (m_frame_count == 0 && m_idle_waits == 0) return;
+
+    double wall_seconds = (double) (SDL_GetPerformanceCounter() - m_start_counter) / m_counter_frequency;
+    double cpu_seconds  = (double) (std::clock() - m_start_cpu) / CLOCKS_PER_SEC;
+    double jitter       = m_frame_count > 1 ? std::sqrt(m_interval_m2 / (double) (m_frame_count - 1)) : 0.0;
+
+    LOG("Frames: " << m_frame_count << " at " << m_interval_mean * 1000.0 << "ms mean, "
+        << jitter * 1000.0 << "ms jitter (std dev), " << m_interval_max * 1000.0 << "ms worst, "
+        << m_idle_waits << " idle waits");
+    LOG("CPU: " << 100.0 * cpu_seconds / std::max(wall_seconds, 1e-9) << "% of one core over "
+        << wall_seconds << "s");
+}
@@ -0,0 +1,52 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <SDL.h>
+#include <ctime>
+
+enum VsyncMode { VSYNC_OFF, VSYNC_ON, VSYNC_ADAPTIVE };
+
+// Asks for `requested` on the current GL context, falling back from adaptive to plain vsync
+// to none, and returns what the driver actually accepted
+VsyncMode apply_swap_interval(VsyncMode requested);
+
+// Keeps the main loop from spinning. With vsync the swap already blocks, so the pacer only
+// measures; without it, each frame sleeps until its deadline and spins the last stretch,
+// since a plain sleep can overshoot by a millisecond or more.
+class FramePacer
+{
+private:
+    double m_counter_frequency = 1.0;
+    Uint64 m_frame_period      = 0;     // In performance counter ticks
+    Uint64 m_next_deadline     = 0;
+    Uint64 m_last_frame_end    = 0;
+    double m_last_interval     = 0.0;   // In seconds
+    bool   m_sleeps            = true;
+
+    // ————— STATS ————— //
+    Uint64  m_start_counter = 0;
+    clock_t m_start_cpu     = 0;
+    Uint64  m_frame_count   = 0;
+    double  m_interval_mean = 0.0;   // Welford's running mean and variance, in seconds
+    double  m_interval_m2   = 0.0;
+    double  m_interval_max  = 0.0;
+    Uint64  m_idle_waits    = 0;
+    bool    m_skip_interval = false;  // An idle wait isn't a frame-time sample
+
+    void sleep_until(Uint64 deadline);
+
+public:
+    // `sleeps` is false when vsync paces the frames instead
+    void start(float target_fps, bool sleeps);
+
+    // False when the frame was an idle wait rather than a frame-time sample
+    bool end_frame();
+    double const get_last_interval() const { return m_last_interval; }
+
+    // Counts frames that blocked on events instead of pacing
+    void note_idle_wait() { m_idle_waits++; m_skip_interval = true; }
+
+    void log_stats() const;
+};
+
+#endif // FRAME_PACER_H
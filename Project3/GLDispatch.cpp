@@ -0,0 +1,248 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "GLDispatch.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// The legacy macOS headers only have the extension versions of these
+#ifdef __APPLE__
+    #define glGetQueryObjectui64v    glGetQueryObjectui64vEXT
+    #define glBindFramebuffer        glBindFramebufferEXT
+    #define glCheckFramebufferStatus glCheckFramebufferStatusEXT
+    #define glDeleteFramebuffers     glDeleteFramebuffersEXT
+    #define glFramebufferTexture2D   glFramebufferTexture2DEXT
+    #define glGenFramebuffers        glGenFramebuffersEXT
+
+    // Nor program binaries or parallel compiles at all. The shader manager only calls these
+    // when the context reports them, which a legacy macOS one never does.
+    static void APIENTRY legacy_GetProgramBinary(GLuint, GLsizei, GLsizei *length, GLenum *, void *)
+    {
+        if (length != nullptr) *length = 0;
+    }
+    static void APIENTRY legacy_MaxShaderCompilerThreadsKHR(GLuint) {}
+    static void APIENTRY legacy_ProgramBinary(GLuint, GLenum, const void *, GLsizei) {}
+    static void APIENTRY legacy_ProgramParameteri(GLuint, GLenum, GLint) {}
+
+    #define glGetProgramBinary            legacy_GetProgramBinary
+    #define glMaxShaderCompilerThreadsKHR legacy_MaxShaderCompilerThreadsKHR
+    #define glProgramBinary               legacy_ProgramBinary
+    #define glProgramParameteri           legacy_ProgramParameteri
+#endif
+
+constexpr int MAX_VERTEX_ATTRIBUTES = 16;
+
+typedef std::chrono::steady_clock Clock;
+
+const char *const GL_FUNCTION_NAMES[GL_FUNCTION_COUNT] =
+{
+#define GL_DISPATCH_NAME(RET, NAME, PARAMS, ARGS) "gl" #NAME,
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_NAME)
+#undef GL_DISPATCH_NAME
+};
+
+GLDispatch g_gl;
+
+void gl_load_native()
+{
+#define GL_DISPATCH_NATIVE(RET, NAME, PARAMS, ARGS) g_gl.NAME = gl##NAME;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_NATIVE)
+#undef GL_DISPATCH_NATIVE
+}
+
+const char *gl_string(GLenum name)
+{
+    const char *value = (const char *) g_gl.GetString(name);
+    return value != nullptr ? value : "";
+}
+
+// ————— CALL COUNTING ————— //
+static GLDispatch    s_next;          // What the counting layer forwards to
+static bool          s_counting = false;
+static GLFrameCounts s_frame;
+static GLFrameCounts s_last_frame;
+static uint64_t      s_total_calls[GL_FUNCTION_COUNT];
+static uint64_t      s_total_nanoseconds[GL_FUNCTION_COUNT];
+static uint64_t      s_frame_count = 0;
+static FILE         *s_call_log = nullptr;
+
+// Bytes per vertex of each attribute array, and whether it's enabled
+static uint32_t s_attribute_bytes[MAX_VERTEX_ATTRIBUTES];
+static bool     s_attribute_enabled[MAX_VERTEX_ATTRIBUTES];
+
+static uint32_t bytes_per_component(GLenum type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:   return 1;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: return 2;
+    default:                               return 4;
+    }
+}
+
+static uint32_t bytes_per_pixel(GLenum format, GLenum type)
+{
+    // Packed types hold a whole pixel
+    if (type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1 || type == GL_UNSIGNED_SHORT_5_6_5)
+        return 2;
+
+    uint32_t components = 4;
+    switch (format)
+    {
+    case GL_RGB:             components = 3; break;
+    case GL_LUMINANCE_ALPHA: components = 2; break;
+    case GL_ALPHA:
+    case GL_LUMINANCE:       components = 1; break;
+    default:                 break;
+    }
+    return components * bytes_per_component(type);
+}
+
+// Most calls are only counted; these few also say how much data they move
+template <GLFunction FUNCTION>
+struct CallHook
+{
+    template <typename... Args> static void on_call(Args...) {}
+};
+
+template <>
+struct CallHook<GL_FN_TexImage2D>
+{
+    static void on_call(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                        const void *)
+    {
+        s_frame.texture_bytes += (uint64_t) width * (uint64_t) height * bytes_per_pixel(format, type);
+    }
+};
+
+template <>
+struct CallHook<GL_FN_VertexAttribPointer>
+{
+    static void on_call(GLuint index, GLint size, GLenum type, GLboolean, GLsizei stride, const void *)
+    {
+        if (index >= MAX_VERTEX_ATTRIBUTES) return;
+        s_attribute_bytes[index] = stride != 0 ? (uint32_t) stride : (uint32_t) size * bytes_per_component(type);
+    }
+};
+
+template <>
+struct CallHook<GL_FN_EnableVertexAttribArray>
+{
+    static void on_call(GLuint index) { if (index < MAX_VERTEX_ATTRIBUTES) s_attribute_enabled[index] = true; }
+};
+
+template <>
+struct CallHook<GL_FN_DisableVertexAttribArray>
+{
+    static void on_call(GLuint index) { if (index < MAX_VERTEX_ATTRIBUTES) s_attribute_enabled[index] = false; }
+};
+
+template <>
+struct CallHook<GL_FN_DrawArrays>
+{
+    static void on_call(GLenum, GLint, GLsizei count)
+    {
+        for (int i = 0; i < MAX_VERTEX_ATTRIBUTES; i++)
+        {
+            if (s_attribute_enabled[i]) s_frame.vertex_bytes += (uint64_t) count * s_attribute_bytes[i];
+        }
+    }
+};
+
+class CallTimer
+{
+private:
+    GLFunction        m_function;
+    Clock::time_point m_start;
+
+public:
+    explicit CallTimer(GLFunction function) : m_function(function), m_start(Clock::now()) {}
+    ~CallTimer()
+    {
+        uint64_t elapsed = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+        s_frame.calls[m_function]++;
+        s_frame.nanoseconds += elapsed;
+        s_total_nanoseconds[m_function] += elapsed;
+    }
+};
+
+#define GL_DISPATCH_COUNTING(RET, NAME, PARAMS, ARGS) \
+    static RET APIENTRY counting_##NAME PARAMS \
+    { \
+        CallHook<GL_FN_##NAME>::on_call ARGS; \
+        CallTimer timer(GL_FN_##NAME); \
+        return s_next.NAME ARGS; \
+    }
+GL_DISPATCH_FUNCTIONS(GL_DISPATCH_COUNTING)
+#undef GL_DISPATCH_COUNTING
+
+void gl_enable_call_counting()
+{
+    if (s_counting) return;
+
+    s_next = g_gl;
+#define GL_DISPATCH_INSTALL(RET, NAME, PARAMS, ARGS) g_gl.NAME = counting_##NAME;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_INSTALL)
+#undef GL_DISPATCH_INSTALL
+    s_counting = true;
+}
+
+bool const gl_is_counting_calls()
+{
+    return s_counting;
+}
+
+bool gl_open_call_log(const char *filepath)
+{
+    s_call_log = fopen(filepath, "w");
+    if (s_call_log == nullptr) return false;
+
+    fprintf(s_call_log, "frame");
+    for (int i = 0; i < GL_FUNCTION_COUNT; i++) fprintf(s_call_log, ",%s", GL_FUNCTION_NAMES[i]);
+    fprintf(s_call_log, ",texture_bytes,vertex_bytes,gl_microseconds\n");
+    return true;
+}
+
+void gl_end_frame()
+{
+    if (!s_counting) return;
+
+    for (int i = 0; i < GL_FUNCTION_COUNT; i++) s_total_calls[i] += s_frame.calls[i];
+
+    if (s_call_log != nullptr)
+    {
+        fprintf(s_call_log, "%llu", (unsigned long long) s_frame_count);
+        for (int i = 0; i < GL_FUNCTION_COUNT; i++) fprintf(s_call_log, ",%u", s_frame.calls[i]);
+        fprintf(s_call_log, ",%llu,%llu,%.1f\n", (unsigned long long) s_frame.texture_bytes,
+                (unsigned long long) s_frame.vertex_bytes, (double) s_frame.nanoseconds / 1000.0);
+    }
+
+    s_frame_count++;
+    s_last_frame = s_frame;
+    memset(&s_frame, 0, sizeof(s_frame));
+}
+
+const GLFrameCounts &gl_get_last_frame_counts()
+{
+    return s_last_frame;
+}
+
+void gl_log_call_stats()
+{
+    if (s_call_log != nullptr)
+    {
+        fclose(s_call_log);
+        s_call_log = nullptr;
+    }
+    if (!s_counting || s_frame_count == 0) return;
+
+    LOG("GL calls per frame over " << s_frame_count << " frames:");
+    for (int i = 0; i < GL_FUNCTION_COUNT; i++)
+    {
+        if (s_total_calls[i] == 0) continue;
+        LOG("  " << GL_FUNCTION_NAMES[i] << ": " << (double) s_total_calls[i] / s_frame_count << " calls, "
+            << (double) s_total_nanoseconds[i] / s_frame_count / 1000.0 << "us");
+    }
+}
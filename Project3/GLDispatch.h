@@ -0,0 +1,132 @@
+#ifndef GL_DISPATCH_H
+#define GL_DISPATCH_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstdint>
+
+#ifndef APIENTRY
+    #define APIENTRY
+#endif
+
+// Every GL entry point the game calls. All GL goes through g_gl rather than the global
+// functions, so a layer can be slotted in underneath without touching the call sites.
+// X(return type, name without the gl prefix, parameters, arguments)
+#define GL_DISPATCH_FUNCTIONS(X) \
+    X(void,            ActiveTexture,            (GLenum unit), (unit)) \
+    X(void,            AttachShader,             (GLuint program, GLuint shader), (program, shader)) \
+    X(void,            BeginQuery,               (GLenum target, GLuint id), (target, id)) \
+    X(void,            BindBuffer,               (GLenum target, GLuint buffer), (target, buffer)) \
+    X(void,            BindFramebuffer,          (GLenum target, GLuint framebuffer), (target, framebuffer)) \
+    X(void,            BindTexture,              (GLenum target, GLuint texture), (target, texture)) \
+    X(void,            BlendFunc,                (GLenum source, GLenum destination), (source, destination)) \
+    X(void,            BufferData,               (GLenum target, GLsizeiptr size, const void *data, GLenum usage), (target, size, data, usage)) \
+    X(GLenum,          CheckFramebufferStatus,   (GLenum target), (target)) \
+    X(void,            Clear,                    (GLbitfield mask), (mask)) \
+    X(void,            ClearColor,               (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha)) \
+    X(void,            CompileShader,            (GLuint shader), (shader)) \
+    X(GLuint,          CreateProgram,            (void), ()) \
+    X(GLuint,          CreateShader,             (GLenum type), (type)) \
+    X(void,            DeleteBuffers,            (GLsizei count, const GLuint *buffers), (count, buffers)) \
+    X(void,            DeleteFramebuffers,       (GLsizei count, const GLuint *framebuffers), (count, framebuffers)) \
+    X(void,            DeleteProgram,            (GLuint program), (program)) \
+    X(void,            DeleteQueries,            (GLsizei count, const GLuint *queries), (count, queries)) \
+    X(void,            DeleteShader,             (GLuint shader), (shader)) \
+    X(void,            DeleteTextures,           (GLsizei count, const GLuint *textures), (count, textures)) \
+    X(void,            DisableVertexAttribArray, (GLuint index), (index)) \
+    X(void,            DrawArrays,               (GLenum mode, GLint first, GLsizei count), (mode, first, count)) \
+    X(void,            Enable,                   (GLenum capability), (capability)) \
+    X(void,            EnableVertexAttribArray,  (GLuint index), (index)) \
+    X(void,            EndQuery,                 (GLenum target), (target)) \
+    X(void,            Finish,                   (void), ()) \
+    X(void,            FramebufferTexture2D,     (GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level), (target, attachment, texture_target, texture, level)) \
+    X(void,            GenBuffers,               (GLsizei count, GLuint *buffers), (count, buffers)) \
+    X(void,            GenFramebuffers,          (GLsizei count, GLuint *framebuffers), (count, framebuffers)) \
+    X(void,            GenQueries,               (GLsizei count, GLuint *queries), (count, queries)) \
+    X(void,            GenTextures,              (GLsizei count, GLuint *textures), (count, textures)) \
+    X(GLint,           GetAttribLocation,        (GLuint program, const GLchar *name), (program, name)) \
+    X(void,            GetIntegerv,              (GLenum name, GLint *value), (name, value)) \
+    X(void,            GetProgramBinary,         (GLuint program, GLsizei size, GLsizei *length, GLenum *format, void *binary), (program, size, length, format, binary)) \
+    X(void,            GetProgramiv,             (GLuint program, GLenum name, GLint *value), (program, name, value)) \
+    X(void,            GetQueryObjectiv,         (GLuint query, GLenum name, GLint *value), (query, name, value)) \
+    X(void,            GetQueryObjectui64v,      (GLuint query, GLenum name, GLuint64 *value), (query, name, value)) \
+    X(void,            GetShaderInfoLog,         (GLuint shader, GLsizei size, GLsizei *length, GLchar *log), (shader, size, length, log)) \
+    X(void,            GetShaderiv,              (GLuint shader, GLenum name, GLint *value), (shader, name, value)) \
+    X(const GLubyte *, GetString,                (GLenum name), (name)) \
+    X(GLint,           GetUniformLocation,       (GLuint program, const GLchar *name), (program, name)) \
+    X(void,            LinkProgram,              (GLuint program), (program)) \
+    X(void *,          MapBuffer,                (GLenum target, GLenum access), (target, access)) \
+    X(void,            MaxShaderCompilerThreadsKHR, (GLuint count), (count)) \
+    X(void,            PixelStorei,              (GLenum name, GLint value), (name, value)) \
+    X(void,            ProgramBinary,            (GLuint program, GLenum format, const void *binary, GLsizei length), (program, format, binary, length)) \
+    X(void,            ProgramParameteri,        (GLuint program, GLenum name, GLint value), (program, name, value)) \
+    X(void,            ReadPixels,               (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels), (x, y, width, height, format, type, pixels)) \
+    X(void,            ShaderSource,             (GLuint shader, GLsizei count, const GLchar *const *source, const GLint *length), (shader, count, source, length)) \
+    X(void,            TexImage2D,               (GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels), (target, level, internal_format, width, height, border, format, type, pixels)) \
+    X(void,            TexParameteri,            (GLenum target, GLenum name, GLint value), (target, name, value)) \
+    X(void,            Uniform1i,                (GLint location, GLint value), (location, value)) \
+    X(void,            Uniform4f,                (GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w), (location, x, y, z, w)) \
+    X(void,            UniformMatrix4fv,         (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value), (location, count, transpose, value)) \
+    X(GLboolean,       UnmapBuffer,              (GLenum target), (target)) \
+    X(void,            UseProgram,               (GLuint program), (program)) \
+    X(void,            VertexAttribPointer,      (GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, const void *pointer), (index, size, type, normalised, stride, pointer)) \
+    X(void,            Viewport,                 (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+
+enum GLFunction
+{
+#define GL_DISPATCH_ENUM(RET, NAME, PARAMS, ARGS) GL_FN_##NAME,
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_ENUM)
+#undef GL_DISPATCH_ENUM
+    GL_FUNCTION_COUNT
+};
+extern const char *const GL_FUNCTION_NAMES[GL_FUNCTION_COUNT];
+
+struct GLDispatch
+{
+#define GL_DISPATCH_MEMBER(RET, NAME, PARAMS, ARGS) RET (APIENTRY *NAME) PARAMS;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_MEMBER)
+#undef GL_DISPATCH_MEMBER
+};
+
+// The table every call site goes through. Empty until gl_load_native().
+extern GLDispatch g_gl;
+
+// Points g_gl at the driver. Needs a current context (and glewInit on Windows).
+void gl_load_native();
+
+// glGetString as text. Empty rather than null when there's no current context, so it can go
+// straight into a log.
+const char *gl_string(GLenum name);
+
+// ————— CALL COUNTING ————— //
+// What one frame asked of GL. Vertex bytes are what the client-side attribute arrays fed to
+// each draw call, which is what the driver has to copy.
+struct GLFrameCounts
+{
+    uint32_t calls[GL_FUNCTION_COUNT];
+    uint64_t nanoseconds;
+    uint64_t texture_bytes;
+    uint64_t vertex_bytes;
+};
+
+// Wraps whatever table is installed in a layer that counts and times every call. GL thread
+// only from then on.
+void gl_enable_call_counting();
+bool const gl_is_counting_calls();
+
+// Also writes one CSV row per frame to `filepath`
+bool gl_open_call_log(const char *filepath);
+
+// GL thread, once per presented frame
+void gl_end_frame();
+
+const GLFrameCounts &gl_get_last_frame_counts();
+
+// Mean calls and time per frame for every entry point that was called
+void gl_log_call_stats();
+
+#endif // GL_DISPATCH_H
@@ -0,0 +1,736 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "GLNull.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "BinaryFile.h"
+
+constexpr GLuint MAX_OBJECTS           = 256;  // Per kind; ids run from 1
+constexpr GLuint MAX_VERTEX_ATTRIBUTES = 16;
+constexpr GLuint MAX_TEXTURE_UNITS     = 8;
+constexpr int    RECENT_CALLS          = 32;
+constexpr int    MAX_LOGGED_ERRORS     = 16;   // Past this, errors are only counted
+
+struct NullShader
+{
+    bool   live       = false;
+    bool   has_source = false;
+    bool   compiled   = false;
+};
+
+struct NullProgram
+{
+    bool  live              = false;
+    bool  linked            = false;
+    int   attached_shaders  = 0;
+    GLint uniform_count     = 0;   // Locations handed out so far
+    GLint attribute_count   = 0;
+};
+
+struct NullAttribute
+{
+    bool        enabled = false;
+    GLint       size    = 0;
+    GLenum      type    = GL_FLOAT;
+    GLsizei     stride  = 0;
+    const void *pointer = nullptr;
+};
+
+struct RecordedCall
+{
+    GLFunction function;
+    uint64_t   arguments[3];
+};
+
+// ————— STATE ————— //
+static bool          s_textures[MAX_OBJECTS];
+static bool          s_buffers[MAX_OBJECTS];
+static bool          s_queries[MAX_OBJECTS];
+static bool          s_framebuffers[MAX_OBJECTS];
+static std::vector<unsigned char> s_buffer_data[MAX_OBJECTS];   // What MapBuffer hands out
+static NullShader    s_shaders[MAX_OBJECTS];
+static NullProgram   s_programs[MAX_OBJECTS];
+static GLuint        s_next_texture = 1, s_next_buffer = 1, s_next_query = 1, s_next_shader = 1, s_next_program = 1,
+                     s_next_framebuffer = 1;
+
+static GLuint        s_current_program    = 0;
+static GLuint        s_bound_textures[MAX_TEXTURE_UNITS];
+static GLuint        s_active_texture_unit = 0;   // Index from GL_TEXTURE0
+static GLuint        s_bound_framebuffer  = 0;
+static GLuint        s_bound_pack_buffer  = 0;   // GL_PIXEL_PACK_BUFFER
+static GLuint        s_bound_array_buffer = 0;
+static bool          s_buffer_mapped      = false;
+static bool          s_query_active       = false;
+static NullAttribute s_attributes[MAX_VERTEX_ATTRIBUTES];
+
+static GLNullStats   s_stats;
+static RecordedCall  s_recent[RECENT_CALLS];
+static uint64_t      s_recent_count = 0;
+
+// ————— RECORDING ————— //
+// FNV-1a's xor and multiply, but a 64-bit word at a time rather than a byte, so the checksum
+// stays cheap next to the work being measured. It only has to be the same run to run, so it
+// doesn't have to match hash_bytes().
+static void add_to_checksum(const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        s_stats.checksum ^= word;
+        s_stats.checksum *= FNV_PRIME;
+    }
+    for (; i < size; i++)
+    {
+        s_stats.checksum ^= bytes[i];
+        s_stats.checksum *= FNV_PRIME;
+    }
+}
+
+static void record(GLFunction function, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0)
+{
+    RecordedCall &call = s_recent[s_recent_count++ % RECENT_CALLS];
+    call.function     = function;
+    call.arguments[0] = a;
+    call.arguments[1] = b;
+    call.arguments[2] = c;
+
+    s_stats.calls++;
+    add_to_checksum(&call, sizeof(call));
+}
+
+static uint64_t float_bits(GLfloat value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void fail(GLFunction function, const char *reason)
+{
+    s_stats.errors++;
+    if (s_stats.errors <= MAX_LOGGED_ERRORS) LOG("GL null: " << GL_FUNCTION_NAMES[function] << ": " << reason);
+}
+
+// ————— OBJECTS ————— //
+static void generate_objects(bool *objects, GLuint &next, GLFunction function, GLsizei count, GLuint *ids)
+{
+    record(function, (uint64_t) count);
+    if (count < 0 || ids == nullptr) return fail(function, "bad count or null output");
+
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (next >= MAX_OBJECTS)
+        {
+            ids[i] = 0;
+            fail(function, "out of object names");
+            continue;
+        }
+        objects[next] = true;
+        ids[i] = next++;
+    }
+}
+
+static void delete_objects(bool *objects, GLFunction function, GLsizei count, const GLuint *ids)
+{
+    record(function, (uint64_t) count);
+    if (count < 0 || (count > 0 && ids == nullptr)) return fail(function, "bad count or null input");
+
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (ids[i] == 0) continue;
+        if (ids[i] >= MAX_OBJECTS || !objects[ids[i]]) { fail(function, "not a live object"); continue; }
+        objects[ids[i]] = false;
+    }
+}
+
+static bool const is_live_shader(GLuint shader)   { return shader > 0 && shader < MAX_OBJECTS && s_shaders[shader].live; }
+static bool const is_live_program(GLuint program) { return program > 0 && program < MAX_OBJECTS && s_programs[program].live; }
+
+// Uniforms go to the current program, which must be linked and have handed out the location
+static bool check_uniform(GLFunction function, GLint location)
+{
+    if (!is_live_program(s_current_program) || !s_programs[s_current_program].linked)
+    {
+        fail(function, "no linked program in use");
+        return false;
+    }
+    // -1 is what a missing uniform gets, and GL ignores it
+    if (location < -1 || location >= s_programs[s_current_program].uniform_count)
+    {
+        fail(function, "location not from this program");
+        return false;
+    }
+    return true;
+}
+
+static uint32_t bytes_per_component(GLenum type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:   return 1;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: return 2;
+    default:                               return 4;
+    }
+}
+
+// ————— ENTRY POINTS ————— //
+static void APIENTRY null_ActiveTexture(GLenum unit)
+{
+    record(GL_FN_ActiveTexture, unit);
+    if (unit < GL_TEXTURE0 || unit >= GL_TEXTURE0 + MAX_TEXTURE_UNITS) return fail(GL_FN_ActiveTexture, "bad unit");
+    s_active_texture_unit = unit - GL_TEXTURE0;
+}
+
+static void APIENTRY null_AttachShader(GLuint program, GLuint shader)
+{
+    record(GL_FN_AttachShader, program, shader);
+    if (!is_live_program(program)) return fail(GL_FN_AttachShader, "not a program");
+    if (!is_live_shader(shader))   return fail(GL_FN_AttachShader, "not a shader");
+    s_programs[program].attached_shaders++;
+}
+
+static void APIENTRY null_BeginQuery(GLenum target, GLuint id)
+{
+    record(GL_FN_BeginQuery, target, id);
+    if (target != GL_TIME_ELAPSED)                      return fail(GL_FN_BeginQuery, "bad target");
+    if (id == 0 || id >= MAX_OBJECTS || !s_queries[id]) return fail(GL_FN_BeginQuery, "not a query");
+    if (s_query_active)                                 return fail(GL_FN_BeginQuery, "query already active");
+    s_query_active = true;
+}
+
+// The buffer a target refers to, or null for targets the game doesn't use
+static GLuint *bound_buffer(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:      return &s_bound_array_buffer;
+    case GL_PIXEL_PACK_BUFFER: return &s_bound_pack_buffer;
+    default:                   return nullptr;
+    }
+}
+
+static void APIENTRY null_BindBuffer(GLenum target, GLuint buffer)
+{
+    record(GL_FN_BindBuffer, target, buffer);
+    GLuint *binding = bound_buffer(target);
+    if (binding == nullptr) return fail(GL_FN_BindBuffer, "bad target");
+    if (buffer != 0 && (buffer >= MAX_OBJECTS || !s_buffers[buffer])) return fail(GL_FN_BindBuffer, "not a buffer");
+    *binding = buffer;
+}
+
+static void APIENTRY null_BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    record(GL_FN_BindFramebuffer, target, framebuffer);
+    if (target != GL_FRAMEBUFFER) return fail(GL_FN_BindFramebuffer, "bad target");
+    if (framebuffer != 0 && (framebuffer >= MAX_OBJECTS || !s_framebuffers[framebuffer]))
+        return fail(GL_FN_BindFramebuffer, "not a framebuffer");
+    s_bound_framebuffer = framebuffer;
+}
+
+static void APIENTRY null_BindTexture(GLenum target, GLuint texture)
+{
+    record(GL_FN_BindTexture, target, texture);
+    if (target != GL_TEXTURE_2D) return fail(GL_FN_BindTexture, "bad target");
+    if (texture != 0 && (texture >= MAX_OBJECTS || !s_textures[texture])) return fail(GL_FN_BindTexture, "not a texture");
+    s_bound_textures[s_active_texture_unit] = texture;
+}
+
+static void APIENTRY null_BlendFunc(GLenum source, GLenum destination)
+{
+    record(GL_FN_BlendFunc, source, destination);
+}
+
+static void APIENTRY null_BufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    record(GL_FN_BufferData, target, (uint64_t) size, usage);
+    GLuint *binding = bound_buffer(target);
+    if (binding == nullptr)        return fail(GL_FN_BufferData, "bad target");
+    if (*binding == 0)             return fail(GL_FN_BufferData, "no buffer bound");
+    if (size < 0)                  return fail(GL_FN_BufferData, "negative size");
+    if (s_buffer_mapped)           return fail(GL_FN_BufferData, "buffer is mapped");
+
+    std::vector<unsigned char> &contents = s_buffer_data[*binding];
+    contents.assign((size_t) size, 0);
+    if (data != nullptr) memcpy(contents.data(), data, (size_t) size);
+}
+
+static GLenum APIENTRY null_CheckFramebufferStatus(GLenum target)
+{
+    record(GL_FN_CheckFramebufferStatus, target);
+    if (target != GL_FRAMEBUFFER)
+    {
+        fail(GL_FN_CheckFramebufferStatus, "bad target");
+        return 0;
+    }
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static void APIENTRY null_Clear(GLbitfield mask)
+{
+    record(GL_FN_Clear, mask);
+    if ((mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)) != 0) fail(GL_FN_Clear, "bad mask");
+}
+
+static void APIENTRY null_ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    record(GL_FN_ClearColor, float_bits(red) | float_bits(green) << 32, float_bits(blue) | float_bits(alpha) << 32);
+}
+
+static void APIENTRY null_CompileShader(GLuint shader)
+{
+    record(GL_FN_CompileShader, shader);
+    if (!is_live_shader(shader))        return fail(GL_FN_CompileShader, "not a shader");
+    if (!s_shaders[shader].has_source) return fail(GL_FN_CompileShader, "no source");
+    s_shaders[shader].compiled = true;
+}
+
+static GLuint APIENTRY null_CreateProgram(void)
+{
+    record(GL_FN_CreateProgram);
+    if (s_next_program >= MAX_OBJECTS)
+    {
+        fail(GL_FN_CreateProgram, "out of object names");
+        return 0;
+    }
+    s_programs[s_next_program] = NullProgram();
+    s_programs[s_next_program].live = true;
+    return s_next_program++;
+}
+
+static GLuint APIENTRY null_CreateShader(GLenum type)
+{
+    record(GL_FN_CreateShader, type);
+    if (type != GL_VERTEX_SHADER && type != GL_FRAGMENT_SHADER)
+    {
+        fail(GL_FN_CreateShader, "bad type");
+        return 0;
+    }
+    if (s_next_shader >= MAX_OBJECTS)
+    {
+        fail(GL_FN_CreateShader, "out of object names");
+        return 0;
+    }
+    s_shaders[s_next_shader] = NullShader();
+    s_shaders[s_next_shader].live = true;
+    return s_next_shader++;
+}
+
+static void APIENTRY null_DeleteBuffers(GLsizei count, const GLuint *buffers)
+{
+    delete_objects(s_buffers, GL_FN_DeleteBuffers, count, buffers);
+}
+
+static void APIENTRY null_DeleteFramebuffers(GLsizei count, const GLuint *framebuffers)
+{
+    delete_objects(s_framebuffers, GL_FN_DeleteFramebuffers, count, framebuffers);
+    if (s_bound_framebuffer != 0 && !s_framebuffers[s_bound_framebuffer]) s_bound_framebuffer = 0;
+}
+
+static void APIENTRY null_DeleteProgram(GLuint program)
+{
+    record(GL_FN_DeleteProgram, program);
+    if (program == 0) return;
+    if (!is_live_program(program)) return fail(GL_FN_DeleteProgram, "not a program");
+    s_programs[program].live = false;
+    if (s_current_program == program) s_current_program = 0;
+}
+
+static void APIENTRY null_DeleteQueries(GLsizei count, const GLuint *queries)
+{
+    delete_objects(s_queries, GL_FN_DeleteQueries, count, queries);
+}
+
+static void APIENTRY null_DeleteShader(GLuint shader)
+{
+    record(GL_FN_DeleteShader, shader);
+    if (shader == 0) return;
+    if (!is_live_shader(shader)) return fail(GL_FN_DeleteShader, "not a shader");
+    s_shaders[shader].live = false;
+}
+
+static void APIENTRY null_DeleteTextures(GLsizei count, const GLuint *textures)
+{
+    delete_objects(s_textures, GL_FN_DeleteTextures, count, textures);
+    for (GLuint &bound : s_bound_textures)
+        if (bound != 0 && !s_textures[bound]) bound = 0;
+}
+
+static void APIENTRY null_DisableVertexAttribArray(GLuint index)
+{
+    record(GL_FN_DisableVertexAttribArray, index);
+    if (index >= MAX_VERTEX_ATTRIBUTES) return fail(GL_FN_DisableVertexAttribArray, "bad index");
+    s_attributes[index].enabled = false;
+}
+
+static void APIENTRY null_DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    record(GL_FN_DrawArrays, mode, (uint64_t) first, (uint64_t) count);
+    if (mode > GL_TRIANGLE_FAN)   return fail(GL_FN_DrawArrays, "bad mode");
+    if (first < 0 || count < 0)  return fail(GL_FN_DrawArrays, "negative range");
+    if (!is_live_program(s_current_program) || !s_programs[s_current_program].linked)
+        return fail(GL_FN_DrawArrays, "no linked program in use");
+
+    // Read every vertex the way the driver would have to, and record what was drawn
+    for (GLuint index = 0; index < MAX_VERTEX_ATTRIBUTES; index++)
+    {
+        const NullAttribute &attribute = s_attributes[index];
+        if (!attribute.enabled) continue;
+        if (attribute.pointer == nullptr) return fail(GL_FN_DrawArrays, "enabled attribute has no array");
+
+        size_t element = (size_t) attribute.size * bytes_per_component(attribute.type);
+        size_t stride  = attribute.stride != 0 ? (size_t) attribute.stride : element;
+        const unsigned char *data = (const unsigned char *) attribute.pointer + (size_t) first * stride;
+        for (GLsizei vertex = 0; vertex < count; vertex++) add_to_checksum(data + (size_t) vertex * stride, element);
+    }
+    s_stats.vertices += (uint64_t) count;
+}
+
+static void APIENTRY null_Enable(GLenum capability)
+{
+    record(GL_FN_Enable, capability);
+}
+
+static void APIENTRY null_EnableVertexAttribArray(GLuint index)
+{
+    record(GL_FN_EnableVertexAttribArray, index);
+    if (index >= MAX_VERTEX_ATTRIBUTES) return fail(GL_FN_EnableVertexAttribArray, "bad index");
+    s_attributes[index].enabled = true;
+}
+
+static void APIENTRY null_EndQuery(GLenum target)
+{
+    record(GL_FN_EndQuery, target);
+    if (target != GL_TIME_ELAPSED) return fail(GL_FN_EndQuery, "bad target");
+    if (!s_query_active)           return fail(GL_FN_EndQuery, "no active query");
+    s_query_active = false;
+}
+
+static void APIENTRY null_Finish(void)
+{
+    record(GL_FN_Finish);
+}
+
+static void APIENTRY null_FramebufferTexture2D(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture,
+                                              GLint level)
+{
+    record(GL_FN_FramebufferTexture2D, attachment, texture, (uint64_t) level);
+    if (target != GL_FRAMEBUFFER || texture_target != GL_TEXTURE_2D) return fail(GL_FN_FramebufferTexture2D, "bad target");
+    if (s_bound_framebuffer == 0)                                    return fail(GL_FN_FramebufferTexture2D, "no framebuffer bound");
+    if (texture != 0 && (texture >= MAX_OBJECTS || !s_textures[texture]))
+        return fail(GL_FN_FramebufferTexture2D, "not a texture");
+}
+
+static void APIENTRY null_GenBuffers(GLsizei count, GLuint *buffers)
+{
+    generate_objects(s_buffers, s_next_buffer, GL_FN_GenBuffers, count, buffers);
+}
+
+static void APIENTRY null_GenFramebuffers(GLsizei count, GLuint *framebuffers)
+{
+    generate_objects(s_framebuffers, s_next_framebuffer, GL_FN_GenFramebuffers, count, framebuffers);
+}
+
+static void APIENTRY null_GenQueries(GLsizei count, GLuint *queries)
+{
+    generate_objects(s_queries, s_next_query, GL_FN_GenQueries, count, queries);
+}
+
+static void APIENTRY null_GenTextures(GLsizei count, GLuint *textures)
+{
+    generate_objects(s_textures, s_next_texture, GL_FN_GenTextures, count, textures);
+}
+
+static GLint APIENTRY null_GetAttribLocation(GLuint program, const GLchar *name)
+{
+    record(GL_FN_GetAttribLocation, program);
+    if (name == nullptr) { fail(GL_FN_GetAttribLocation, "null name"); return -1; }
+    add_to_checksum(name, strlen(name));
+    if (!is_live_program(program) || !s_programs[program].linked) { fail(GL_FN_GetAttribLocation, "not a linked program"); return -1; }
+    if (s_programs[program].attribute_count >= (GLint) MAX_VERTEX_ATTRIBUTES) return -1;
+    return s_programs[program].attribute_count++;
+}
+
+// The null context is GL 2.1 with no extensions, so it has no binary formats to report
+static void APIENTRY null_GetIntegerv(GLenum name, GLint *value)
+{
+    record(GL_FN_GetIntegerv, name);
+    if (value == nullptr) return fail(GL_FN_GetIntegerv, "null output");
+    if (name == GL_NUM_PROGRAM_BINARY_FORMATS) *value = 0;
+    else                                       fail(GL_FN_GetIntegerv, "unsupported parameter");
+}
+
+static void APIENTRY null_GetProgramBinary(GLuint program, GLsizei, GLsizei *length, GLenum *, void *)
+{
+    record(GL_FN_GetProgramBinary, program);
+    if (length != nullptr) *length = 0;
+    fail(GL_FN_GetProgramBinary, "no program binary formats");
+}
+
+static void APIENTRY null_GetProgramiv(GLuint program, GLenum name, GLint *value)
+{
+    record(GL_FN_GetProgramiv, program, name);
+    if (value == nullptr)          return fail(GL_FN_GetProgramiv, "null output");
+    if (!is_live_program(program)) return fail(GL_FN_GetProgramiv, "not a program");
+    if (name == GL_LINK_STATUS)          *value = s_programs[program].linked ? GL_TRUE : GL_FALSE;
+    else if (name == GL_INFO_LOG_LENGTH) *value = 0;
+    else                                 fail(GL_FN_GetProgramiv, "unsupported parameter");
+}
+
+static void APIENTRY null_GetQueryObjectiv(GLuint query, GLenum name, GLint *value)
+{
+    record(GL_FN_GetQueryObjectiv, query, name);
+    if (value == nullptr)                                        return fail(GL_FN_GetQueryObjectiv, "null output");
+    if (query == 0 || query >= MAX_OBJECTS || !s_queries[query]) return fail(GL_FN_GetQueryObjectiv, "not a query");
+    *value = name == GL_QUERY_RESULT_AVAILABLE ? 1 : 0;
+}
+
+static void APIENTRY null_GetQueryObjectui64v(GLuint query, GLenum name, GLuint64 *value)
+{
+    record(GL_FN_GetQueryObjectui64v, query, name);
+    if (value == nullptr)                                        return fail(GL_FN_GetQueryObjectui64v, "null output");
+    if (query == 0 || query >= MAX_OBJECTS || !s_queries[query]) return fail(GL_FN_GetQueryObjectui64v, "not a query");
+    *value = 0;
+}
+
+static void APIENTRY null_GetShaderInfoLog(GLuint shader, GLsizei size, GLsizei *length, GLchar *log)
+{
+    record(GL_FN_GetShaderInfoLog, shader, (uint64_t) size);
+    if (!is_live_shader(shader)) return fail(GL_FN_GetShaderInfoLog, "not a shader");
+    if (length != nullptr) *length = 0;
+    if (size > 0 && log != nullptr) log[0] = '\0';
+}
+
+static void APIENTRY null_GetShaderiv(GLuint shader, GLenum name, GLint *value)
+{
+    record(GL_FN_GetShaderiv, shader, name);
+    if (value == nullptr)        return fail(GL_FN_GetShaderiv, "null output");
+    if (!is_live_shader(shader)) return fail(GL_FN_GetShaderiv, "not a shader");
+    if (name == GL_COMPILE_STATUS)       *value = s_shaders[shader].compiled ? GL_TRUE : GL_FALSE;
+    else if (name == GL_INFO_LOG_LENGTH) *value = 0;
+    else                                 fail(GL_FN_GetShaderiv, "unsupported parameter");
+}
+
+static const GLubyte *APIENTRY null_GetString(GLenum name)
+{
+    record(GL_FN_GetString, name);
+    switch (name)
+    {
+    case GL_VENDOR:     return (const GLubyte *) "null";
+    case GL_RENDERER:   return (const GLubyte *) "null";
+    case GL_VERSION:    return (const GLubyte *) "2.1 null";
+    case GL_EXTENSIONS: return (const GLubyte *) "";
+    default:
+        fail(GL_FN_GetString, "bad name");
+        return nullptr;
+    }
+}
+
+static GLint APIENTRY null_GetUniformLocation(GLuint program, const GLchar *name)
+{
+    record(GL_FN_GetUniformLocation, program);
+    if (name == nullptr) { fail(GL_FN_GetUniformLocation, "null name"); return -1; }
+    add_to_checksum(name, strlen(name));
+    if (!is_live_program(program) || !s_programs[program].linked) { fail(GL_FN_GetUniformLocation, "not a linked program"); return -1; }
+    return s_programs[program].uniform_count++;
+}
+
+static void APIENTRY null_LinkProgram(GLuint program)
+{
+    record(GL_FN_LinkProgram, program);
+    if (!is_live_program(program)) return fail(GL_FN_LinkProgram, "not a program");
+    s_programs[program].linked = s_programs[program].attached_shaders > 0;
+}
+
+static void *APIENTRY null_MapBuffer(GLenum target, GLenum access)
+{
+    record(GL_FN_MapBuffer, target, access);
+    GLuint *binding = bound_buffer(target);
+    if (binding == nullptr || *binding == 0) { fail(GL_FN_MapBuffer, "no buffer bound"); return nullptr; }
+    if (s_buffer_mapped)                     { fail(GL_FN_MapBuffer, "already mapped"); return nullptr; }
+    s_buffer_mapped = true;
+    return s_buffer_data[*binding].data();
+}
+
+static void APIENTRY null_MaxShaderCompilerThreadsKHR(GLuint count)
+{
+    record(GL_FN_MaxShaderCompilerThreadsKHR, count);
+    fail(GL_FN_MaxShaderCompilerThreadsKHR, "KHR_parallel_shader_compile not supported");
+}
+
+static void APIENTRY null_PixelStorei(GLenum name, GLint value)
+{
+    record(GL_FN_PixelStorei, name, (uint64_t) value);
+    if (name != GL_UNPACK_ALIGNMENT && name != GL_PACK_ALIGNMENT) return fail(GL_FN_PixelStorei, "unsupported parameter");
+    if (value != 1 && value != 2 && value != 4 && value != 8)     return fail(GL_FN_PixelStorei, "bad alignment");
+}
+
+static void APIENTRY null_ProgramBinary(GLuint program, GLenum format, const void *, GLsizei length)
+{
+    record(GL_FN_ProgramBinary, program, format, (uint64_t) length);
+    fail(GL_FN_ProgramBinary, "no program binary formats");
+}
+
+static void APIENTRY null_ProgramParameteri(GLuint program, GLenum name, GLint value)
+{
+    record(GL_FN_ProgramParameteri, program, name, (uint64_t) value);
+    fail(GL_FN_ProgramParameteri, "program binaries not supported");
+}
+
+static void APIENTRY null_ReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                                     void *pixels)
+{
+    record(GL_FN_ReadPixels, (uint64_t) x << 32 | (uint32_t) y, (uint64_t) width << 32 | (uint32_t) height,
+           (uint64_t) format << 32 | type);
+    if (format != GL_RGBA || type != GL_UNSIGNED_BYTE) return fail(GL_FN_ReadPixels, "only RGBA bytes are supported");
+    if (x < 0 || y < 0 || width < 0 || height < 0)     return fail(GL_FN_ReadPixels, "bad rectangle");
+
+    // Nothing was drawn, so the pixels read back are black
+    size_t size = (size_t) width * (size_t) height * 4;
+    if (s_bound_pack_buffer == 0)
+    {
+        if (pixels == nullptr) return fail(GL_FN_ReadPixels, "null output");
+        memset(pixels, 0, size);
+        return;
+    }
+
+    std::vector<unsigned char> &contents = s_buffer_data[s_bound_pack_buffer];
+    size_t offset = (size_t) pixels;
+    if (offset + size > contents.size()) return fail(GL_FN_ReadPixels, "pack buffer too small");
+    memset(contents.data() + offset, 0, size);
+}
+
+static void APIENTRY null_ShaderSource(GLuint shader, GLsizei count, const GLchar *const *source, const GLint *length)
+{
+    record(GL_FN_ShaderSource, shader, (uint64_t) count);
+    if (!is_live_shader(shader))         return fail(GL_FN_ShaderSource, "not a shader");
+    if (count <= 0 || source == nullptr) return fail(GL_FN_ShaderSource, "no source");
+
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (source[i] == nullptr) return fail(GL_FN_ShaderSource, "null string");
+        add_to_checksum(source[i], length != nullptr && length[i] >= 0 ? (size_t) length[i] : strlen(source[i]));
+    }
+    s_shaders[shader].has_source = true;
+}
+
+static void APIENTRY null_TexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+                                     GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    record(GL_FN_TexImage2D, (uint64_t) width << 32 | (uint32_t) height, (uint64_t) format << 32 | type,
+           (uint64_t) internal_format);
+    if (target != GL_TEXTURE_2D)                      return fail(GL_FN_TexImage2D, "bad target");
+    if (s_bound_textures[s_active_texture_unit] == 0) return fail(GL_FN_TexImage2D, "no texture bound");
+    if (level < 0 || border != 0)                     return fail(GL_FN_TexImage2D, "bad level or border");
+    if (width < 0 || height < 0)                      return fail(GL_FN_TexImage2D, "negative size");
+
+    // Storage without data is only for render targets, which nothing drawn through here uses,
+    // so a missing image is a texture that would draw as garbage
+    if (pixels == nullptr && width > 0 && height > 0) return fail(GL_FN_TexImage2D, "no pixels");
+}
+
+static void APIENTRY null_TexParameteri(GLenum target, GLenum name, GLint value)
+{
+    record(GL_FN_TexParameteri, target, name, (uint64_t) value);
+    if (target != GL_TEXTURE_2D)                      return fail(GL_FN_TexParameteri, "bad target");
+    if (s_bound_textures[s_active_texture_unit] == 0) return fail(GL_FN_TexParameteri, "no texture bound");
+}
+
+static void APIENTRY null_Uniform1i(GLint location, GLint value)
+{
+    record(GL_FN_Uniform1i, (uint64_t) location, (uint64_t) value);
+    check_uniform(GL_FN_Uniform1i, location);
+}
+
+static void APIENTRY null_Uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    record(GL_FN_Uniform4f, (uint64_t) location, float_bits(x) | float_bits(y) << 32, float_bits(z) | float_bits(w) << 32);
+    check_uniform(GL_FN_Uniform4f, location);
+}
+
+static void APIENTRY null_UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    record(GL_FN_UniformMatrix4fv, (uint64_t) location, (uint64_t) count, transpose);
+    if (!check_uniform(GL_FN_UniformMatrix4fv, location)) return;
+    if (count < 0 || (count > 0 && value == nullptr)) return fail(GL_FN_UniformMatrix4fv, "bad count or null matrix");
+    add_to_checksum(value, (size_t) count * 16 * sizeof(GLfloat));
+}
+
+static GLboolean APIENTRY null_UnmapBuffer(GLenum target)
+{
+    record(GL_FN_UnmapBuffer, target);
+    GLuint *binding = bound_buffer(target);
+    if (binding == nullptr || *binding == 0 || !s_buffer_mapped)
+    {
+        fail(GL_FN_UnmapBuffer, "no mapped buffer bound");
+        return GL_FALSE;
+    }
+    s_buffer_mapped = false;
+    return GL_TRUE;
+}
+
+static void APIENTRY null_UseProgram(GLuint program)
+{
+    record(GL_FN_UseProgram, program);
+    if (program != 0 && (!is_live_program(program) || !s_programs[program].linked))
+        return fail(GL_FN_UseProgram, "not a linked program");
+    s_current_program = program;
+}
+
+static void APIENTRY null_VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride,
+                                             const void *pointer)
+{
+    record(GL_FN_VertexAttribPointer, index, (uint64_t) size << 32 | type, (uint64_t) normalised << 32 | (uint32_t) stride);
+    if (index >= MAX_VERTEX_ATTRIBUTES)                  return fail(GL_FN_VertexAttribPointer, "bad index");
+    if (size < 1 || size > 4)                            return fail(GL_FN_VertexAttribPointer, "bad size");
+    if (normalised != GL_FALSE && normalised != GL_TRUE) return fail(GL_FN_VertexAttribPointer, "bad normalised flag");
+    if (stride < 0)                                      return fail(GL_FN_VertexAttribPointer, "negative stride");
+
+    NullAttribute &attribute = s_attributes[index];
+    attribute.size    = size;
+    attribute.type    = type;
+    attribute.stride  = stride;
+    attribute.pointer = pointer;
+}
+
+static void APIENTRY null_Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    record(GL_FN_Viewport, (uint64_t) x << 32 | (uint32_t) y, (uint64_t) width << 32 | (uint32_t) height);
+    if (width < 0 || height < 0) fail(GL_FN_Viewport, "negative size");
+}
+
+// ————— SETUP ————— //
+void gl_load_null()
+{
+#define GL_DISPATCH_NULL(RET, NAME, PARAMS, ARGS) g_gl.NAME = null_##NAME;
+    GL_DISPATCH_FUNCTIONS(GL_DISPATCH_NULL)
+#undef GL_DISPATCH_NULL
+    gl_null_reset_stats();
+}
+
+GLNullStats const gl_null_stats()
+{
+    return s_stats;
+}
+
+void gl_null_reset_stats()
+{
+    s_stats = GLNullStats();
+    s_stats.checksum = FNV_OFFSET_BASIS;
+    s_recent_count = 0;
+}
+
+void gl_null_log_recent_calls()
+{
+    uint64_t first = s_recent_count > RECENT_CALLS ? s_recent_count - RECENT_CALLS : 0;
+    for (uint64_t i = first; i < s_recent_count; i++)
+    {
+        const RecordedCall &call = s_recent[i % RECENT_CALLS];
+        LOG("  " << GL_FUNCTION_NAMES[call.function] << "(" << call.arguments[0] << ", " << call.arguments[1] << ", "
+            << call.arguments[2] << ")");
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef GL_NULL_H
+#define GL_NULL_H
+
+#include "GLDispatch.h"
+#include <cstdint>
+
+// A GL that draws nothing. Every entry point checks its arguments against the objects and
+// state it has seen, the way a debug driver would, and folds them into a checksum, so the
+// whole render path can run and be timed on a machine with no GPU or display. Single
+// threaded, like a real context.
+struct GLNullStats
+{
+    uint64_t calls    = 0;
+    uint64_t errors   = 0;   // Calls a real driver would have rejected
+    uint64_t vertices = 0;   // Read back out of the attribute arrays by draw calls
+    uint64_t checksum = 0;   // Every argument and every vertex drawn, in order
+};
+
+// Points g_gl at the null backend. Needs no context.
+void gl_load_null();
+
+GLNullStats const gl_null_stats();
+
+// Starts a fresh checksum and counts, e.g. at the start of a measured pass
+void gl_null_reset_stats();
+
+// The last few calls with their arguments, oldest first
+void gl_null_log_recent_calls();
+
+#endif // GL_NULL_H
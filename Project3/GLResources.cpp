@@ -0,0 +1,105 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "GLDispatch.h"
+#include "GLResources.h"
+#include <iostream>
+
+const char *const GL_RESOURCE_TYPE_NAMES[GL_RESOURCE_TYPE_COUNT] = { "textures", "buffers", "programs", "shaders", "framebuffers" };
+
+GLResourceRegistry g_gl_resources;
+
+GLResourceRegistry::GLResourceRegistry()
+{
+    for (int type = 0; type < GL_RESOURCE_TYPE_COUNT; type++)
+    {
+        m_live_count[type] = 0;
+        m_live_bytes[type] = 0;
+    }
+}
+
+void GLResourceRegistry::add(GLResourceType type, GLuint id, size_t bytes, const char *label)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_resources.push_back({ type, id, bytes, label, 0 });
+    m_live_count[type]++;
+    m_live_bytes[type] += (int64_t) bytes;
+}
+
+void GLResourceRegistry::release(GLResourceType type, GLuint id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Resource &resource : m_resources)
+    {
+        if (resource.type == type && resource.id == id && resource.released_frame == 0)
+        {
+            resource.released_frame = m_frame;
+            return;
+        }
+    }
+    LOG("WARNING: Released unregistered GL " << GL_RESOURCE_TYPE_NAMES[type] << " object " << id);
+}
+
+void GLResourceRegistry::destroy(const Resource &resource)
+{
+    switch (resource.type)
+    {
+    case GL_RESOURCE_TEXTURE:     g_gl.DeleteTextures(1, &resource.id);     break;
+    case GL_RESOURCE_BUFFER:      g_gl.DeleteBuffers(1, &resource.id);      break;
+    case GL_RESOURCE_PROGRAM:     g_gl.DeleteProgram(resource.id);          break;
+    case GL_RESOURCE_SHADER:      g_gl.DeleteShader(resource.id);           break;
+    case GL_RESOURCE_FRAMEBUFFER: g_gl.DeleteFramebuffers(1, &resource.id); break;
+    default: break;
+    }
+
+    m_live_count[resource.type]--;
+    m_live_bytes[resource.type] -= (int64_t) resource.bytes;
+}
+
+void GLResourceRegistry::collect_locked(bool everything)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < m_resources.size(); i++)
+    {
+        const Resource &resource = m_resources[i];
+        bool expired = resource.released_frame != 0 &&
+                       (everything || resource.released_frame + FRAMES_IN_FLIGHT <= m_frame);
+
+        if (expired) destroy(resource);
+        else         m_resources[kept++] = resource;
+    }
+    m_resources.resize(kept);
+}
+
+void GLResourceRegistry::collect()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frame++;
+    collect_locked(false);
+}
+
+void GLResourceRegistry::collect_all()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    collect_locked(true);
+}
+
+void GLResourceRegistry::log_stats() const
+{
+    LOG("GL objects: " << get_live_count(GL_RESOURCE_TEXTURE) << " textures ("
+        << get_live_bytes(GL_RESOURCE_TEXTURE) / 1024 << " KB), " << get_live_count(GL_RESOURCE_BUFFER)
+        << " buffers (" << get_live_bytes(GL_RESOURCE_BUFFER) / 1024 << " KB), "
+        << get_live_count(GL_RESOURCE_PROGRAM) << " programs, " << get_live_count(GL_RESOURCE_SHADER) << " shaders");
+}
+
+int GLResourceRegistry::report_leaks() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Resource &resource : m_resources)
+    {
+        LOG("LEAK: GL " << GL_RESOURCE_TYPE_NAMES[resource.type] << " object " << resource.id << " ("
+            << (resource.label != nullptr ? resource.label : "unlabelled") << ", " << resource.bytes << " bytes)"
+            << (resource.released_frame != 0 ? " released but never collected" : ""));
+    }
+    return (int) m_resources.size();
+}
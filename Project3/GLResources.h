@@ -0,0 +1,120 @@
+#ifndef GL_RESOURCES_H
+#define GL_RESOURCES_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum GLResourceType
+{
+    GL_RESOURCE_TEXTURE,
+    GL_RESOURCE_BUFFER,
+    GL_RESOURCE_PROGRAM,
+    GL_RESOURCE_SHADER,
+    GL_RESOURCE_FRAMEBUFFER,
+    GL_RESOURCE_TYPE_COUNT
+};
+extern const char *const GL_RESOURCE_TYPE_NAMES[GL_RESOURCE_TYPE_COUNT];
+
+// Every GL object the game creates, with an estimate of the GPU memory behind it. Releasing
+// an object only queues it: the render thread deletes it at the end of a frame, once no
+// command list still in flight can refer to it. Whatever is still registered at shutdown is
+// reported as a leak.
+class GLResourceRegistry
+{
+private:
+    // A frame recorded before the release may still be waiting for the render thread
+    static constexpr uint64_t FRAMES_IN_FLIGHT = 2;
+
+    struct Resource
+    {
+        GLResourceType type;
+        GLuint         id;
+        size_t         bytes;
+        const char    *label;          // Must outlive the registry; string literals and asset paths do
+        uint64_t       released_frame; // Frame it was released on, or 0 while it's live
+    };
+
+    mutable std::mutex    m_mutex;
+    std::vector<Resource> m_resources;
+    uint64_t              m_frame = 1;
+
+    // Read by the overlay without the lock
+    std::atomic<int>      m_live_count[GL_RESOURCE_TYPE_COUNT];
+    std::atomic<int64_t>  m_live_bytes[GL_RESOURCE_TYPE_COUNT];
+
+    void destroy(const Resource &resource);
+    void collect_locked(bool everything);
+
+public:
+    GLResourceRegistry();
+
+    void add(GLResourceType type, GLuint id, size_t bytes, const char *label);
+    void release(GLResourceType type, GLuint id);
+
+    // GL thread only. collect() is the end-of-frame safe point; collect_all() is for shutdown,
+    // once nothing can be drawing any more.
+    void collect();
+    void collect_all();
+
+    int     const get_live_count(GLResourceType type) const { return m_live_count[type].load(std::memory_order_relaxed); }
+    int64_t const get_live_bytes(GLResourceType type) const { return m_live_bytes[type].load(std::memory_order_relaxed); }
+
+    void log_stats() const;
+
+    // Lists every object still registered; returns how many there were
+    int report_leaks() const;
+};
+
+extern GLResourceRegistry g_gl_resources;
+
+// Owns one registered GL object and releases it when destroyed. Move-only.
+template <GLResourceType TYPE>
+class GLHandle
+{
+private:
+    GLuint m_id = 0;
+
+public:
+    GLHandle() = default;
+    GLHandle(GLuint id, size_t bytes, const char *label) : m_id(id) { g_gl_resources.add(TYPE, id, bytes, label); }
+    ~GLHandle() { reset(); }
+
+    GLHandle(const GLHandle &) = delete;
+    GLHandle &operator=(const GLHandle &) = delete;
+    GLHandle(GLHandle &&other) noexcept : m_id(other.m_id) { other.m_id = 0; }
+    GLHandle &operator=(GLHandle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_id = other.m_id;
+            other.m_id = 0;
+        }
+        return *this;
+    }
+
+    void reset()
+    {
+        if (m_id != 0) g_gl_resources.release(TYPE, m_id);
+        m_id = 0;
+    }
+
+    GLuint const get_id() const { return m_id; }
+};
+
+typedef GLHandle<GL_RESOURCE_TEXTURE>     GLTexture;
+typedef GLHandle<GL_RESOURCE_BUFFER>      GLBuffer;
+typedef GLHandle<GL_RESOURCE_PROGRAM>     GLProgram;
+typedef GLHandle<GL_RESOURCE_SHADER>      GLShader;
+typedef GLHandle<GL_RESOURCE_FRAMEBUFFER> GLFramebuffer;
+
+#endif // GL_RESOURCES_H
@@ -0,0 +1,280 @@
+#include "GoldenImage.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define GOLDEN_IMAGE_SSE2 1
+#elif defined(__aarch64__)
+    #include <arm_neon.h>
+    #define GOLDEN_IMAGE_NEON 1
+#endif
+
+// ————— DIFF ————— //
+// How many pixels a 4-bit mask of them covers
+static const uint8_t BIT_COUNT[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+ImageDiff diff_images(const unsigned char *a, const unsigned char *b, size_t pixel_count, int tolerance)
+{
+    ImageDiff diff;
+    tolerance = std::min(std::max(tolerance, 0), 255);
+    size_t i = 0;
+
+#if defined(GOLDEN_IMAGE_SSE2)
+    const __m128i limit = _mm_set1_epi8((char) tolerance);
+    const __m128i zero  = _mm_setzero_si128();
+    __m128i worst = zero;
+    for (; i + 4 <= pixel_count; i += 4)
+    {
+        __m128i pixels_a   = _mm_loadu_si128((const __m128i *) (a + i * 4));
+        __m128i pixels_b   = _mm_loadu_si128((const __m128i *) (b + i * 4));
+        __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels_a, pixels_b), _mm_subs_epu8(pixels_b, pixels_a));
+        worst = _mm_max_epu8(worst, difference);
+
+        // Only channels over the tolerance survive the subtraction; a pixel is fine if none do
+        __m128i within = _mm_cmpeq_epi32(_mm_subs_epu8(difference, limit), zero);
+        diff.differing_pixels += BIT_COUNT[~_mm_movemask_ps(_mm_castsi128_ps(within)) & 0xF];
+    }
+
+    alignas(16) uint8_t lanes[16];
+    _mm_store_si128((__m128i *) lanes, worst);
+    for (uint8_t lane : lanes) diff.max_difference = std::max(diff.max_difference, (int) lane);
+#elif defined(GOLDEN_IMAGE_NEON)
+    const uint8x16_t limit = vdupq_n_u8((uint8_t) tolerance);
+    uint8x16_t worst = vdupq_n_u8(0);
+    for (; i + 4 <= pixel_count; i += 4)
+    {
+        uint8x16_t difference = vabdq_u8(vld1q_u8(a + i * 4), vld1q_u8(b + i * 4));
+        worst = vmaxq_u8(worst, difference);
+
+        uint32x4_t over = vreinterpretq_u32_u8(vqsubq_u8(difference, limit));
+        over = vtstq_u32(over, over);
+        diff.differing_pixels += vaddvq_u32(vshrq_n_u32(over, 31));
+    }
+    diff.max_difference = vmaxvq_u8(worst);
+#endif
+
+    for (; i < pixel_count; i++)
+    {
+        bool over = false;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            int difference = abs((int) a[i * 4 + channel] - (int) b[i * 4 + channel]);
+            diff.max_difference = std::max(diff.max_difference, difference);
+            if (difference > tolerance) over = true;
+        }
+        if (over) diff.differing_pixels++;
+    }
+    return diff;
+}
+
+// ————— DEFLATE ————— //
+constexpr int    HASH_BITS    = 15;
+constexpr size_t MIN_MATCH    = 3;
+constexpr size_t MAX_MATCH    = 258;
+constexpr size_t MAX_DISTANCE = 32768;
+
+static const uint16_t LENGTH_BASE[29]    = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                             67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t  LENGTH_EXTRA[29]   = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4,
+                                             5, 5, 5, 5, 0 };
+static const uint16_t DISTANCE_BASE[30]  = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                             769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t  DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+                                             11, 11, 12, 12, 13, 13 };
+
+// Deflate packs bits from the least significant end
+class BitWriter
+{
+private:
+    std::vector<unsigned char> &m_out;
+    uint64_t m_bits  = 0;
+    int      m_count = 0;
+
+public:
+    explicit BitWriter(std::vector<unsigned char> &out) : m_out(out) {}
+
+    void put(uint32_t value, int count)
+    {
+        m_bits  |= (uint64_t) value << m_count;
+        m_count += count;
+        while (m_count >= 8)
+        {
+            m_out.push_back((unsigned char) m_bits);
+            m_bits  >>= 8;
+            m_count -= 8;
+        }
+    }
+
+    // Huffman codes go in most significant bit first
+    void put_code(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int bit = 0; bit < length; bit++) reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+        put(reversed, length);
+    }
+
+    void flush()
+    {
+        if (m_count > 0) m_out.push_back((unsigned char) m_bits);
+        m_bits  = 0;
+        m_count = 0;
+    }
+};
+
+// The fixed Huffman code for a literal/length symbol
+static void put_symbol(BitWriter &writer, uint32_t symbol)
+{
+    if (symbol < 144)      writer.put_code(0x30 + symbol, 8);
+    else if (symbol < 256) writer.put_code(0x190 + symbol - 144, 9);
+    else if (symbol < 280) writer.put_code(symbol - 256, 7);
+    else                   writer.put_code(0xC0 + symbol - 280, 8);
+}
+
+static void put_match(BitWriter &writer, size_t length, size_t distance)
+{
+    int code = 28;
+    while (LENGTH_BASE[code] > length) code--;
+    put_symbol(writer, 257 + code);
+    writer.put((uint32_t) (length - LENGTH_BASE[code]), LENGTH_EXTRA[code]);
+
+    code = 29;
+    while (DISTANCE_BASE[code] > distance) code--;
+    writer.put_code(code, 5);
+    writer.put((uint32_t) (distance - DISTANCE_BASE[code]), DISTANCE_EXTRA[code]);
+}
+
+static uint32_t hash_at(const unsigned char *data)
+{
+    uint32_t value = data[0] | data[1] << 8 | data[2] << 16;
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// One fixed-code block with greedy matching against the latest position of each hash. Far
+// from zlib's ratio, but flat frames are almost all long runs, which this catches.
+static void deflate(const std::vector<unsigned char> &data, std::vector<unsigned char> &out)
+{
+    std::vector<uint32_t> head((size_t) 1 << HASH_BITS, 0);   // Last position with each hash, plus one
+    BitWriter writer(out);
+    writer.put(1, 1);   // Final block
+    writer.put(1, 2);   // Fixed codes
+
+    size_t size = data.size();
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t length = 0, distance = 0;
+        if (i + MIN_MATCH <= size)
+        {
+            uint32_t hash = hash_at(&data[i]);
+            size_t candidate = head[hash];
+            head[hash] = (uint32_t) (i + 1);
+
+            if (candidate != 0 && i - (candidate - 1) <= MAX_DISTANCE)
+            {
+                size_t from  = candidate - 1;
+                size_t limit = std::min(MAX_MATCH, size - i);
+                while (length < limit && data[from + length] == data[i + length]) length++;
+                distance = i - from;
+            }
+        }
+
+        if (length >= MIN_MATCH)
+        {
+            put_match(writer, length, distance);
+            for (size_t skipped = i + 1; skipped < i + length && skipped + MIN_MATCH <= size; skipped++)
+                head[hash_at(&data[skipped])] = (uint32_t) (skipped + 1);
+            i += length;
+        }
+        else
+        {
+            put_symbol(writer, data[i]);
+            i++;
+        }
+    }
+
+    put_symbol(writer, 256);   // End of block
+    writer.flush();
+}
+
+// ————— PNG ————— //
+static uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (table[1] == 0)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_u32(std::vector<unsigned char> &out, uint32_t value)
+{
+    out.push_back((unsigned char) (value >> 24));
+    out.push_back((unsigned char) (value >> 16));
+    out.push_back((unsigned char) (value >> 8));
+    out.push_back((unsigned char) value);
+}
+
+static void write_chunk(FILE *file, const char *type, const std::vector<unsigned char> &data)
+{
+    std::vector<unsigned char> chunk;
+    put_u32(chunk, (uint32_t) data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_u32(chunk, crc32(&chunk[4], chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+bool write_png(const char *filepath, const unsigned char *pixels, int width, int height)
+{
+    // The Sub filter turns flat colour into runs of zeros
+    size_t row_bytes = (size_t) width * 4;
+    std::vector<unsigned char> filtered;
+    filtered.reserve((row_bytes + 1) * (size_t) height);
+    for (int row = 0; row < height; row++)
+    {
+        const unsigned char *line = pixels + (size_t) row * row_bytes;
+        filtered.push_back(1);
+        for (size_t x = 0; x < row_bytes; x++) filtered.push_back((unsigned char) (line[x] - (x >= 4 ? line[x - 4] : 0)));
+    }
+
+    std::vector<unsigned char> compressed = { 0x78, 0x01 };   // zlib header: deflate, 32K window
+    deflate(filtered, compressed);
+
+    uint32_t sum_a = 1, sum_b = 0;   // Adler-32 of the uncompressed stream
+    for (unsigned char byte : filtered)
+    {
+        sum_a = (sum_a + byte) % 65521;
+        sum_b = (sum_b + sum_a) % 65521;
+    }
+    put_u32(compressed, sum_b << 16 | sum_a);
+
+    std::vector<unsigned char> header;
+    put_u32(header, (uint32_t) width);
+    put_u32(header, (uint32_t) height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });   // 8 bits per channel, RGBA, no interlace
+
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) return false;
+
+    static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(SIGNATURE, 1, sizeof(SIGNATURE), file);
+    write_chunk(file, "IHDR", header);
+    write_chunk(file, "IDAT", compressed);
+    write_chunk(file, "IEND", std::vector<unsigned char>());
+
+    bool written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
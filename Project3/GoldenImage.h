@@ -0,0 +1,21 @@
+#ifndef GOLDEN_IMAGE_H
+#define GOLDEN_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct ImageDiff
+{
+    uint64_t differing_pixels = 0;   // Pixels with any channel further apart than the tolerance
+    int      max_difference   = 0;   // Largest difference in any one channel
+};
+
+// Compares two RGBA8 images of `pixel_count` pixels, sixteen bytes at a time where the CPU
+// allows. Drivers round blending slightly differently, so a small tolerance is expected.
+ImageDiff diff_images(const unsigned char *a, const unsigned char *b, size_t pixel_count, int tolerance);
+
+// RGBA8, top row first. Compressed with a small built-in deflate, which is plenty for flat
+// game frames and saves pulling in a PNG library.
+bool write_png(const char *filepath, const unsigned char *pixels, int width, int height);
+
+#endif // GOLDEN_IMAGE_H
@@ -0,0 +1,226 @@
+#include "Gravity.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "JobSystem.h"
+
+constexpr int LEAF_CAPACITY   = 8;   // Bodies summed directly instead of splitting further
+constexpr int MAX_DEPTH       = 32;  // Stops coincident bodies from recursing forever
+constexpr int MAX_QUERY_STACK = 4 * MAX_DEPTH;
+
+static inline glm::vec2 pull_towards(glm::vec2 source, float mass, glm::vec2 point)
+{
+    glm::vec2 offset = source - point;
+    float distance_squared = glm::dot(offset, offset) + GRAVITY_SOFTENING * GRAVITY_SOFTENING;
+    return offset * (GRAVITATIONAL_CONSTANT * mass / (distance_squared * std::sqrt(distance_squared)));
+}
+
+// Reorders m_order[first, first + count) into the four quadrants around `centre`, in the order
+// bottom-left, bottom-right, top-left, top-right. quadrant_starts[4] is the end of the range.
+void BarnesHutTree::partition_quadrants(int first, int count, glm::vec2 centre, int quadrant_starts[5])
+{
+    int *begin = m_order.data() + first, *end = begin + count;
+    const glm::vec2 *positions = m_positions;
+
+    int *top    = std::partition(begin, end, [&](int body) { return positions[body].y < centre.y; });
+    int *bottom_right = std::partition(begin, top, [&](int body) { return positions[body].x < centre.x; });
+    int *top_right    = std::partition(top,   end, [&](int body) { return positions[body].x < centre.x; });
+
+    quadrant_starts[0] = first;
+    quadrant_starts[1] = first + (int) (bottom_right - begin);
+    quadrant_starts[2] = first + (int) (top - begin);
+    quadrant_starts[3] = first + (int) (top_right - begin);
+    quadrant_starts[4] = first + count;
+}
+
+int BarnesHutTree::build_node(std::vector<Node> &nodes, int first, int count, glm::vec2 min, float size, int depth)
+{
+    int index = (int) nodes.size();
+    nodes.push_back(Node());
+
+    Node node;
+    node.size       = size;
+    node.mass       = 0.0f;
+    node.first_body = first;
+    node.body_count = count;
+    glm::vec2 weighted_position(0.0f);
+
+    if (count <= LEAF_CAPACITY || depth >= MAX_DEPTH)
+    {
+        for (int q = 0; q < 4; q++) node.children[q] = -1;
+        for (int i = first; i < first + count; i++)
+        {
+            int body = m_order[i];
+            node.mass         += m_masses[body];
+            weighted_position += m_positions[body] * m_masses[body];
+        }
+    }
+    else
+    {
+        float half = size * 0.5f;
+        int starts[5];
+        partition_quadrants(first, count, min + glm::vec2(half), starts);
+
+        node.body_count = 0;
+        for (int q = 0; q < 4; q++)
+        {
+            int quadrant_count = starts[q + 1] - starts[q];
+            if (quadrant_count == 0)
+            {
+                node.children[q] = -1;
+                continue;
+            }
+
+            glm::vec2 child_min = min + glm::vec2((q & 1) ? half : 0.0f, (q & 2) ? half : 0.0f);
+            int child = build_node(nodes, starts[q], quadrant_count, child_min, half, depth + 1);
+
+            node.children[q]   = child;
+            node.mass         += nodes[child].mass;
+            weighted_position += nodes[child].centre_of_mass * nodes[child].mass;
+        }
+    }
+
+    node.centre_of_mass = node.mass > 0.0f ? weighted_position / node.mass : min + glm::vec2(size * 0.5f);
+    nodes[index] = node;
+    return index;
+}
+
+void BarnesHutTree::build(const glm::vec2 *positions, const float *masses, int count, bool parallel)
+{
+    m_positions = positions;
+    m_masses    = masses;
+    m_nodes.clear();
+    m_order.resize(count);
+    std::iota(m_order.begin(), m_order.end(), 0);
+    if (count == 0) return;
+
+    glm::vec2 min = positions[0], max = positions[0];
+    for (int i = 1; i < count; i++)
+    {
+        min = glm::min(min, positions[i]);
+        max = glm::max(max, positions[i]);
+    }
+    // Square cells, nudged so bodies on the max edge still fall inside
+    float size = std::max(max.x - min.x, max.y - min.y) * 1.001f + 1e-4f;
+
+    if (count <= LEAF_CAPACITY)
+    {
+        build_node(m_nodes, 0, count, min, size, 0);
+        return;
+    }
+
+    // Split the root ourselves so each quadrant can be built independently
+    float half = size * 0.5f;
+    int starts[5];
+    partition_quadrants(0, count, min + glm::vec2(half), starts);
+
+    auto build_quadrant = [&](int q)
+    {
+        m_subtrees[q].clear();
+        int quadrant_count = starts[q + 1] - starts[q];
+        if (quadrant_count == 0) return;
+
+        glm::vec2 child_min = min + glm::vec2((q & 1) ? half : 0.0f, (q & 2) ? half : 0.0f);
+        build_node(m_subtrees[q], starts[q], quadrant_count, child_min, half, 1);
+    };
+
+    if (parallel)
+    {
+        g_job_system.parallel_for(4, 1, [&](int begin, int end) {
+            for (int q = begin; q < end; q++) build_quadrant(q);
+        });
+    }
+    else
+    {
+        for (int q = 0; q < 4; q++) build_quadrant(q);
+    }
+
+    // Stitch the subtrees under a root, rebasing their child indices
+    Node root;
+    root.size       = size;
+    root.mass       = 0.0f;
+    root.first_body = 0;
+    root.body_count = 0;
+    glm::vec2 weighted_position(0.0f);
+    m_nodes.push_back(root);
+
+    for (int q = 0; q < 4; q++)
+    {
+        if (m_subtrees[q].empty())
+        {
+            m_nodes[0].children[q] = -1;
+            continue;
+        }
+
+        int offset = (int) m_nodes.size();
+        for (Node node : m_subtrees[q])
+        {
+            for (int &child : node.children) if (child >= 0) child += offset;
+            m_nodes.push_back(node);
+        }
+
+        const Node &child = m_nodes[offset];
+        m_nodes[0].children[q] = offset;
+        m_nodes[0].mass       += child.mass;
+        weighted_position     += child.centre_of_mass * child.mass;
+    }
+
+    m_nodes[0].centre_of_mass = m_nodes[0].mass > 0.0f ? weighted_position / m_nodes[0].mass
+                                                        : min + glm::vec2(half);
+}
+
+glm::vec2 BarnesHutTree::acceleration_at(glm::vec2 point, float opening_angle, int skip_body) const
+{
+    glm::vec2 acceleration(0.0f);
+    if (m_nodes.empty()) return acceleration;
+
+    float opening_angle_squared = opening_angle * opening_angle;
+    int stack[MAX_QUERY_STACK];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const Node &node = m_nodes[stack[--stack_size]];
+        if (node.mass <= 0.0f) continue;
+
+        bool is_leaf = node.children[0] < 0 && node.children[1] < 0 &&
+                       node.children[2] < 0 && node.children[3] < 0;
+
+        if (is_leaf)
+        {
+            for (int i = node.first_body; i < node.first_body + node.body_count; i++)
+            {
+                int body = m_order[i];
+                if (body != skip_body) acceleration += pull_towards(m_positions[body], m_masses[body], point);
+            }
+            continue;
+        }
+
+        glm::vec2 offset = node.centre_of_mass - point;
+        if (node.size * node.size < opening_angle_squared * glm::dot(offset, offset))
+        {
+            // Far enough away to treat the whole cell as one body
+            acceleration += pull_towards(node.centre_of_mass, node.mass, point);
+            continue;
+        }
+
+        for (int child : node.children)
+        {
+            if (child >= 0) stack[stack_size++] = child;
+        }
+    }
+
+    return acceleration;
+}
+
+glm::vec2 direct_acceleration(const glm::vec2 *positions, const float *masses, int count,
+                              glm::vec2 point, int skip_body)
+{
+    glm::vec2 acceleration(0.0f);
+    for (int body = 0; body < count; body++)
+    {
+        if (body != skip_body) acceleration += pull_towards(positions[body], masses[body], point);
+    }
+    return acceleration;
+}
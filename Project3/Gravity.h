@@ -0,0 +1,58 @@
+#ifndef GRAVITY_H
+#define GRAVITY_H
+
+#include <vector>
+#include "glm/glm.hpp"
+
+enum GravityMode
+{
+    GRAVITY_CONSTANT,   // Only the planet pulls the lander down
+    GRAVITY_ASTEROIDS   // Asteroids have mass too and pull on the lander and on each other
+};
+
+constexpr float GRAVITATIONAL_CONSTANT = 1.0f;   // In game units, folded into the masses
+constexpr float GRAVITY_SOFTENING      = 0.25f;  // Keeps close passes from blowing up
+constexpr float DEFAULT_OPENING_ANGLE  = 0.5f;
+
+// Quadtree over point masses for Barnes-Hut gravity. A cell whose size over distance is below
+// the opening angle θ is treated as a single mass at its centre of mass, so a query costs
+// O(log n) instead of O(n). θ = 0 degenerates to the exact direct sum.
+class BarnesHutTree
+{
+private:
+    struct Node
+    {
+        glm::vec2 centre_of_mass;
+        float     mass;
+        float     size;          // Side length of the square cell
+        int       children[4];   // -1 where the quadrant is empty
+        int       first_body;    // Leaves only: range into m_order
+        int       body_count;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<int>  m_order;   // Body indices, grouped so every leaf owns a contiguous range
+    std::vector<Node> m_subtrees[4];
+
+    const glm::vec2 *m_positions = nullptr;
+    const float     *m_masses    = nullptr;
+
+    int build_node(std::vector<Node> &nodes, int first, int count, glm::vec2 min, float size, int depth);
+    void partition_quadrants(int first, int count, glm::vec2 centre, int quadrant_starts[5]);
+
+public:
+    // Positions and masses must outlive the tree's queries. The four top-level quadrants are
+    // built as separate jobs when `parallel` is set.
+    void build(const glm::vec2 *positions, const float *masses, int count, bool parallel = true);
+
+    // Gravitational acceleration at `point`. `skip_body` excludes a body's pull on itself.
+    glm::vec2 acceleration_at(glm::vec2 point, float opening_angle, int skip_body = -1) const;
+
+    int const get_node_count() const { return (int) m_nodes.size(); }
+};
+
+// Exact O(n) sum over every body, used as the accuracy reference
+glm::vec2 direct_acceleration(const glm::vec2 *positions, const float *masses, int count,
+                              glm::vec2 point, int skip_body = -1);
+
+#endif // GRAVITY_H
@@ -0,0 +1,147 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "Histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include "BinaryFile.h"
+
+const char *const SESSION_METRIC_NAMES[METRIC_COUNT] = { "frame", "step", "render" };
+
+// File layout, all little-endian:
+//   "LLHS" | u32 version | u32 bucket count | per metric: u64 count, total, min, max, budget,
+//   over budget, then u64 buckets[bucket count]
+constexpr char     STATS_MAGIC[4] = { 'L', 'L', 'H', 'S' };
+constexpr uint32_t STATS_VERSION  = 1;
+
+// ————— HISTOGRAM ————— //
+int Histogram::bucket_index(uint64_t value)
+{
+    // Values below 2 * SUB_BUCKETS get a bucket each; above that, each doubling drops one more
+    // low bit, which keeps SUB_BUCKETS steps per power of two
+    int shift = 0;
+    while ((value >> shift) >= (uint64_t) (2 * SUB_BUCKETS) && shift < MAX_SHIFT) shift++;
+
+    uint64_t sub_bucket = std::min<uint64_t>(value >> shift, 2 * SUB_BUCKETS - 1);
+    return shift * SUB_BUCKETS + (int) sub_bucket;
+}
+
+uint64_t Histogram::bucket_upper_bound(int index)
+{
+    int shift = index < 2 * SUB_BUCKETS ? 0 : index / SUB_BUCKETS - 1;
+    uint64_t sub_bucket = (uint64_t) (index - shift * SUB_BUCKETS);
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void Histogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count       = 0;
+    m_total       = 0;
+    m_min         = 0;
+    m_max         = 0;
+    m_over_budget = 0;
+}
+
+void Histogram::record(uint64_t microseconds)
+{
+    m_buckets[bucket_index(microseconds)]++;
+
+    m_min = m_count == 0 ? microseconds : std::min(m_min, microseconds);
+    m_max = std::max(m_max, microseconds);
+    m_count++;
+    m_total += microseconds;
+    if (m_budget > 0 && microseconds > m_budget) m_over_budget++;
+}
+
+void Histogram::merge(const Histogram &other)
+{
+    if (other.m_count == 0) return;
+
+    for (int i = 0; i < BUCKET_COUNT; i++) m_buckets[i] += other.m_buckets[i];
+
+    m_min = m_count == 0 ? other.m_min : std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_count       += other.m_count;
+    m_total       += other.m_total;
+    m_over_budget += other.m_over_budget;
+}
+
+uint64_t const Histogram::value_at_percentile(double percentile) const
+{
+    if (m_count == 0) return 0;
+
+    uint64_t rank = (uint64_t) std::ceil(percentile / 100.0 * (double) m_count);
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank) return std::min(bucket_upper_bound(i), m_max);
+    }
+    return m_max;
+}
+
+void Histogram::log_summary(const char *name) const
+{
+    if (m_count == 0) return;
+
+    LOG(name << ": " << m_count << " samples, p50 " << value_at_percentile(50.0) / 1000.0
+        << " p95 " << value_at_percentile(95.0) / 1000.0 << " p99 " << value_at_percentile(99.0) / 1000.0
+        << " p99.9 " << value_at_percentile(99.9) / 1000.0 << " max " << m_max / 1000.0 << "ms, "
+        << m_over_budget << " over " << m_budget / 1000.0 << "ms");
+}
+
+// ————— SESSIONS ————— //
+bool save_session_stats(const char *filepath, const SessionStats &stats)
+{
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) return false;
+
+    fwrite(STATS_MAGIC, 1, sizeof(STATS_MAGIC), file);
+    write_u64(file, ((uint64_t) Histogram::BUCKET_COUNT << 32) | STATS_VERSION);
+
+    for (const Histogram &histogram : stats.metrics)
+    {
+        write_u64(file, histogram.m_count);
+        write_u64(file, histogram.m_total);
+        write_u64(file, histogram.m_min);
+        write_u64(file, histogram.m_max);
+        write_u64(file, histogram.m_budget);
+        write_u64(file, histogram.m_over_budget);
+        for (uint64_t bucket : histogram.m_buckets) write_u64(file, bucket);
+    }
+
+    bool success = ferror(file) == 0;
+    fclose(file);
+    return success;
+}
+
+bool load_session_stats(const char *filepath, SessionStats &stats)
+{
+    FILE *file = fopen(filepath, "rb");
+    if (file == nullptr) return false;
+
+    // A build with a different bucket layout can't be compared bucket for bucket
+    char magic[4];
+    uint64_t header;
+    bool success = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                   memcmp(magic, STATS_MAGIC, sizeof(magic)) == 0 &&
+                   read_u64(file, header) &&
+                   header == (((uint64_t) Histogram::BUCKET_COUNT << 32) | STATS_VERSION);
+
+    for (int metric = 0; success && metric < METRIC_COUNT; metric++)
+    {
+        Histogram &histogram = stats.metrics[metric];
+        success = read_u64(file, histogram.m_count) && read_u64(file, histogram.m_total) &&
+                  read_u64(file, histogram.m_min) && read_u64(file, histogram.m_max) &&
+                  read_u64(file, histogram.m_budget) && read_u64(file, histogram.m_over_budget);
+        for (int i = 0; success && i < Histogram::BUCKET_COUNT; i++) success = read_u64(file, histogram.m_buckets[i]);
+    }
+
+    fclose(file);
+    return success;
+}
@@ -0,0 +1,72 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+
+struct SessionStats;
+
+// Log-linear histogram of microsecond timings in the style of HdrHistogram: every power of two
+// is split into SUB_BUCKETS equal steps, so any value is off by at most 1/SUB_BUCKETS (under 2%)
+// from 1us to a couple of hours, in a fixed 14 KB. Recording is a shift loop and an increment.
+class Histogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr int SUB_BUCKETS     = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_SHIFT       = 26;
+    static constexpr int BUCKET_COUNT    = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+private:
+    uint64_t m_buckets[BUCKET_COUNT];
+    uint64_t m_count       = 0;
+    uint64_t m_total       = 0;
+    uint64_t m_min         = 0;
+    uint64_t m_max         = 0;
+    uint64_t m_budget      = 0;   // Samples above this are counted exactly; 0 turns it off
+    uint64_t m_over_budget = 0;
+
+    static int      bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(int index);
+
+    friend bool save_session_stats(const char *filepath, const SessionStats &stats);
+    friend bool load_session_stats(const char *filepath, SessionStats &stats);
+
+public:
+    Histogram() { reset(); }
+
+    // Keeps the budget
+    void reset();
+    void record(uint64_t microseconds);
+    void merge(const Histogram &other);
+
+    // Highest value that `percentile` percent of the samples are at or under, to bucket precision
+    uint64_t const value_at_percentile(double percentile) const;
+
+    void     const set_budget(uint64_t microseconds) { m_budget = microseconds; }
+    uint64_t const get_budget()      const { return m_budget; }
+    uint64_t const get_count()       const { return m_count; }
+    uint64_t const get_min()         const { return m_min; }
+    uint64_t const get_max()         const { return m_max; }
+    uint64_t const get_over_budget() const { return m_over_budget; }
+    double   const get_mean()        const { return m_count > 0 ? (double) m_total / (double) m_count : 0.0; }
+
+    // One line: count, p50/p95/p99/p99.9/max in milliseconds, and how many went over budget
+    void log_summary(const char *name) const;
+};
+
+// ————— SESSIONS ————— //
+enum SessionMetric { METRIC_FRAME, METRIC_STEP, METRIC_RENDER, METRIC_COUNT };
+extern const char *const SESSION_METRIC_NAMES[METRIC_COUNT];
+
+// Whole frames, fixed simulation steps (including any rollback they trigger), and recording
+// plus submitting a frame on the main thread
+struct SessionStats
+{
+    Histogram metrics[METRIC_COUNT];
+};
+
+// Raw buckets, so that two sessions can be compared at any percentile later
+bool save_session_stats(const char *filepath, const SessionStats &stats);
+bool load_session_stats(const char *filepath, SessionStats &stats);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,158 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include "Profiler.h"
+
+JobSystem g_job_system;
+
+// Which queue belongs to the current thread. Threads the system didn't start, and the main
+// thread before start(), push onto worker 0's queue and only ever steal.
+static thread_local int t_worker_index = -1;
+
+void JobSystem::start(int thread_count)
+{
+    stop();
+    if (thread_count < 1) thread_count = 1;
+
+    m_stopping = false;
+    m_queued_jobs = 0;
+    for (int i = 0; i < thread_count; i++) m_queues.emplace_back(new WorkerQueue());
+
+    t_worker_index = 0;
+    for (int i = 1; i < thread_count; i++) m_threads.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+void JobSystem::stop()
+{
+    if (m_queues.empty()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread &thread : m_threads) thread.join();
+    m_threads.clear();
+    m_queues.clear();
+    t_worker_index = -1;
+}
+
+void JobSystem::submit(Job job, JobCounter *counter)
+{
+    if (!is_running())
+    {
+        job();
+        return;
+    }
+
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    WorkerQueue &queue = *m_queues[t_worker_index >= 0 ? t_worker_index : 0];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back({ std::move(job), counter });
+    }
+    m_queued_jobs.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this against a worker that is about to go to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::pop_local(int worker, QueuedJob &out)
+{
+    if (worker < 0) return false;
+
+    WorkerQueue &queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+
+    out = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(int thief, QueuedJob &out)
+{
+    int queue_count = (int) m_queues.size();
+    int first = thief >= 0 ? thief + 1 : 0;
+
+    for (int i = 0; i < queue_count; i++)
+    {
+        int victim = (first + i) % queue_count;
+        if (victim == thief) continue;
+
+        WorkerQueue &queue = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) continue;
+
+        // Oldest first: those tend to be the biggest chunks of what's left
+        out = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::run_one(int worker)
+{
+    QueuedJob queued;
+    if (!pop_local(worker, queued) && !steal(worker, queued)) return false;
+
+    m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+    {
+        PROFILE_SCOPE("job");
+        queued.job();
+    }
+    queued.counter->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::worker_loop(int worker)
+{
+    t_worker_index = worker;
+    PROFILE_THREAD_NAME("job worker");
+
+    while (!m_stopping)
+    {
+        if (run_one(worker)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake.wait(lock, [this] { return m_queued_jobs.load(std::memory_order_acquire) > 0 || m_stopping; });
+    }
+}
+
+void JobSystem::wait(JobCounter *counter)
+{
+    while (!counter->is_done())
+    {
+        if (!run_one(t_worker_index)) std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallel_for(int count, int grain, const RangeJob &body, JobCounter *counter)
+{
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+
+    if (!is_running() || count <= grain)
+    {
+        body(0, count);
+        return;
+    }
+
+    // Ranges may still be running after we return when the caller waits on its own counter
+    std::shared_ptr<RangeJob> shared_body = std::make_shared<RangeJob>(body);
+    JobCounter local_counter;
+    JobCounter *group = counter != nullptr ? counter : &local_counter;
+
+    for (int begin = 0; begin < count; begin += grain)
+    {
+        int end = std::min(begin + grain, count);
+        submit([shared_body, begin, end] { (*shared_body)(begin, end); }, group);
+    }
+
+    if (counter == nullptr) wait(&local_counter);
+}
@@ -0,0 +1,80 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the jobs still outstanding in a group. Waiting on it is how one stage of a frame
+// depends on another.
+struct JobCounter
+{
+    std::atomic<int> pending { 0 };
+
+    bool const is_done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Work-stealing scheduler. Every thread owns a deque: it pushes and pops its own jobs at the
+// back (newest first, while they are still in cache) and idle threads steal from the front of
+// someone else's. The thread that calls start() takes part too, as worker 0, whenever it waits.
+// Until start() is called everything runs inline, so headless modes stay single-threaded.
+class JobSystem
+{
+public:
+    typedef std::function<void()> Job;
+    typedef std::function<void(int begin, int end)> RangeJob;
+
+private:
+    struct QueuedJob
+    {
+        Job         job;
+        JobCounter *counter;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex             mutex;
+        std::deque<QueuedJob>  jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex              m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::atomic<int>        m_queued_jobs { 0 };
+    std::atomic<bool>       m_stopping    { false };
+
+    bool pop_local(int worker, QueuedJob &out);
+    bool steal(int thief, QueuedJob &out);
+    bool run_one(int worker);
+    void worker_loop(int worker);
+
+public:
+    ~JobSystem() { stop(); }
+
+    // `thread_count` includes the calling thread, so 1 means no extra workers
+    void start(int thread_count);
+    void stop();
+
+    void submit(Job job, JobCounter *counter);
+
+    // Runs other jobs while waiting, so waiting from inside a job can't deadlock
+    void wait(JobCounter *counter);
+
+    // Splits [0, count) into ranges of at most `grain` and queues one job per range. Pass a
+    // counter to carry on and wait later; without one this returns once every range is done.
+    void parallel_for(int count, int grain, const RangeJob &body, JobCounter *counter = nullptr);
+
+    int  const get_thread_count() const { return m_queues.empty() ? 1 : (int) m_queues.size(); }
+    bool const is_running()       const { return !m_threads.empty(); }
+};
+
+extern JobSystem g_job_system;
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,203 @@
+#include "LevelGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+// ————— RANDOM ————— //
+static uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+void Random::reseed(uint64_t seed)
+{
+    uint64_t a = splitmix64(seed), b = splitmix64(seed);
+    m_state[0] = (uint32_t) a;
+    m_state[1] = (uint32_t) (a >> 32);
+    m_state[2] = (uint32_t) b;
+    m_state[3] = (uint32_t) (b >> 32);
+}
+
+uint32_t Random::next_u32()
+{
+    uint32_t result = rotl(m_state[1] * 5, 7) * 9;
+    uint32_t t = m_state[1] << 9;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = rotl(m_state[3], 11);
+
+    return result;
+}
+
+// ————— POISSON-DISK SAMPLING ————— //
+// Bridson's algorithm. The background grid has cells of r/√2, so each cell holds at most one
+// sample and a neighbour check only has to look at the surrounding 5x5 cells. Every sample is
+// made active once and retired once, which keeps the whole field O(n).
+// Scratch buffers are kept between calls so that regenerating a level on restart reuses them.
+static std::vector<int> s_grid;
+static std::vector<int> s_active;
+
+// The grid cell along one axis. Clamped, because a point just inside field_max can still round
+// into the cell past the edge when the extent is a whole number of cells.
+static inline int cell_along(float coordinate, float field_min, float cell_size, int cell_count)
+{
+    int cell = (int) ((coordinate - field_min) / cell_size);
+    return std::min(std::max(cell, 0), cell_count - 1);
+}
+
+static bool const is_far_enough(const std::vector<glm::vec2> &samples, glm::vec2 candidate,
+                                const LevelParameters &parameters, float cell_size,
+                                int grid_width, int grid_height)
+{
+    int cell_x = cell_along(candidate.x, parameters.field_min.x, cell_size, grid_width);
+    int cell_y = cell_along(candidate.y, parameters.field_min.y, cell_size, grid_height);
+    float min_distance_squared = parameters.min_spacing * parameters.min_spacing;
+
+    for (int y = std::max(cell_y - 2, 0); y <= std::min(cell_y + 2, grid_height - 1); y++)
+    {
+        for (int x = std::max(cell_x - 2, 0); x <= std::min(cell_x + 2, grid_width - 1); x++)
+        {
+            int index = s_grid[y * grid_width + x];
+            if (index < 0) continue;
+
+            glm::vec2 offset = samples[index] - candidate;
+            if (glm::dot(offset, offset) < min_distance_squared) return false;
+        }
+    }
+    return true;
+}
+
+static bool const is_placeable(glm::vec2 candidate, const LevelParameters &parameters)
+{
+    if (candidate.x < parameters.field_min.x || candidate.x >= parameters.field_max.x ||
+        candidate.y < parameters.field_min.y || candidate.y >= parameters.field_max.y) return false;
+
+    glm::vec2 from_spawn = candidate - parameters.spawn_position;
+    return glm::dot(from_spawn, from_spawn) >= parameters.spawn_clearance * parameters.spawn_clearance;
+}
+
+static void place_asteroids(Random &random, const LevelParameters &parameters, std::vector<glm::vec2> &samples)
+{
+    samples.clear();
+    s_active.clear();
+
+    float cell_size = parameters.min_spacing / std::sqrt(2.0f);
+    glm::vec2 extent = parameters.field_max - parameters.field_min;
+    int grid_width  = (int) std::ceil(extent.x / cell_size);
+    int grid_height = (int) std::ceil(extent.y / cell_size);
+    s_grid.assign(grid_width * grid_height, -1);
+
+    // Each cell holds at most one sample, so this is enough for any seed and the soak test's
+    // endless restarts never allocate
+    s_active.reserve(s_grid.size());
+    samples.reserve(s_grid.size());
+
+    auto add_sample = [&](glm::vec2 sample)
+    {
+        int cell_x = cell_along(sample.x, parameters.field_min.x, cell_size, grid_width);
+        int cell_y = cell_along(sample.y, parameters.field_min.y, cell_size, grid_height);
+        s_grid[cell_y * grid_width + cell_x] = (int) samples.size();
+        s_active.push_back((int) samples.size());
+        samples.push_back(sample);
+    };
+
+    // First sample anywhere that isn't on top of the spawn point
+    for (int attempt = 0; attempt < parameters.attempts && samples.empty(); attempt++)
+    {
+        glm::vec2 candidate(random.next_range(parameters.field_min.x, parameters.field_max.x),
+                            random.next_range(parameters.field_min.y, parameters.field_max.y));
+        if (is_placeable(candidate, parameters)) add_sample(candidate);
+    }
+
+    while (!s_active.empty())
+    {
+        int active_index = random.next_int((int) s_active.size());
+        glm::vec2 origin = samples[s_active[active_index]];
+        bool found = false;
+
+        for (int attempt = 0; attempt < parameters.attempts; attempt++)
+        {
+            // Uniform over the annulus [r, 2r)
+            float angle  = random.next_float() * 6.2831853f;
+            float radius = parameters.min_spacing * std::sqrt(1.0f + 3.0f * random.next_float());
+            glm::vec2 candidate = origin + radius * glm::vec2(std::cos(angle), std::sin(angle));
+
+            if (is_placeable(candidate, parameters) &&
+                is_far_enough(samples, candidate, parameters, cell_size, grid_width, grid_height))
+            {
+                add_sample(candidate);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            s_active[active_index] = s_active.back();
+            s_active.pop_back();
+        }
+    }
+
+    // The field grows outwards from the first sample, so take a random subset rather than the
+    // first few to keep a small asteroid count spread over the whole field
+    int count = std::min((int) samples.size(), parameters.max_asteroids);
+    for (int i = 0; i < count; i++)
+    {
+        int j = i + random.next_int((int) samples.size() - i);
+        std::swap(samples[i], samples[j]);
+    }
+    samples.resize(count);
+}
+
+// ————— LANDING PAD ————— //
+static bool const is_valid_pad(int pad, const LevelParameters &parameters,
+                               const std::vector<glm::vec2> &asteroids, bool require_clear_sky)
+{
+    float pad_x = parameters.platform_start_x + pad * parameters.platform_step_x;
+    if (std::fabs(pad_x - parameters.spawn_position.x) < parameters.min_pad_distance) return false;
+    if (!require_clear_sky) return true;
+
+    for (const glm::vec2 &asteroid : asteroids)
+    {
+        if (std::fabs(asteroid.x - pad_x) < parameters.pad_clearance) return false;
+    }
+    return true;
+}
+
+static int choose_landing_pad(Random &random, const LevelParameters &parameters,
+                              const std::vector<glm::vec2> &asteroids)
+{
+    // Prefer a pad with a clear descent; relax that if the field is too dense for one
+    for (int pass = 0; pass < 2; pass++)
+    {
+        int valid_count = 0;
+        for (int pad = 0; pad < parameters.platform_count; pad++)
+            if (is_valid_pad(pad, parameters, asteroids, pass == 0)) valid_count++;
+
+        if (valid_count == 0) continue;
+
+        int pick = random.next_int(valid_count);
+        for (int pad = 0; pad < parameters.platform_count; pad++)
+        {
+            if (is_valid_pad(pad, parameters, asteroids, pass == 0) && pick-- == 0) return pad;
+        }
+    }
+    return random.next_int(parameters.platform_count);
+}
+
+void generate_level(uint64_t seed, const LevelParameters &parameters, LevelLayout &layout)
+{
+    Random random(seed);
+
+    layout.seed = seed;
+    place_asteroids(random, parameters, layout.asteroids);
+    layout.landing_pad = choose_landing_pad(random, parameters, layout.asteroids);
+}
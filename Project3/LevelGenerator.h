@@ -0,0 +1,58 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+
+// xoshiro128** seeded through splitmix64. Small, fast and, unlike std::rand, identical on
+// every platform for a given seed.
+class Random
+{
+private:
+    uint32_t m_state[4];
+
+public:
+    Random(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed);
+
+    uint32_t next_u32();
+    float    next_float()                     { return (next_u32() >> 8) * (1.0f / 16777216.0f); } // [0, 1)
+    float    next_range(float min, float max) { return min + (max - min) * next_float(); }
+    int      next_int(int bound)              { return (int) (((uint64_t) next_u32() * (uint64_t) bound) >> 32); }
+};
+
+struct LevelParameters
+{
+    // ————— ASTEROIDS ————— //
+    glm::vec2 field_min      = glm::vec2(-4.0f, -1.0f);
+    glm::vec2 field_max      = glm::vec2( 4.0f,  2.0f);
+    float     min_spacing    = 1.0f;  // No two asteroids closer than this
+    int       max_asteroids  = 5;
+    int       attempts       = 30;    // Candidates tried around each active sample
+
+    // ————— SPAWN ————— //
+    glm::vec2 spawn_position  = glm::vec2(0.0f, 2.9f);
+    float     spawn_clearance = 1.25f;
+
+    // ————— LANDING PADS ————— //
+    int   platform_count    = 20;
+    float platform_start_x  = -4.75f;
+    float platform_step_x   = 0.5f;
+    float min_pad_distance  = 1.5f;   // Horizontal distance from the spawn point
+    float pad_clearance     = 0.5f;   // No asteroid this close horizontally above the pad
+};
+
+struct LevelLayout
+{
+    uint64_t seed = 0;
+    std::vector<glm::vec2> asteroids;
+    int landing_pad = 0;
+};
+
+// Fills `layout` with a Poisson-disk asteroid field and a landing pad that satisfies the
+// placement constraints. Deterministic for a given seed and set of parameters.
+void generate_level(uint64_t seed, const LevelParameters &parameters, LevelLayout &layout);
+
+#endif // LEVEL_GENERATOR_H
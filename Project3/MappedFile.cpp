@@ -0,0 +1,85 @@
+#include "MappedFile.h"
+
+#ifdef _WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WINDOWS
+bool MappedFile::open(const char *filepath)
+{
+    close();
+
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    const void *data = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+    {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (data == nullptr)
+    {
+        if (mapping != nullptr) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file    = file;
+    m_mapping = mapping;
+    m_data    = (const unsigned char *) data;
+    m_size    = (size_t) size.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data == nullptr) return;
+
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+    m_data    = nullptr;
+    m_size    = 0;
+    m_mapping = nullptr;
+    m_file    = nullptr;
+}
+#else
+bool MappedFile::open(const char *filepath)
+{
+    close();
+
+    int file = ::open(filepath, O_RDONLY);
+    if (file < 0) return false;
+
+    // The mapping keeps the file alive, so the descriptor can go straight away
+    struct stat status;
+    void *data = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+        data = mmap(nullptr, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED) return false;
+
+    m_data = (const unsigned char *) data;
+    m_size = (size_t) status.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data == nullptr) return;
+
+    munmap((void *) m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// A whole file mapped read-only. Reads come straight from the page cache, so nothing is copied
+// until something actually touches the bytes.
+class MappedFile
+{
+private:
+    const unsigned char *m_data = nullptr;
+    size_t               m_size = 0;
+#ifdef _WINDOWS
+    void *m_file    = nullptr;   // HANDLEs, kept opaque so windows.h stays out of the header
+    void *m_mapping = nullptr;
+#endif
+
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    // False if the file is missing or empty
+    bool open(const char *filepath);
+    void close();
+
+    const unsigned char *const get_data() const { return m_data; }
+    size_t               const get_size() const { return m_size; }
+    bool                 const is_open()  const { return m_data != nullptr; }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,173 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "Offscreen.h"
+#include "GLDispatch.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+
+    #ifndef EGL_PLATFORM_SURFACELESS_MESA
+        #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+    #endif
+#endif
+
+// ————— CONTEXT ————— //
+bool OffscreenContext::create()
+{
+#if defined(__linux__)
+    // The surfaceless platform needs no display server at all; the default display is the fallback.
+    // Its configs only offer pbuffers, and the default surface type asks for windows.
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display != nullptr)
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+    {
+        const EGLint config_attributes[] = { EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+                                             EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config;
+        EGLint config_count = 0;
+        EGLContext context  = EGL_NO_CONTEXT;
+
+        if (eglBindAPI(EGL_OPENGL_API) && eglChooseConfig(display, config_attributes, &config, 1, &config_count) &&
+            config_count > 0)
+        {
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+        }
+        if (context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+        {
+            m_egl_display = display;
+            m_egl_context = context;
+            return true;
+        }
+
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+    LOG("Offscreen: no surfaceless EGL context, falling back to a hidden window");
+#endif
+
+    SDL_Init(SDL_INIT_VIDEO);
+    m_window = SDL_CreateWindow("Project 3", 0, 0, 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (m_window == nullptr) return false;
+
+    m_sdl_context = SDL_GL_CreateContext(m_window);
+    if (m_sdl_context == nullptr) return false;
+    SDL_GL_MakeCurrent(m_window, m_sdl_context);
+    return true;
+}
+
+void OffscreenContext::destroy()
+{
+#if defined(__linux__)
+    if (m_egl_context != nullptr)
+    {
+        eglMakeCurrent((EGLDisplay) m_egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext((EGLDisplay) m_egl_display, (EGLContext) m_egl_context);
+        eglTerminate((EGLDisplay) m_egl_display);
+        m_egl_context = m_egl_display = nullptr;
+    }
+#endif
+    if (m_sdl_context != nullptr) SDL_GL_DeleteContext(m_sdl_context);
+    if (m_window != nullptr)      SDL_DestroyWindow(m_window);
+    m_sdl_context = nullptr;
+    m_window      = nullptr;
+}
+
+// ————— READBACK ————— //
+bool FrameReadback::create(int width, int height)
+{
+    m_width  = width;
+    m_height = height;
+    size_t frame_bytes = (size_t) width * (size_t) height * 4;
+
+    GLuint colour;
+    g_gl.GenTextures(1, &colour);
+    g_gl.BindTexture(GL_TEXTURE_2D, colour);
+    g_gl.TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    g_gl.BindTexture(GL_TEXTURE_2D, 0);
+    m_colour = GLTexture(colour, frame_bytes, "offscreen colour");
+
+    GLuint framebuffer;
+    g_gl.GenFramebuffers(1, &framebuffer);
+    g_gl.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    g_gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour, 0);
+    m_framebuffer = GLFramebuffer(framebuffer, 0, "offscreen framebuffer");
+
+    GLenum status = g_gl.CheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG("ERROR: Offscreen framebuffer is incomplete (0x" << std::hex << status << std::dec << ")");
+        return false;
+    }
+
+    GLuint pixel_buffers[LATENCY];
+    g_gl.GenBuffers(LATENCY, pixel_buffers);
+    for (int i = 0; i < LATENCY; i++)
+    {
+        g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffers[i]);
+        g_gl.BufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) frame_bytes, nullptr, GL_STREAM_READ);
+        m_pixel_buffers[i] = GLBuffer(pixel_buffers[i], frame_bytes, "offscreen readback");
+    }
+    g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_pixels.resize(frame_bytes);
+    m_queued = m_collected = 0;
+    return true;
+}
+
+void FrameReadback::destroy()
+{
+    g_gl.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_framebuffer.reset();
+    m_colour.reset();
+    for (GLBuffer &buffer : m_pixel_buffers) buffer.reset();
+}
+
+void FrameReadback::bind()
+{
+    g_gl.BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.get_id());
+}
+
+void FrameReadback::queue(uint64_t frame)
+{
+    int slot = (int) (m_queued % LATENCY);
+
+    // With a pack buffer bound, ReadPixels only starts the copy and returns
+    g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, m_pixel_buffers[slot].get_id());
+    g_gl.ReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_frames[slot] = frame;
+    m_queued++;
+}
+
+const unsigned char *FrameReadback::collect(uint64_t &frame)
+{
+    int slot = (int) (m_collected % LATENCY);
+    frame = m_frames[slot];
+    m_collected++;
+
+    g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, m_pixel_buffers[slot].get_id());
+    const unsigned char *mapped = (const unsigned char *) g_gl.MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (mapped != nullptr)
+    {
+        // GL's rows run bottom to top
+        size_t row_bytes = (size_t) m_width * 4;
+        for (int row = 0; row < m_height; row++)
+            memcpy(&m_pixels[(size_t) row * row_bytes], mapped + (size_t) (m_height - 1 - row) * row_bytes, row_bytes);
+        g_gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    g_gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return mapped != nullptr ? m_pixels.data() : nullptr;
+}
@@ -0,0 +1,68 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "GLResources.h"
+
+// A GL context with no window. On Linux it is an EGL context with no surface at all, which
+// Mesa's llvmpipe provides on machines with no GPU or display server; elsewhere it falls back
+// to a hidden SDL window. Either way, frames are drawn into a FrameReadback.
+class OffscreenContext
+{
+private:
+    void         *m_egl_display = nullptr;   // EGLDisplay and EGLContext, opaque to keep EGL out of the header
+    void         *m_egl_context = nullptr;
+    SDL_Window   *m_window      = nullptr;
+    SDL_GLContext m_sdl_context = nullptr;
+
+public:
+    // Makes the new context current on this thread
+    bool create();
+    void destroy();
+};
+
+// Draws into a colour texture instead of a window and reads finished frames back through a
+// ring of pixel buffers, so copying one frame out overlaps drawing the next few
+class FrameReadback
+{
+private:
+    static constexpr int LATENCY = 3;   // Frames queued before the oldest has to be collected
+
+    int           m_width  = 0;
+    int           m_height = 0;
+    GLFramebuffer m_framebuffer;
+    GLTexture     m_colour;
+    GLBuffer      m_pixel_buffers[LATENCY];
+    uint64_t      m_frames[LATENCY];
+    uint64_t      m_queued    = 0;       // Totals; a frame's slot is its position mod LATENCY
+    uint64_t      m_collected = 0;
+
+    std::vector<unsigned char> m_pixels; // The last collected frame, top row first
+
+public:
+    bool create(int width, int height);
+    void destroy();
+
+    // Drawing goes to the framebuffer from here on
+    void bind();
+
+    // Starts copying out what has been drawn since the last call. The ring must not be full.
+    void queue(uint64_t frame);
+
+    // Waits for the oldest queued frame and returns its RGBA pixels, top row first. Valid
+    // until the next collect().
+    const unsigned char *collect(uint64_t &frame);
+
+    bool const is_full()     const { return m_queued - m_collected == LATENCY; }
+    bool const has_pending() const { return m_queued > m_collected; }
+    int  const get_width()   const { return m_width; }
+    int  const get_height()  const { return m_height; }
+};
+
+#endif // OFFSCREEN_H
@@ -0,0 +1,164 @@
+#define GL_SILENCE_DEPRECATION
+#define GL_GLEXT_PROTOTYPES 1
+
+#include "PerfOverlay.h"
+#include "GLDispatch.h"
+#include "GLResources.h"
+#include <SDL.h>
+#include <cstdio>
+#include <cstring>
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+constexpr int   FONTBANK_SIZE     = 16;
+constexpr float OVERLAY_FONT_SIZE = 0.2f;
+constexpr float OVERLAY_SPACING   = -0.06f;  // The font's glyphs are narrow, so pack them closer
+constexpr float OVERLAY_LEFT      = -4.8f;
+constexpr float OVERLAY_TOP       = 3.5f;
+constexpr float SMOOTHING         = 0.1f;    // Weight of the newest frame in the averages
+
+// ————— GPU TIMER ————— //
+void GpuTimer::initialise()
+{
+    // Core since GL 3.3; older contexts need one of the timer query extensions
+    const char *extensions = gl_string(GL_EXTENSIONS);
+    const char *version    = gl_string(GL_VERSION);
+    m_supported = strstr(extensions, "timer_query") != nullptr ||
+                  version[0] > '3' || (version[0] == '3' && version[2] >= '3');
+    if (!m_supported) return;
+
+    g_gl.GenQueries(QUERY_LATENCY, m_queries);
+    for (int i = 0; i < QUERY_LATENCY; i++) m_in_flight[i] = false;
+}
+
+void GpuTimer::cleanup()
+{
+    if (m_supported) g_gl.DeleteQueries(QUERY_LATENCY, m_queries);
+    m_supported = false;
+}
+
+void GpuTimer::begin()
+{
+    m_timing = false;
+    if (!m_supported) return;
+
+    GLuint query = m_queries[m_next];
+    if (m_in_flight[m_next])
+    {
+        GLint available = 0;
+        g_gl.GetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        // The GPU is more than QUERY_LATENCY frames behind; skip timing rather than wait on it
+        if (!available) return;
+
+        GLuint64 elapsed_ns = 0;
+        g_gl.GetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+        m_last_ms = (float) ((double) elapsed_ns / 1.0e6);
+        m_in_flight[m_next] = false;
+    }
+
+    g_gl.BeginQuery(GL_TIME_ELAPSED, query);
+    m_timing = true;
+}
+
+void GpuTimer::end()
+{
+    if (!m_timing) return;
+
+    g_gl.EndQuery(GL_TIME_ELAPSED);
+    m_in_flight[m_next] = true;
+    m_next = (m_next + 1) % QUERY_LATENCY;
+}
+
+// ————— OVERLAY ————— //
+static float smooth(float average, float sample)
+{
+    return average + SMOOTHING * (sample - average);
+}
+
+void PerfOverlay::record_frame(const MainThreadTimings &main, float present_ms, float gpu_ms, RenderStats stats)
+{
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (m_last_frame != 0)
+    {
+        float frame_ms = (float) ((double) (now - m_last_frame) * 1000.0 / (double) SDL_GetPerformanceFrequency());
+        m_frame_ms = m_frame_ms == 0.0f ? frame_ms : smooth(m_frame_ms, frame_ms);
+    }
+    m_last_frame = now;
+
+    m_main.input_ms  = smooth(m_main.input_ms,  main.input_ms);
+    m_main.update_ms = smooth(m_main.update_ms, main.update_ms);
+    m_main.record_ms = smooth(m_main.record_ms, main.record_ms);
+    m_present_ms     = smooth(m_present_ms, present_ms);
+    if (gpu_ms >= 0.0f) m_gpu_ms = m_gpu_ms < 0.0f ? gpu_ms : smooth(m_gpu_ms, gpu_ms);
+    m_stats = stats;
+}
+
+void PerfOverlay::add_line(const char *text, int line)
+{
+    float y = OVERLAY_TOP - line * (OVERLAY_FONT_SIZE * 1.2f);
+    float width = 1.0f / FONTBANK_SIZE;
+    float height = 1.0f / FONTBANK_SIZE;
+    float half = 0.5f * OVERLAY_FONT_SIZE;
+
+    for (int i = 0; text[i] != '\0' && m_char_count < MAX_CHARS; i++)
+    {
+        int spritesheet_index = (unsigned char) text[i];
+        float x = OVERLAY_LEFT + (OVERLAY_FONT_SIZE + OVERLAY_SPACING) * i;
+        float u = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
+        float v = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
+
+        // Same corner order as draw_text
+        const float vertices[FLOATS_PER_CHAR] = {
+            x - half, y + half,  x - half, y - half,  x + half, y + half,
+            x + half, y - half,  x + half, y + half,  x - half, y - half,
+        };
+        const float texture_coordinates[FLOATS_PER_CHAR] = {
+            u, v,  u, v + height,  u + width, v,
+            u + width, v + height,  u + width, v,  u, v + height,
+        };
+
+        memcpy(m_vertices + m_char_count * FLOATS_PER_CHAR, vertices, sizeof(vertices));
+        memcpy(m_texture_coordinates + m_char_count * FLOATS_PER_CHAR, texture_coordinates, sizeof(texture_coordinates));
+        m_char_count++;
+    }
+}
+
+void PerfOverlay::draw(ShaderVariants *shaders, GLuint font_texture_id)
+{
+    char line[96];
+    m_char_count = 0;
+
+    snprintf(line, sizeof(line), "FPS %.1f  FRAME %.2fMS", m_frame_ms > 0.0f ? 1000.0f / m_frame_ms : 0.0f, m_frame_ms);
+    add_line(line, 0);
+    snprintf(line, sizeof(line), "CPU INPUT %.2f UPDATE %.2f RECORD %.2f", m_main.input_ms, m_main.update_ms,
+             m_main.record_ms);
+    add_line(line, 1);
+    if (m_gpu_ms >= 0.0f) snprintf(line, sizeof(line), "SUBMIT %.2fMS  GPU %.2fMS", m_present_ms, m_gpu_ms);
+    else                  snprintf(line, sizeof(line), "SUBMIT %.2fMS  GPU N/A", m_present_ms);
+    add_line(line, 2);
+    snprintf(line, sizeof(line), "SPRITES %d  DRAWS %d  BINDS %d", m_stats.sprites, m_stats.draw_calls, m_stats.texture_binds);
+    add_line(line, 3);
+    snprintf(line, sizeof(line), "GL TEXTURES %d (%dKB)  BUFFERS %d (%dKB)  PROGRAMS %d",
+             g_gl_resources.get_live_count(GL_RESOURCE_TEXTURE), (int) (g_gl_resources.get_live_bytes(GL_RESOURCE_TEXTURE) / 1024),
+             g_gl_resources.get_live_count(GL_RESOURCE_BUFFER), (int) (g_gl_resources.get_live_bytes(GL_RESOURCE_BUFFER) / 1024),
+             g_gl_resources.get_live_count(GL_RESOURCE_PROGRAM));
+    add_line(line, 4);
+
+    // The text is laid out in world space already, so it only needs the camera without its view
+    shaders->set_view_matrix(glm::mat4(1.0f));
+    ShaderProgram *program = shaders->use(SHADER_BATCHED);
+
+    g_gl.VertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices);
+    g_gl.EnableVertexAttribArray(program->get_position_attribute());
+    g_gl.VertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates);
+    g_gl.EnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    g_gl.BindTexture(GL_TEXTURE_2D, font_texture_id);
+    g_gl.DrawArrays(GL_TRIANGLES, 0, m_char_count * 6);
+
+    g_gl.DisableVertexAttribArray(program->get_position_attribute());
+    g_gl.DisableVertexAttribArray(program->get_tex_coordinate_attribute());
+}
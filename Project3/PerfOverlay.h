@@ -0,0 +1,82 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#include <cstdint>
+#include "ShaderVariants.h"
+
+// Main-thread CPU time for the previous frame, handed to the render thread with each frame
+struct MainThreadTimings
+{
+    float input_ms  = 0.0f;
+    float update_ms = 0.0f;
+    float record_ms = 0.0f;
+};
+
+// What executing a command list cost in GL calls. Sprites counts sprite and text commands,
+// which batching turns into far fewer draw calls.
+struct RenderStats
+{
+    int sprites       = 0;
+    int draw_calls    = 0;
+    int texture_binds = 0;
+};
+
+// GPU time of a span of commands from GL_TIME_ELAPSED queries. Results are collected
+// QUERY_LATENCY frames later, once the GPU has long finished, so reading them never stalls.
+class GpuTimer
+{
+private:
+    static constexpr int QUERY_LATENCY = 4;
+
+    GLuint m_queries[QUERY_LATENCY];
+    bool   m_in_flight[QUERY_LATENCY];
+    int    m_next      = 0;
+    bool   m_supported = false;
+    bool   m_timing    = false;   // Whether the current frame got a query
+    float  m_last_ms   = -1.0f;
+
+public:
+    // GL thread only, with the context current
+    void initialise();
+    void cleanup();
+
+    void begin();
+    void end();
+
+    // -1 until the first result comes back, or when timer queries aren't supported
+    float const get_last_ms() const { return m_last_ms; }
+};
+
+// Debug overlay with frame, CPU and GPU timings. Drawn on the render thread after the GPU
+// timer stops, from fixed arrays sized for MAX_CHARS, so it neither allocates nor shows up in
+// the numbers it reports.
+class PerfOverlay
+{
+private:
+    static constexpr int MAX_CHARS        = 256;
+    static constexpr int FLOATS_PER_CHAR  = 12;   // Two triangles, two floats per vertex
+
+    float m_vertices[MAX_CHARS * FLOATS_PER_CHAR];
+    float m_texture_coordinates[MAX_CHARS * FLOATS_PER_CHAR];
+    int   m_char_count = 0;
+
+    // Smoothed so the digits are readable
+    MainThreadTimings m_main;
+    float    m_present_ms  = 0.0f;
+    float    m_gpu_ms      = -1.0f;
+    float    m_frame_ms    = 0.0f;
+    uint64_t m_last_frame  = 0;
+    RenderStats m_stats;
+
+    void add_line(const char *text, int line);
+
+public:
+    void record_frame(const MainThreadTimings &main, float present_ms, float gpu_ms, RenderStats stats);
+    void draw(ShaderVariants *shaders, GLuint font_texture_id);
+};
+
+#endif // PERF_OVERLAY_H
@@ -0,0 +1,213 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include "glm/glm.hpp"
+#include "Fixed.h"
+
+// ————— NUMERIC TYPE ————— //
+// Define FIXED_POINT_PHYSICS to run the motion integration in Q16.16 instead of float.
+// Float is fine for playing, but its results can shift with the compiler and its flags
+// (FMA contraction, vectorisation, x87), so replay fixtures shared between machines should
+// be recorded and checked with the fixed-point build.
+#ifdef FIXED_POINT_PHYSICS
+typedef Fixed16_16 physics_scalar;
+#else
+typedef float physics_scalar;
+#endif
+
+// ————— INTEGRATORS ————— //
+// Semi-implicit Euler is what the game originally shipped with and is only really accurate at
+// 60 Hz. The other two keep trajectories put when the simulation ticks at 15-20 Hz.
+enum Integrator
+{
+    SEMI_IMPLICIT_EULER,
+    VELOCITY_VERLET,
+    CLOSED_FORM          // Exact for the lander model: piecewise polynomial within a step
+};
+
+extern Integrator g_integrator;
+
+// Rates are per second so the model doesn't depend on the tick rate. At 60 Hz they match the
+// old per-tick constants of 0.15 and 0.05.
+constexpr float ACCELERATION_DECAY_RATE = 9.0f; // Thrust dies out at this rate once released
+constexpr float VELOCITY_DECAY_RATE     = 3.0f; // Then the lander drifts to a stop at this rate
+
+template <typename Scalar>
+inline void decay_towards_zero(Scalar &value, Scalar amount)
+{
+    const Scalar zero = Scalar(0.0f);
+
+    if (value > zero) {
+        value -= amount;
+        if (value < zero) value = zero;
+    }
+    else if (value < zero) {
+        value += amount;
+        if (value > zero) value = zero;
+    }
+}
+
+// Moves for up to `duration` under a constant deceleration of `rate` towards zero velocity
+template <typename Scalar>
+inline void slide_to_rest(Scalar &position, Scalar &velocity, Scalar rate, Scalar duration)
+{
+    const Scalar zero = Scalar(0.0f), half = Scalar(0.5f);
+    if (velocity == zero || duration <= zero) return;
+
+    Scalar signed_rate = velocity > zero ? rate : -rate;
+    Scalar time_to_rest = velocity / signed_rate;
+
+    if (time_to_rest <= duration)
+    {
+        position += half * velocity * time_to_rest;
+        velocity  = zero;
+    }
+    else
+    {
+        position += velocity * duration - half * signed_rate * duration * duration;
+        velocity -= signed_rate * duration;
+    }
+}
+
+// Horizontal axis: acceleration decays linearly once thrust stops, then friction takes over
+template <typename Scalar>
+void step_horizontal(Scalar &position, Scalar &velocity, Scalar &acceleration, Scalar dt,
+                     Integrator integrator, bool decays)
+{
+    const Scalar zero = Scalar(0.0f), half = Scalar(0.5f);
+    const Scalar acceleration_decay = Scalar(ACCELERATION_DECAY_RATE);
+    const Scalar velocity_decay     = Scalar(VELOCITY_DECAY_RATE);
+
+    if (integrator == SEMI_IMPLICIT_EULER)
+    {
+        // Decelerate acceleration towards 0
+        if (decays) decay_towards_zero(acceleration, acceleration_decay * dt);
+
+        // Decelerate velocity towards 0 only when acceleration is 0
+        if (acceleration == zero) decay_towards_zero(velocity, velocity_decay * dt);
+
+        velocity += acceleration * dt;
+        position += velocity * dt;
+        return;
+    }
+
+    if (acceleration == zero)
+    {
+        slide_to_rest(position, velocity, velocity_decay, dt);
+        return;
+    }
+
+    if (!decays)
+    {
+        position += velocity * dt + half * acceleration * dt * dt;
+        velocity += acceleration * dt;
+        return;
+    }
+
+    if (integrator == VELOCITY_VERLET)
+    {
+        Scalar next_acceleration = acceleration;
+        decay_towards_zero(next_acceleration, acceleration_decay * dt);
+
+        position    += velocity * dt + half * acceleration * dt * dt;
+        velocity    += half * (acceleration + next_acceleration) * dt;
+        acceleration = next_acceleration;
+        return;
+    }
+
+    // CLOSED_FORM: a(t) = a - kt until it reaches zero, so v is quadratic and x cubic in t
+    Scalar signed_decay  = acceleration > zero ? acceleration_decay : -acceleration_decay;
+    Scalar time_to_zero  = acceleration / signed_decay;
+    bool   reaches_zero  = time_to_zero <= dt;
+    Scalar t             = reaches_zero ? time_to_zero : dt;
+
+    position += velocity * t + half * acceleration * t * t - signed_decay * t * t * t / Scalar(6.0f);
+    velocity += acceleration * t - half * signed_decay * t * t;
+
+    if (reaches_zero)
+    {
+        acceleration = zero;
+        slide_to_rest(position, velocity, velocity_decay, dt - t);
+    }
+    else
+    {
+        acceleration -= signed_decay * t;
+    }
+}
+
+// Vertical axis: constant acceleration (gravity), which every integrator but Euler gets exactly
+template <typename Scalar>
+void step_vertical(Scalar &position, Scalar &velocity, Scalar acceleration, Scalar dt, Integrator integrator)
+{
+    if (integrator == SEMI_IMPLICIT_EULER)
+    {
+        velocity += acceleration * dt;
+        position += velocity * dt;
+        return;
+    }
+
+    position += velocity * dt + Scalar(0.5f) * acceleration * dt * dt;
+    velocity += acceleration * dt;
+}
+
+// Any other pull that holds steady over a step, such as asteroid gravity. It is independent of
+// the lander's own model, so its effect is added on top of that step.
+template <typename Scalar>
+void step_field(Scalar &position, Scalar &velocity, Scalar field, Scalar dt, Integrator integrator)
+{
+    if (integrator == SEMI_IMPLICIT_EULER)
+    {
+        // Euler moves with the updated velocity, so the field shows up in both terms
+        velocity += field * dt;
+        position += field * dt * dt;
+        return;
+    }
+
+    position += Scalar(0.5f) * field * dt * dt;
+    velocity += field * dt;
+}
+
+// One step of the lander model in `Scalar` arithmetic. Entities keep their state in glm::vec3
+// for rendering; in fixed-point mode that state round-trips exactly because every Q16.16 value
+// under 256 in magnitude is representable as a float. `decays` is false while thrust is held,
+// and `field` is any external acceleration on top of the model's own.
+template <typename Scalar>
+void integrate_motion(glm::vec3 &position, glm::vec3 &velocity, glm::vec3 &acceleration, float delta_time,
+                      Integrator integrator, bool decays, glm::vec3 field = glm::vec3(0.0f))
+{
+    const Scalar dt = Scalar(delta_time);
+
+    Scalar position_x(position.x),         position_y(position.y);
+    Scalar velocity_x(velocity.x),         velocity_y(velocity.y);
+    Scalar acceleration_x(acceleration.x), acceleration_y(acceleration.y);
+
+    step_horizontal(position_x, velocity_x, acceleration_x, dt, integrator, decays);
+    step_vertical(position_y, velocity_y, acceleration_y, dt, integrator);
+
+    if (field.x != 0.0f) step_field(position_x, velocity_x, Scalar(field.x), dt, integrator);
+    if (field.y != 0.0f) step_field(position_y, velocity_y, Scalar(field.y), dt, integrator);
+
+    // The game is 2D, z is left untouched
+    position     = glm::vec3((float) position_x,     (float) position_y,     position.z);
+    velocity     = glm::vec3((float) velocity_x,     (float) velocity_y,     velocity.z);
+    acceleration = glm::vec3((float) acceleration_x, (float) acceleration_y, acceleration.z);
+}
+
+// Bodies with no thrust or friction of their own, such as drifting asteroids, just follow the field
+template <typename Scalar>
+void integrate_free_motion(glm::vec3 &position, glm::vec3 &velocity, glm::vec3 field, float delta_time,
+                           Integrator integrator)
+{
+    const Scalar dt = Scalar(delta_time);
+
+    Scalar position_x(position.x), position_y(position.y);
+    Scalar velocity_x(velocity.x), velocity_y(velocity.y);
+
+    step_field(position_x, velocity_x, Scalar(field.x), dt, integrator);
+    step_field(position_y, velocity_y, Scalar(field.y), dt, integrator);
+
+    position = glm::vec3((float) position_x, (float) position_y, position.z);
+    velocity = glm::vec3((float) velocity_x, (float) velocity_y, velocity.z);
+}
+
+#endif // PHYSICS_H
@@ -0,0 +1,170 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr uint64_t RING_CAPACITY = 1 << 16; // Zones kept per thread; a power of two
+constexpr int      MIN_CALIBRATION_MS = 20;
+
+// Relaxed atomics compile to plain stores, and keep the exporter's reads well-defined while
+// the owning thread is still writing
+struct ProfileZone
+{
+    std::atomic<const char*> name;
+    std::atomic<uint64_t>    start;
+    std::atomic<uint64_t>    end;
+};
+
+struct ThreadRing
+{
+    ProfileZone           zones[RING_CAPACITY];
+    std::atomic<uint64_t> head { 0 };   // Zones ever written; the newest is at head - 1
+    std::atomic<const char*> name { nullptr };
+    int                   thread_index = 0;
+};
+
+// Rings are never freed, so a trace can still be written after their threads have exited
+static std::mutex               g_ring_mutex;
+static std::vector<ThreadRing*> g_rings;
+static thread_local ThreadRing* t_ring = nullptr;
+
+// The reference point that raw timestamps are calibrated against when the trace is written
+static const uint64_t g_start_ticks = profiler_now();
+static const std::chrono::steady_clock::time_point g_start_time = std::chrono::steady_clock::now();
+
+static ThreadRing *register_thread()
+{
+    t_ring = new ThreadRing();
+
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    t_ring->thread_index = (int) g_rings.size();
+    g_rings.push_back(t_ring);
+    return t_ring;
+}
+
+void profiler_record(const char *name, uint64_t start, uint64_t end)
+{
+    ThreadRing *ring = t_ring != nullptr ? t_ring : register_thread();
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ProfileZone &zone = ring->zones[head & (RING_CAPACITY - 1)];
+    zone.name.store(name,   std::memory_order_relaxed);
+    zone.start.store(start, std::memory_order_relaxed);
+    zone.end.store(end,     std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void profiler_set_thread_name(const char *name)
+{
+    ThreadRing *ring = t_ring != nullptr ? t_ring : register_thread();
+    ring->name.store(name, std::memory_order_release);
+}
+
+struct CopiedZone
+{
+    const char *name;
+    uint64_t    start, end;
+};
+
+// Copies out the zones that survived the copy intact, oldest first
+static void copy_ring(ThreadRing &ring, std::vector<CopiedZone> &out)
+{
+    out.clear();
+    uint64_t head  = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+    for (uint64_t i = first; i < head; i++)
+    {
+        const ProfileZone &zone = ring.zones[i & (RING_CAPACITY - 1)];
+        out.push_back({ zone.name.load(std::memory_order_relaxed), zone.start.load(std::memory_order_relaxed),
+                        zone.end.load(std::memory_order_relaxed) });
+    }
+
+    // The writer may have lapped the start of the copy; it can also be part way through the slot
+    // after its current head, which is the oldest one we read
+    uint64_t head_after = ring.head.load(std::memory_order_acquire);
+    uint64_t valid_from = head_after + 1 > RING_CAPACITY ? head_after + 1 - RING_CAPACITY : 0;
+    if (valid_from > first)
+    {
+        size_t torn = (size_t) std::min<uint64_t>(valid_from - first, out.size());
+        out.erase(out.begin(), out.begin() + torn);
+    }
+}
+
+static void write_json_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const char *c = text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool profiler_write_chrome_trace(const char *filepath)
+{
+    // Ticks per microsecond, measured over everything since startup
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - g_start_time < std::chrono::milliseconds(MIN_CALIBRATION_MS))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(MIN_CALIBRATION_MS));
+        now = std::chrono::steady_clock::now();
+    }
+    uint64_t ticks = profiler_now() - g_start_ticks;
+    double elapsed_us = std::chrono::duration<double, std::micro>(now - g_start_time).count();
+    double ticks_per_us = (double) ticks / elapsed_us;
+
+    FILE *file = fopen(filepath, "w");
+    if (file == nullptr) return false;
+
+    std::vector<ThreadRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(g_ring_mutex);
+        rings = g_rings;
+    }
+
+    fputs("{\"traceEvents\":[\n", file);
+    bool first_event = true;
+    std::vector<CopiedZone> zones;
+
+    for (ThreadRing *ring : rings)
+    {
+        const char *name = ring->name.load(std::memory_order_acquire);
+        if (name != nullptr)
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                    first_event ? "" : ",\n", ring->thread_index);
+            write_json_string(file, name);
+            fputs("}}", file);
+            first_event = false;
+        }
+
+        copy_ring(*ring, zones);
+        for (const CopiedZone &zone : zones)
+        {
+            double start_us    = (double) (zone.start - g_start_ticks) / ticks_per_us;
+            double duration_us = (double) (zone.end - zone.start) / ticks_per_us;
+
+            fputs(first_event ? "{\"name\":" : ",\n{\"name\":", file);
+            write_json_string(file, zone.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    ring->thread_index, start_us, duration_us);
+            first_event = false;
+        }
+    }
+
+    fputs("\n]}\n", file);
+    bool success = ferror(file) == 0;
+    fclose(file);
+    return success;
+}
+
+#endif // ENABLE_PROFILER
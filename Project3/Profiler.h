@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped CPU timing zones, written to a per-thread ring buffer and exported as Chrome trace
+// JSON (open it in chrome://tracing or Perfetto). Zones nest, so the trace shows the hierarchy.
+//
+// Define ENABLE_PROFILER to turn it on. Without it PROFILE_SCOPE expands to nothing, so the
+// zones cost nothing at all in normal builds.
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#elif defined(__APPLE__)
+    #include <mach/mach_time.h>
+#else
+    #include <chrono>
+#endif
+
+// Raw timestamps; converted to microseconds only when the trace is written
+inline uint64_t profiler_now()
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__APPLE__)
+    return mach_absolute_time();
+#else
+    return (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// `name` must outlive the profiler; string literals and __func__ do
+void profiler_record(const char *name, uint64_t start, uint64_t end);
+
+// Names the calling thread's row in the trace
+void profiler_set_thread_name(const char *name);
+
+// Safe to call while other threads are still recording; zones being overwritten during the
+// copy are dropped rather than written torn
+bool profiler_write_chrome_trace(const char *filepath);
+
+class ProfileScope
+{
+private:
+    const char *m_name;
+    uint64_t    m_start;
+
+public:
+    explicit ProfileScope(const char *name) : m_name(name), m_start(profiler_now()) {}
+    ~ProfileScope() { profiler_record(m_name, m_start, profiler_now()); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name) profiler_set_thread_name(name)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+
+#endif // ENABLE_PROFILER
+
+#endif // PROFILER_H
@@ -0,0 +1,212 @@
+#include "Qoi.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// ————— FORMAT ————— //
+// A 14-byte header (magic, big-endian width and height, channels, colour space), then ops
+// until an eight-byte end marker. Each pixel is a run of the previous one, a slot of a 64-entry
+// table of recently seen pixels, a small difference from the previous one, or spelled out.
+constexpr unsigned char QOI_MAGIC[4] = { 'q', 'o', 'i', 'f' };
+constexpr size_t  QOI_HEADER_SIZE = 14;
+constexpr size_t  QOI_END_SIZE    = 8;
+constexpr uint8_t QOI_OP_INDEX = 0x00;   // 2-bit tags
+constexpr uint8_t QOI_OP_DIFF  = 0x40;
+constexpr uint8_t QOI_OP_LUMA  = 0x80;
+constexpr uint8_t QOI_OP_RUN   = 0xC0;
+constexpr uint8_t QOI_OP_RGB   = 0xFE;   // 8-bit tags
+constexpr uint8_t QOI_OP_RGBA  = 0xFF;
+constexpr uint8_t QOI_TAG_MASK = 0xC0;
+constexpr int     QOI_MAX_RUN  = 62;
+constexpr uint32_t QOI_MAX_PIXELS = 400000000;   // The reference limit, which keeps sizes in range
+
+struct QoiPixel
+{
+    uint8_t r, g, b, a;
+};
+
+static int const slot_of(QoiPixel pixel)
+{
+    return (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) & 63;
+}
+
+static uint32_t get_u32_big_endian(const unsigned char *bytes)
+{
+    return (uint32_t) bytes[0] << 24 | (uint32_t) bytes[1] << 16 | (uint32_t) bytes[2] << 8 | bytes[3];
+}
+
+static void put_u32_big_endian(std::vector<unsigned char> &out, uint32_t value)
+{
+    out.push_back((unsigned char) (value >> 24));
+    out.push_back((unsigned char) (value >> 16));
+    out.push_back((unsigned char) (value >> 8));
+    out.push_back((unsigned char) value);
+}
+
+// ————— DECODING ————— //
+bool qoi_read_header(const unsigned char *data, size_t size, int &width, int &height)
+{
+    if (size < QOI_HEADER_SIZE + QOI_END_SIZE || memcmp(data, QOI_MAGIC, sizeof(QOI_MAGIC)) != 0) return false;
+
+    uint32_t header_width  = get_u32_big_endian(data + 4);
+    uint32_t header_height = get_u32_big_endian(data + 8);
+    if (header_width == 0 || header_height == 0 || header_height >= QOI_MAX_PIXELS / header_width) return false;
+
+    width  = (int) header_width;
+    height = (int) header_height;
+    return true;
+}
+
+bool qoi_decode(const unsigned char *data, size_t size, unsigned char *out, int width, int height)
+{
+    QoiPixel seen[64];
+    memset(seen, 0, sizeof(seen));
+    QoiPixel pixel = { 0, 0, 0, 255 };
+
+    const unsigned char *in  = data + QOI_HEADER_SIZE;
+    const unsigned char *end = data + size - QOI_END_SIZE;   // Every op is whole before the marker
+    unsigned char *write = out;
+    unsigned char *stop  = out + (size_t) width * height * 4;
+
+    while (write < stop)
+    {
+        if (in >= end) return false;
+        uint8_t op = *in++;
+
+        if (op == QOI_OP_RGB)
+        {
+            if (end - in < 3) return false;
+            pixel.r = in[0];
+            pixel.g = in[1];
+            pixel.b = in[2];
+            in += 3;
+        }
+        else if (op == QOI_OP_RGBA)
+        {
+            if (end - in < 4) return false;
+            memcpy(&pixel, in, 4);
+            in += 4;
+        }
+        else if ((op & QOI_TAG_MASK) == QOI_OP_INDEX)
+        {
+            // Straight out of the table, which already holds it, so skip re-hashing
+            pixel = seen[op];
+            memcpy(write, &pixel, 4);
+            write += 4;
+            continue;
+        }
+        else if ((op & QOI_TAG_MASK) == QOI_OP_DIFF)
+        {
+            pixel.r += ((op >> 4) & 3) - 2;
+            pixel.g += ((op >> 2) & 3) - 2;
+            pixel.b += (op & 3) - 2;
+        }
+        else if ((op & QOI_TAG_MASK) == QOI_OP_LUMA)
+        {
+            if (in >= end) return false;
+            int green_difference = (op & 0x3F) - 32;
+            uint8_t second = *in++;
+            pixel.r += green_difference - 8 + ((second >> 4) & 0x0F);
+            pixel.g += green_difference;
+            pixel.b += green_difference - 8 + (second & 0x0F);
+        }
+        else
+        {
+            // A run repeats the previous pixel, which is already in the table
+            size_t run = std::min<size_t>((size_t) (op & 0x3F) + 1, (size_t) (stop - write) / 4);
+            uint32_t value;
+            memcpy(&value, &pixel, 4);
+            for (size_t i = 0; i < run; i++, write += 4) memcpy(write, &value, 4);
+            continue;
+        }
+
+        seen[slot_of(pixel)] = pixel;
+        memcpy(write, &pixel, 4);
+        write += 4;
+    }
+    return true;
+}
+
+// ————— ENCODING ————— //
+void qoi_encode(const unsigned char *pixels, int width, int height, int channels, std::vector<unsigned char> &out)
+{
+    out.clear();
+    out.reserve(QOI_HEADER_SIZE + (size_t) width * height * 5 + QOI_END_SIZE);   // The worst case
+    out.insert(out.end(), QOI_MAGIC, QOI_MAGIC + sizeof(QOI_MAGIC));
+    put_u32_big_endian(out, (uint32_t) width);
+    put_u32_big_endian(out, (uint32_t) height);
+    out.push_back((unsigned char) channels);
+    out.push_back(0);   // sRGB with linear alpha, which is all the header can say anyway
+
+    QoiPixel seen[64];
+    memset(seen, 0, sizeof(seen));
+    QoiPixel previous = { 0, 0, 0, 255 };
+    int run = 0;
+
+    size_t pixel_count = (size_t) width * height;
+    for (size_t i = 0; i < pixel_count; i++)
+    {
+        QoiPixel pixel;
+        memcpy(&pixel, pixels + i * 4, 4);
+
+        if (memcmp(&pixel, &previous, 4) == 0)
+        {
+            run++;
+            if (run == QOI_MAX_RUN || i + 1 == pixel_count)
+            {
+                out.push_back((unsigned char) (QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+
+        if (run > 0)
+        {
+            out.push_back((unsigned char) (QOI_OP_RUN | (run - 1)));
+            run = 0;
+        }
+
+        int slot = slot_of(pixel);
+        if (memcmp(&seen[slot], &pixel, 4) == 0)
+        {
+            out.push_back((unsigned char) (QOI_OP_INDEX | slot));
+        }
+        else
+        {
+            seen[slot] = pixel;
+            if (pixel.a == previous.a)
+            {
+                int8_t red   = (int8_t) (pixel.r - previous.r);
+                int8_t green = (int8_t) (pixel.g - previous.g);
+                int8_t blue  = (int8_t) (pixel.b - previous.b);
+                int8_t red_from_green  = (int8_t) (red - green);
+                int8_t blue_from_green = (int8_t) (blue - green);
+
+                if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+                {
+                    out.push_back((unsigned char) (QOI_OP_DIFF | (red + 2) << 4 | (green + 2) << 2 | (blue + 2)));
+                }
+                else if (green >= -32 && green <= 31 && red_from_green >= -8 && red_from_green <= 7 &&
+                         blue_from_green >= -8 && blue_from_green <= 7)
+                {
+                    out.push_back((unsigned char) (QOI_OP_LUMA | (green + 32)));
+                    out.push_back((unsigned char) ((red_from_green + 8) << 4 | (blue_from_green + 8)));
+                }
+                else
+                {
+                    out.push_back(QOI_OP_RGB);
+                    out.insert(out.end(), { pixel.r, pixel.g, pixel.b });
+                }
+            }
+            else
+            {
+                out.push_back(QOI_OP_RGBA);
+                out.insert(out.end(), { pixel.r, pixel.g, pixel.b, pixel.a });
+            }
+        }
+        previous = pixel;
+    }
+
+    static const unsigned char END_MARKER[QOI_END_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    out.insert(out.end(), END_MARKER, END_MARKER + QOI_END_SIZE);
+}
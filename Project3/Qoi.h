@@ -0,0 +1,22 @@
+#ifndef QOI_H
+#define QOI_H
+
+#include <cstddef>
+#include <vector>
+
+// The "Quite OK Image" format: lossless like PNG, but a single pass of byte-sized ops with no
+// entropy coding, so it decodes several times faster. Sprite art with flat runs and a few
+// colours compresses about as well as PNG does.
+
+// Whether `data` starts with a QOI header, and the size it declares
+bool qoi_read_header(const unsigned char *data, size_t size, int &width, int &height);
+
+// Into `width * height * 4` bytes of RGBA8 at `out`, with the size from qoi_read_header().
+// False if the data ends early.
+bool qoi_decode(const unsigned char *data, size_t size, unsigned char *out, int width, int height);
+
+// From RGBA8, top row first. `channels` is only recorded in the header: 3 when every pixel is
+// opaque, else 4.
+void qoi_encode(const unsigned char *pixels, int width, int height, int channels, std::vector<unsigned char> &out);
+
+#endif // QOI_H
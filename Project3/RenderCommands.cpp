@@ -0,0 +1,260 @@
+#define GL_SILENCE_DEPRECATION
+#define GL_GLEXT_PROTOTYPES 1
+
+#include "RenderCommands.h"
+#include <cstring>
+#include "GLDispatch.h"
+#include "Profiler.h"
+#include "TextureFormat.h"
+#include "glm/gtc/type_ptr.hpp"
+
+constexpr int FONTBANK_SIZE = 16;
+constexpr int INITIAL_COMMAND_CAPACITY = 64;
+constexpr int INITIAL_TEXT_CAPACITY    = 256;
+constexpr int INITIAL_BATCH_QUADS      = 512;
+
+RenderCommandList::RenderCommandList()
+{
+    m_commands.reserve(INITIAL_COMMAND_CAPACITY);
+    m_text.reserve(INITIAL_TEXT_CAPACITY);
+    m_batch_positions.reserve(INITIAL_BATCH_QUADS * VERTICES_PER_QUAD * 3);
+    m_batch_texture_coordinates.reserve(INITIAL_BATCH_QUADS * VERTICES_PER_QUAD * 2);
+}
+
+void RenderCommandList::reset()
+{
+    m_commands.clear();
+    m_text.clear();
+    m_recorded_counter = 0;
+    m_show_overlay     = false;
+}
+
+void RenderCommandList::push_clear()
+{
+    RenderCommand command;
+    command.type    = RENDER_CLEAR;
+    command.texture = 0;
+    m_commands.push_back(command);
+}
+
+void RenderCommandList::push_view(const glm::mat4 &view_matrix)
+{
+    RenderCommand command;
+    command.type    = RENDER_VIEW;
+    command.texture = 0;
+    memcpy(command.view.view, glm::value_ptr(view_matrix), sizeof(command.view.view));
+    m_commands.push_back(command);
+}
+
+void RenderCommandList::push_sprite(GLuint texture_id, const glm::mat4 &model_matrix, glm::vec4 uv_rect)
+{
+    RenderCommand command;
+    command.type    = RENDER_SPRITE;
+    command.texture = texture_id;
+    command.sprite  = make_sprite_payload(model_matrix, uv_rect);
+    m_commands.push_back(command);
+}
+
+void RenderCommandList::push_text(GLuint font_texture_id, const char *text, float font_size, float spacing,
+                                  glm::vec3 position)
+{
+    size_t length = strlen(text);
+
+    RenderCommand command;
+    command.type              = RENDER_TEXT;
+    command.texture           = font_texture_id;
+    command.text.first_char   = (uint32_t) m_text.size();
+    command.text.char_count   = (uint32_t) length;
+    command.text.font_size    = font_size;
+    command.text.spacing      = spacing;
+    command.text.position[0]  = position.x;
+    command.text.position[1]  = position.y;
+    command.text.position[2]  = position.z;
+
+    m_text.insert(m_text.end(), text, text + length);
+    m_commands.push_back(command);
+}
+
+RenderStats RenderCommandList::execute(ShaderVariants *shaders) const
+{
+    PROFILE_SCOPE("execute commands");
+    uint32_t key = SHADER_BATCHED;
+    ShaderProgram *program = shaders->use(key);
+
+    RenderStats stats;
+    GLuint bound_texture = 0, bound_palette = 0;
+    m_batch_positions.clear();
+    m_batch_texture_coordinates.clear();
+
+    for (const RenderCommand &command : m_commands)
+    {
+        if (command.type == RENDER_SPRITE || command.type == RENDER_TEXT)
+        {
+            stats.sprites++;
+            if (command.texture != bound_texture)
+            {
+                flush_batch(program, stats);
+                g_gl.BindTexture(GL_TEXTURE_2D, command.texture);
+                bound_texture = command.texture;
+                stats.texture_binds++;
+
+                // An indexed texture brings its palette along on the palette unit
+                GLuint palette = g_texture_palettes.get_palette(command.texture);
+                if (palette != 0 && palette != bound_palette)
+                {
+                    g_gl.ActiveTexture(GL_TEXTURE0 + PALETTE_TEXTURE_UNIT);
+                    g_gl.BindTexture(GL_TEXTURE_2D, palette);
+                    g_gl.ActiveTexture(GL_TEXTURE0);
+                    bound_palette = palette;
+                    stats.texture_binds++;
+                }
+
+                uint32_t texture_key = palette != 0 ? SHADER_BATCHED | SHADER_PALETTE : SHADER_BATCHED;
+                if (texture_key != key)
+                {
+                    key     = texture_key;
+                    program = shaders->use(key);
+                }
+            }
+        }
+
+        switch (command.type)
+        {
+        case RENDER_CLEAR:
+            flush_batch(program, stats);
+            g_gl.Clear(GL_COLOR_BUFFER_BIT);
+            break;
+        case RENDER_VIEW:
+            flush_batch(program, stats);
+            shaders->set_view_matrix(glm::make_mat4(command.view.view));
+            program = shaders->use(key);
+            break;
+        case RENDER_SPRITE:
+            add_sprite(command);
+            break;
+        case RENDER_TEXT:
+            add_text(command);
+            break;
+        }
+    }
+    flush_batch(program, stats);
+
+    return stats;
+}
+
+void RenderCommandList::flush_batch(ShaderProgram *program, RenderStats &stats) const
+{
+    if (m_batch_positions.empty()) return;
+    stats.draw_calls++;
+
+    g_gl.VertexAttribPointer(program->get_position_attribute(), 3, GL_FLOAT, false, 0, m_batch_positions.data());
+    g_gl.EnableVertexAttribArray(program->get_position_attribute());
+
+    g_gl.VertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0,
+                             m_batch_texture_coordinates.data());
+    g_gl.EnableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    g_gl.DrawArrays(GL_TRIANGLES, 0, (int) (m_batch_positions.size() / 3));
+
+    g_gl.DisableVertexAttribArray(program->get_position_attribute());
+    g_gl.DisableVertexAttribArray(program->get_tex_coordinate_attribute());
+
+    m_batch_positions.clear();
+    m_batch_texture_coordinates.clear();
+}
+
+// ————— SPRITE QUADS ————— //
+SpritePayload make_sprite_payload(const glm::mat4 &model_matrix, glm::vec4 uv_rect)
+{
+    SpritePayload sprite;
+    memcpy(sprite.model,   glm::value_ptr(model_matrix), sizeof(sprite.model));
+    memcpy(sprite.uv_rect, glm::value_ptr(uv_rect),      sizeof(sprite.uv_rect));
+    return sprite;
+}
+
+void write_sprite_quad(const SpritePayload &sprite, float *positions, float *texture_coordinates)
+{
+    const float *uv = sprite.uv_rect;
+    float u_coord = uv[0], v_coord = uv[1], width = uv[2], height = uv[3];
+
+    const float tex_coords[] =
+    {
+        u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
+        u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
+    };
+
+    const float vertices[] =
+    {
+        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
+        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
+    };
+
+    // Model matrices are affine, so only the first two columns and the translation matter
+    // for a corner at z = 0
+    const float *model = sprite.model;
+    for (int i = 0; i < VERTICES_PER_QUAD; i++)
+    {
+        float x = vertices[i * 2], y = vertices[i * 2 + 1];
+        *positions++ = model[0] * x + model[4] * y + model[12];
+        *positions++ = model[1] * x + model[5] * y + model[13];
+        *positions++ = model[2] * x + model[6] * y + model[14];
+    }
+    memcpy(texture_coordinates, tex_coords, sizeof(tex_coords));
+}
+
+void RenderCommandList::add_sprite(const RenderCommand &command) const
+{
+    // Within the capacity reserved up front, growing the batch doesn't allocate
+    size_t positions = m_batch_positions.size(), texture_coordinates = m_batch_texture_coordinates.size();
+    m_batch_positions.resize(positions + VERTICES_PER_QUAD * 3);
+    m_batch_texture_coordinates.resize(texture_coordinates + VERTICES_PER_QUAD * 2);
+
+    write_sprite_quad(command.sprite, m_batch_positions.data() + positions,
+                      m_batch_texture_coordinates.data() + texture_coordinates);
+}
+
+void RenderCommandList::add_text(const RenderCommand &command) const
+{
+    PROFILE_SCOPE("draw_text");
+    const TextPayload &text = command.text;
+    float font_size = text.font_size, spacing = text.spacing;
+    float x = text.position[0], y = text.position[1], z = text.position[2];
+
+    // Scale the size of the fontbank in the UV-plane
+    // We will use this for spacing and positioning
+    float width = 1.0f / FONTBANK_SIZE;
+    float height = 1.0f / FONTBANK_SIZE;
+
+    std::vector<float> &vertices = m_batch_positions;
+    std::vector<float> &texture_coordinates = m_batch_texture_coordinates;
+
+    for (uint32_t i = 0; i < text.char_count; i++) {
+        // 1. Get their index in the spritesheet, as well as their offset (i.e. their
+        //    position relative to the whole sentence)
+        int spritesheet_index = (int) m_text[text.first_char + i];  // ascii value of character
+        float offset = (font_size + spacing) * i;
+
+        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
+        float u_coordinate = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
+        float v_coordinate = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
+
+        // 3. Inset the current pair in both vectors, moved to where the line starts
+        vertices.insert(vertices.end(), {
+            x + offset + (-0.5f * font_size), y + 0.5f * font_size,  z,
+            x + offset + (-0.5f * font_size), y + -0.5f * font_size, z,
+            x + offset + (0.5f * font_size),  y + 0.5f * font_size,  z,
+            x + offset + (0.5f * font_size),  y + -0.5f * font_size, z,
+            x + offset + (0.5f * font_size),  y + 0.5f * font_size,  z,
+            x + offset + (-0.5f * font_size), y + -0.5f * font_size, z,
+        });
+
+        texture_coordinates.insert(texture_coordinates.end(), {
+            u_coordinate, v_coordinate,
+            u_coordinate, v_coordinate + height,
+            u_coordinate + width, v_coordinate,
+            u_coordinate + width, v_coordinate + height,
+            u_coordinate + width, v_coordinate,
+            u_coordinate, v_coordinate + height,
+        });
+    }
+}
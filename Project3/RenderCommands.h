@@ -0,0 +1,105 @@
+#ifndef RENDER_COMMANDS_H
+#define RENDER_COMMANDS_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "PerfOverlay.h"
+#include "ShaderVariants.h"
+
+enum RenderCommandType : uint8_t
+{
+    RENDER_CLEAR,   // State: clear the colour buffer
+    RENDER_VIEW,    // State: new view matrix for everything after it
+    RENDER_SPRITE,  // One textured quad
+    RENDER_TEXT     // A line of text from a 16x16 font sheet
+};
+
+// Plain arrays rather than glm types so the payloads can share a union
+struct SpritePayload { float model[16]; float uv_rect[4]; };   // uv_rect is u, v, width, height
+struct ViewPayload   { float view[16]; };
+struct TextPayload   { uint32_t first_char, char_count; float font_size, spacing; float position[3]; };
+
+SpritePayload make_sprite_payload(const glm::mat4 &model_matrix, glm::vec4 uv_rect);
+
+// A sprite's quad in world space, the way execute() batches it: VERTICES_PER_QUAD positions of
+// x, y, z into `positions` and as many u, v pairs into `texture_coordinates`
+constexpr int VERTICES_PER_QUAD = 6;
+void write_sprite_quad(const SpritePayload &sprite, float *positions, float *texture_coordinates);
+
+struct RenderCommand
+{
+    RenderCommandType type;
+    GLuint            texture;
+    union
+    {
+        SpritePayload sprite;
+        ViewPayload   view;
+        TextPayload   text;
+    };
+};
+
+// The shader variants execute() draws with. Every quad arrives already in world space.
+constexpr uint32_t RENDER_SHADER_KEYS[] = { SHADER_BATCHED, SHADER_BATCHED | SHADER_PALETTE };
+
+// A frame's worth of drawing, recorded without touching GL so it can be recorded on one
+// thread and executed on whichever thread owns the context
+class RenderCommandList
+{
+private:
+    std::vector<RenderCommand> m_commands;
+    std::vector<char>          m_text;   // Characters for every text command, back to back
+
+    // The batch being built: world-space positions (x, y, z) and texture coordinates for every
+    // quad since the last state change. Cleared rather than freed, so drawing doesn't allocate.
+    mutable std::vector<float> m_batch_positions;
+    mutable std::vector<float> m_batch_texture_coordinates;
+
+    uint64_t m_recorded_counter = 0; // SDL performance counter when recording finished
+
+    // For the performance overlay, which the render thread draws after executing the list
+    MainThreadTimings m_main_timings;
+    bool              m_show_overlay = false;
+
+    void add_sprite(const RenderCommand &command) const;
+    void add_text(const RenderCommand &command) const;
+    void flush_batch(ShaderProgram *program, RenderStats &stats) const;
+
+public:
+    // Room for the usual scene up front, so a message that first shows up late in a session
+    // doesn't allocate then
+    RenderCommandList();
+
+    // Keeps the capacity, so a steady scene stops allocating after the first few frames
+    void reset();
+
+    void push_clear();
+    void push_view(const glm::mat4 &view_matrix);
+    void push_sprite(GLuint texture_id, const glm::mat4 &model_matrix, glm::vec4 uv_rect);
+    void push_text(GLuint font_texture_id, const char *text, float font_size, float spacing,
+                   glm::vec3 position);
+
+    // GL thread only. Consecutive sprites and text on one texture go out as a single draw, with
+    // their model matrices applied on the CPU, so nothing is uploaded per sprite; a texture
+    // change, clear or new view starts the next draw. Indexed textures use the palette variant.
+    RenderStats execute(ShaderVariants *shaders) const;
+
+    void set_overlay(const MainThreadTimings &timings, bool show) { m_main_timings = timings; m_show_overlay = show; }
+    const MainThreadTimings &get_main_timings() const { return m_main_timings; }
+    bool const get_show_overlay() const               { return m_show_overlay; }
+
+    // For renderers other than execute(): the commands in order, and the characters their
+    // TextPayloads index into
+    const std::vector<RenderCommand> &get_commands() const { return m_commands; }
+    const char                       *get_text()     const { return m_text.data(); }
+
+    void     const set_recorded_counter(uint64_t counter) { m_recorded_counter = counter; }
+    uint64_t const get_recorded_counter() const       { return m_recorded_counter; }
+    size_t   const get_command_count()    const       { return m_commands.size(); }
+};
+
+#endif // RENDER_COMMANDS_H
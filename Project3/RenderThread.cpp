@@ -0,0 +1,163 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "RenderThread.h"
+#include <algorithm>
+#include <iostream>
+#include "AllocationTracker.h"
+#include "GLDispatch.h"
+#include "GLResources.h"
+#include "Profiler.h"
+
+void RenderThread::start(SDL_Window *window, SDL_GLContext context, ShaderVariants *shaders,
+                         GLuint font_texture_id, bool threaded, SoftwareRenderer *software)
+{
+    m_window          = window;
+    m_context         = context;
+    m_shaders         = shaders;
+    m_font_texture_id = font_texture_id;
+    m_threaded        = threaded;
+    m_software        = software;
+    m_recording     = 0;
+    m_frame_pending = false;
+    m_stopping      = false;
+
+    if (m_threaded) m_thread = std::thread(&RenderThread::thread_loop, this);
+    else            m_gpu_timer.initialise();
+}
+
+void RenderThread::stop()
+{
+    if (!m_thread.joinable())
+    {
+        m_gpu_timer.cleanup();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+
+    if (m_software == nullptr) SDL_GL_MakeCurrent(m_window, m_context);
+}
+
+RenderCommandList &RenderThread::begin_frame()
+{
+    RenderCommandList &commands = m_lists[m_recording];
+    commands.reset();
+    return commands;
+}
+
+void RenderThread::submit_frame()
+{
+    RenderCommandList &commands = m_lists[m_recording];
+    commands.set_recorded_counter(SDL_GetPerformanceCounter());
+
+    if (!m_threaded)
+    {
+        present(commands);
+        return;
+    }
+
+    // The other list is free once the render thread has presented it
+    {
+        PROFILE_SCOPE("wait for render thread");
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t wait_start = SDL_GetPerformanceCounter();
+        m_changed.wait(lock, [this] { return !m_frame_pending; });
+        m_main_wait_total += SDL_GetPerformanceCounter() - wait_start;
+
+        m_frame_pending = true;
+        m_recording    ^= 1;
+    }
+    m_changed.notify_all();
+}
+
+void RenderThread::present(const RenderCommandList &commands)
+{
+    PROFILE_FUNCTION();
+    AllocationPhaseScope phase(ALLOCATION_PRESENT);
+
+    uint64_t present_start = SDL_GetPerformanceCounter();
+
+    RenderStats stats;
+    if (m_software != nullptr)
+    {
+        stats = m_software->render(commands);
+    }
+    else
+    {
+        m_gpu_timer.begin();
+        stats = commands.execute(m_shaders);
+        m_gpu_timer.end();
+    }
+
+    // Measured before the overlay is drawn, so it only reports the game's own cost. The overlay
+    // draws straight through GL, so the software renderer goes without it.
+    float present_ms = (float) ((double) (SDL_GetPerformanceCounter() - present_start) * 1000.0 /
+                                (double) SDL_GetPerformanceFrequency());
+    m_overlay.record_frame(commands.get_main_timings(), present_ms, m_gpu_timer.get_last_ms(), stats);
+    if (commands.get_show_overlay() && m_software == nullptr) m_overlay.draw(m_shaders, m_font_texture_id);
+
+    {
+        PROFILE_SCOPE("swap");
+        if (m_software != nullptr) m_software->present(m_window);
+        else                       SDL_GL_SwapWindow(m_window);
+    }
+
+    // End of the frame: nothing recorded before a release can still be drawing
+    g_gl_resources.collect();
+    gl_end_frame();
+
+    uint64_t latency = SDL_GetPerformanceCounter() - commands.get_recorded_counter();
+    m_frame_count++;
+    m_latency_total += latency;
+    m_latency_max    = std::max(m_latency_max, latency);
+}
+
+void RenderThread::thread_loop()
+{
+    PROFILE_THREAD_NAME("render");
+    if (m_software == nullptr) SDL_GL_MakeCurrent(m_window, m_context);
+    m_gpu_timer.initialise();
+
+    while (true)
+    {
+        int drawing;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this] { return m_frame_pending || m_stopping; });
+            if (!m_frame_pending) break;
+
+            // submit_frame() flipped m_recording after handing this one over
+            drawing = m_recording ^ 1;
+        }
+
+        present(m_lists[drawing]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_frame_pending = false;
+        }
+        m_changed.notify_all();
+    }
+
+    m_gpu_timer.cleanup();
+
+    // Hand the context back so stop() can make it current on the main thread
+    if (m_software == nullptr) SDL_GL_MakeCurrent(m_window, nullptr);
+}
+
+void RenderThread::log_stats() const
+{
+    if (m_frame_count == 0) return;
+
+    double counter_ms = 1000.0 / (double) SDL_GetPerformanceFrequency();
+    LOG("Render (" << (m_threaded ? "render thread" : "inline") << (m_software != nullptr ? ", software" : "") << "): " << m_frame_count << " frames, "
+        << "record to present " << (double) m_latency_total / m_frame_count * counter_ms << "ms mean, "
+        << (double) m_latency_max * counter_ms << "ms max, main thread waited "
+        << (double) m_main_wait_total / m_frame_count * counter_ms << "ms per frame");
+}
@@ -0,0 +1,66 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+
+#include <SDL.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "RenderCommands.h"
+#include "SoftwareRenderer.h"
+
+// Owns the GL context and draws each submitted frame on its own thread, so the main thread can
+// simulate frame N+1 while frame N is being submitted and presented. Two command lists take
+// turns: the main thread records into one while the render thread executes the other.
+// Started with `threaded` false, submit_frame() executes and presents inline instead, which is
+// the baseline the pipeline's latency is compared against.
+class RenderThread
+{
+private:
+    SDL_Window    *m_window  = nullptr;
+    SDL_GLContext  m_context = nullptr;
+    ShaderVariants *m_shaders = nullptr;
+    bool           m_threaded = false;
+    GLuint         m_font_texture_id = 0;
+    SoftwareRenderer *m_software = nullptr;
+
+    RenderCommandList m_lists[2];
+    int  m_recording = 0;
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_changed;
+    bool m_frame_pending = false;  // Handed over and not yet presented
+    bool m_stopping      = false;
+
+    // ————— LATENCY ————— //
+    // From the end of recording to the end of the swap, in performance counter ticks
+    uint64_t m_frame_count      = 0;
+    uint64_t m_latency_total    = 0;
+    uint64_t m_latency_max      = 0;
+    uint64_t m_main_wait_total  = 0;  // Time the main thread spent blocked on the render thread
+
+    // ————— OVERLAY ————— //
+    GpuTimer    m_gpu_timer;
+    PerfOverlay m_overlay;
+
+    void present(const RenderCommandList &commands);
+    void thread_loop();
+
+public:
+    // The context must not be current on the calling thread when `threaded` is set. The font
+    // is the one the performance overlay is drawn with. With `software`, frames are drawn on the
+    // CPU and shown through the window's surface; there is no context, and GL is the null backend.
+    void start(SDL_Window *window, SDL_GLContext context, ShaderVariants *shaders, GLuint font_texture_id,
+               bool threaded, SoftwareRenderer *software = nullptr);
+
+    // Waits for the last frame, stops the thread and makes the context current on the caller again
+    void stop();
+
+    // The list to record this frame into. Valid until submit_frame().
+    RenderCommandList &begin_frame();
+    void submit_frame();
+
+    void log_stats() const;
+};
+
+#endif // RENDER_THREAD_H
@@ -0,0 +1,89 @@
+#include "Replay.h"
+#include <cstdio>
+#include <cstring>
+#include "BinaryFile.h"
+#include "Gravity.h"
+#include "Physics.h"
+
+static_assert(sizeof(float) == sizeof(uint32_t), "Opening angle is stored as its raw float bits");
+
+// File layout, all little-endian:
+//   "LLRP" | u32 version | u32 physics mode | u32 tick rate | u32 integrator | u32 gravity mode |
+//   f32 opening angle | u64 seed | u64 final hash | u32 tick count | u8 buttons[]
+constexpr char     REPLAY_MAGIC[4] = { 'L', 'L', 'R', 'P' };
+constexpr uint32_t REPLAY_VERSION  = 4; // 4: fuel is hashed as a physics_scalar
+
+bool save_replay(const char *filepath, const Replay &replay)
+{
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) return false;
+
+    fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), file);
+    write_u32(file, REPLAY_VERSION);
+    write_u32(file, replay.physics_mode);
+    write_u32(file, replay.tick_rate);
+    write_u32(file, replay.integrator);
+    write_u32(file, replay.gravity_mode);
+
+    uint32_t opening_angle_bits;
+    memcpy(&opening_angle_bits, &replay.opening_angle, sizeof(opening_angle_bits));
+    write_u32(file, opening_angle_bits);
+    write_u64(file, replay.seed);
+    write_u64(file, replay.final_hash);
+    write_u32(file, (uint32_t) replay.inputs.size());
+    for (const TickInput &input : replay.inputs) fputc(input.buttons, file);
+
+    bool success = ferror(file) == 0;
+    fclose(file);
+    return success;
+}
+
+bool load_replay(const char *filepath, Replay &replay)
+{
+    FILE *file = fopen(filepath, "rb");
+    if (file == nullptr) return false;
+
+    char magic[4];
+    uint32_t version, physics_mode, opening_angle_bits, tick_count;
+    bool success = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                   memcmp(magic, REPLAY_MAGIC, sizeof(magic)) == 0 &&
+                   read_u32(file, version) && version == REPLAY_VERSION &&
+                   read_u32(file, physics_mode) &&
+                   read_u32(file, replay.tick_rate) && replay.tick_rate > 0 &&
+                   read_u32(file, replay.integrator) &&
+                   read_u32(file, replay.gravity_mode) &&
+                   read_u32(file, opening_angle_bits) &&
+                   read_u64(file, replay.seed) &&
+                   read_u64(file, replay.final_hash) &&
+                   read_u32(file, tick_count);
+
+    // Modes from a newer or corrupt file would be cast straight to their enums
+    success = success && physics_mode <= PHYSICS_FIXED && replay.integrator <= CLOSED_FORM &&
+              replay.gravity_mode <= GRAVITY_ASTEROIDS;
+
+    // One byte per tick, so a corrupt count can't ask for more memory than the file holds
+    if (success)
+    {
+        long inputs_start = ftell(file);
+        success = inputs_start >= 0 && fseek(file, 0, SEEK_END) == 0;
+        long file_end = success ? ftell(file) : -1;
+        success = success && file_end - inputs_start >= (long) tick_count &&
+                  fseek(file, inputs_start, SEEK_SET) == 0;
+    }
+
+    if (success)
+    {
+        replay.physics_mode = (PhysicsMode) physics_mode;
+        memcpy(&replay.opening_angle, &opening_angle_bits, sizeof(replay.opening_angle));
+        replay.inputs.resize(tick_count);
+        for (uint32_t i = 0; i < tick_count && success; i++)
+        {
+            int byte = fgetc(file);
+            success = byte != EOF;
+            replay.inputs[i].buttons = (uint8_t) byte;
+        }
+    }
+
+    fclose(file);
+    return success;
+}
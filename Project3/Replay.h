@@ -0,0 +1,34 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Rollback.h"
+
+enum PhysicsMode : uint32_t { PHYSICS_FLOAT = 0, PHYSICS_FIXED = 1 };
+
+#ifdef FIXED_POINT_PHYSICS
+constexpr PhysicsMode BUILD_PHYSICS_MODE = PHYSICS_FIXED;
+#else
+constexpr PhysicsMode BUILD_PHYSICS_MODE = PHYSICS_FLOAT;
+#endif
+
+// One attempt at one level: the seed it was generated from and the input of every tick.
+// Replaying the inputs from a fresh level must land on `final_hash`.
+struct Replay
+{
+    uint64_t    seed         = 0;
+    PhysicsMode physics_mode = BUILD_PHYSICS_MODE;
+    uint32_t    tick_rate    = 60;
+    uint32_t    integrator   = 0;
+    uint32_t    gravity_mode = 0;
+    float       opening_angle = 0.5f;
+    uint64_t    final_hash   = 0; // 0 when the recording ended with unconfirmed input
+    std::vector<TickInput> inputs;
+};
+
+bool save_replay(const char *filepath, const Replay &replay);
+bool load_replay(const char *filepath, Replay &replay);
+
+#endif // REPLAY_H
@@ -0,0 +1,170 @@
+#include "Rollback.h"
+#include <cstring>
+
+// ————— DELAYED INPUT ————— //
+void DelayedInputSource::push(uint32_t tick, TickInput input)
+{
+    // Only if nobody polls; the oldest input is the one that has waited longest anyway
+    if (m_pending_count == MAX_PENDING)
+    {
+        m_first_pending = (m_first_pending + 1) % MAX_PENDING;
+        m_pending_count--;
+    }
+
+    m_pending[(m_first_pending + m_pending_count) % MAX_PENDING] = { tick, input };
+    m_pending_count++;
+}
+
+bool DelayedInputSource::poll(uint32_t current_tick, uint32_t &out_tick, TickInput &out_input)
+{
+    if (m_pending_count == 0) return false;
+
+    const PendingInput &oldest = m_pending[m_first_pending];
+    if (oldest.tick + m_delay_ticks > current_tick) return false;
+
+    out_tick  = oldest.tick;
+    out_input = oldest.input;
+    m_first_pending = (m_first_pending + 1) % MAX_PENDING;
+    m_pending_count--;
+    return true;
+}
+
+// ————— DELTA ENCODING ————— //
+// A delta is a list of records: [uint16 bytes to skip][uint16 literal count][literals...],
+// where literals are `from ^ to`. Unchanged bytes cost nothing, so a tick where only the
+// player moved comes out at a few dozen bytes instead of the whole snapshot.
+constexpr size_t MAX_RUN = 0xFFFF;
+
+static void write_u16(std::vector<uint8_t> &out, size_t value)
+{
+    out.push_back((uint8_t) (value & 0xFF));
+    out.push_back((uint8_t) (value >> 8));
+}
+
+// The worst case is changed and unchanged bytes alternating, which costs a record header for
+// every other byte on top of the literals. Runs split at MAX_RUN can add one more record each.
+size_t max_delta_size(size_t size)
+{
+    size_t max_records = size / 2 + 1 + size / MAX_RUN;
+    return size + max_records * 4;
+}
+
+void encode_delta(const uint8_t *from, const uint8_t *to, size_t size, std::vector<uint8_t> &out)
+{
+    out.clear();
+
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t skip = 0;
+        while (i < size && from[i] == to[i] && skip < MAX_RUN) { i++; skip++; }
+        if (i == size) break;
+
+        size_t start = i, length = 0;
+        while (i < size && from[i] != to[i] && length < MAX_RUN) { i++; length++; }
+
+        write_u16(out, skip);
+        write_u16(out, length);
+        for (size_t j = start; j < start + length; j++) out.push_back(from[j] ^ to[j]);
+    }
+}
+
+void apply_delta(const std::vector<uint8_t> &delta, uint8_t *state, size_t size)
+{
+    size_t position = 0, cursor = 0;
+    while (cursor + 4 <= delta.size())
+    {
+        size_t skip   = delta[cursor]     | (delta[cursor + 1] << 8);
+        size_t length = delta[cursor + 2] | (delta[cursor + 3] << 8);
+        cursor   += 4;
+        position += skip;
+
+        for (size_t j = 0; j < length && position < size; j++) state[position++] ^= delta[cursor + j];
+        cursor += length;
+    }
+}
+
+// ————— ROLLBACK BUFFER ————— //
+RollbackBuffer::RollbackBuffer(int capacity, size_t state_size)
+    : m_slots(capacity), m_newest_state(state_size), m_state_size(state_size), m_capacity(capacity)
+{
+    // Reserve the worst case up front so no push allocates, however much of the state changed
+    for (int i = 0; i < capacity; i++) m_slots[i].delta_to_next.reserve(max_delta_size(state_size));
+}
+
+int const RollbackBuffer::slot_for(uint32_t tick) const
+{
+    int ticks_back = (int) (m_newest_tick - tick);
+    return (m_newest_slot - ticks_back + m_capacity) % m_capacity;
+}
+
+bool const RollbackBuffer::has_tick(uint32_t tick) const
+{
+    return m_count > 0 && tick <= m_newest_tick && tick >= get_oldest_tick();
+}
+
+void RollbackBuffer::push(uint32_t tick, const void *state, TickInput input)
+{
+    const uint8_t *bytes = (const uint8_t *) state;
+
+    if (m_count > 0 && tick != m_newest_tick + 1) reset();
+
+    if (m_count > 0)
+    {
+        // The previous newest tick gets demoted to a delta against the one we're adding
+        encode_delta(m_newest_state.data(), bytes, m_state_size, m_slots[m_newest_slot].delta_to_next);
+        m_newest_slot = (m_newest_slot + 1) % m_capacity;
+        if (m_count < m_capacity) m_count++;
+    }
+    else
+    {
+        m_newest_slot = 0;
+        m_count       = 1;
+    }
+
+    Slot &slot = m_slots[m_newest_slot];
+    slot.tick  = tick;
+    slot.input = input;
+    slot.delta_to_next.clear();
+
+    m_newest_tick = tick;
+    memcpy(m_newest_state.data(), bytes, m_state_size);
+}
+
+bool RollbackBuffer::load(uint32_t tick, void *out_state) const
+{
+    if (!has_tick(tick)) return false;
+
+    uint8_t *bytes = (uint8_t *) out_state;
+    memcpy(bytes, m_newest_state.data(), m_state_size);
+
+    // XOR deltas are their own inverse, so applying tick k's delta to tick k + 1 yields tick k
+    for (uint32_t current = m_newest_tick; current > tick; current--)
+    {
+        apply_delta(m_slots[slot_for(current - 1)].delta_to_next, bytes, m_state_size);
+    }
+    return true;
+}
+
+void RollbackBuffer::discard_after(uint32_t tick)
+{
+    if (!has_tick(tick) || tick == m_newest_tick) return;
+
+    for (uint32_t current = m_newest_tick; current > tick; current--)
+    {
+        apply_delta(m_slots[slot_for(current - 1)].delta_to_next, m_newest_state.data(), m_state_size);
+    }
+
+    int dropped = (int) (m_newest_tick - tick);
+    m_newest_slot = slot_for(tick);
+    m_newest_tick = tick;
+    m_count      -= dropped;
+    m_slots[m_newest_slot].delta_to_next.clear();
+}
+
+size_t const RollbackBuffer::get_memory_usage() const
+{
+    size_t total = m_newest_state.size();
+    for (const Slot &slot : m_slots) total += sizeof(Slot) + slot.delta_to_next.capacity();
+    return total;
+}
@@ -0,0 +1,116 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ————— INPUT ————— //
+enum InputButton : uint8_t
+{
+    INPUT_LEFT  = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_START = 1 << 2
+};
+
+// Everything the player asked for during a single fixed step
+struct TickInput
+{
+    uint8_t buttons = 0;
+
+    bool const is_down(InputButton button) const { return (buttons & button) != 0; }
+    bool operator==(const TickInput &other) const { return buttons == other.buttons; }
+    bool operator!=(const TickInput &other) const { return buttons != other.buttons; }
+};
+
+// Holds local input back for a fixed number of ticks, as if it had to travel over a
+// network first. Used to exercise prediction and rollback without a second machine.
+class DelayedInputSource
+{
+private:
+    struct PendingInput
+    {
+        uint32_t tick;
+        TickInput input;
+    };
+
+    // One input arrives per tick, so at most delay + 1 are ever waiting. A fixed ring rather
+    // than a deque, which would allocate a new block every few dozen ticks.
+    static constexpr int MAX_PENDING = 256;
+
+    PendingInput m_pending[MAX_PENDING];
+    int m_first_pending = 0;
+    int m_pending_count = 0;
+    int m_delay_ticks;
+
+public:
+    DelayedInputSource(int delay_ticks = 0) : m_delay_ticks(delay_ticks) { }
+
+    void push(uint32_t tick, TickInput input);
+
+    // Pops the oldest input that has "arrived" by current_tick. Returns false if none has.
+    bool poll(uint32_t current_tick, uint32_t &out_tick, TickInput &out_input);
+
+    void clear() { m_first_pending = 0; m_pending_count = 0; }
+
+    int  const get_delay_ticks() const { return m_delay_ticks; }
+    void const set_delay_ticks(int delay_ticks) { m_delay_ticks = delay_ticks < MAX_PENDING ? delay_ticks : MAX_PENDING - 1; }
+};
+
+// ————— SNAPSHOTS ————— //
+// Ring buffer of the last `capacity` tick snapshots. Only the newest snapshot is kept in
+// full; every older one is stored as a run-length encoded XOR delta against the tick after
+// it, so restoring tick T walks backwards from the newest state applying deltas.
+class RollbackBuffer
+{
+private:
+    struct Slot
+    {
+        uint32_t tick = 0;
+        TickInput input;
+        std::vector<uint8_t> delta_to_next; // XOR delta from this tick to tick + 1
+    };
+
+    std::vector<Slot>    m_slots;
+    std::vector<uint8_t> m_newest_state;
+    size_t   m_state_size;
+    int      m_capacity;
+    int      m_count       = 0;
+    int      m_newest_slot = 0;
+    uint32_t m_newest_tick = 0;
+
+    int const slot_for(uint32_t tick) const;
+
+public:
+    RollbackBuffer(int capacity, size_t state_size);
+
+    void reset() { m_count = 0; }
+
+    // Records the state at the *start* of `tick`, together with the input used for it
+    void push(uint32_t tick, const void *state, TickInput input);
+
+    // Rebuilds the snapshot for `tick` into out_state. Returns false if it has left the ring.
+    bool load(uint32_t tick, void *out_state) const;
+
+    // Drops every snapshot newer than `tick`, making it the newest one
+    void discard_after(uint32_t tick);
+
+    bool      const has_tick(uint32_t tick) const;
+    TickInput const get_input(uint32_t tick) const { return m_slots[slot_for(tick)].input; }
+    void      const set_input(uint32_t tick, TickInput input) { m_slots[slot_for(tick)].input = input; }
+
+    uint32_t const get_oldest_tick()  const { return m_newest_tick - (uint32_t) (m_count - 1); }
+    uint32_t const get_newest_tick()  const { return m_newest_tick; }
+    int      const get_count()        const { return m_count; }
+    int      const get_capacity()     const { return m_capacity; }
+    size_t   const get_memory_usage() const;
+};
+
+// ————— DELTA ENCODING ————— //
+// Upper bound on what encode_delta() writes for a `size`-byte state
+size_t max_delta_size(size_t size);
+
+void encode_delta(const uint8_t *from, const uint8_t *to, size_t size, std::vector<uint8_t> &out);
+void apply_delta(const std::vector<uint8_t> &delta, uint8_t *state, size_t size);
+
+#endif // ROLLBACK_H
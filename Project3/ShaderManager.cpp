@@ -0,0 +1,209 @@
+#define GL_SILENCE_DEPRECATION
+
+#include "ShaderManager.h"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include "BinaryFile.h"
+#include "GLDispatch.h"
+
+// File layout, all little-endian:
+//   "LLSC" | u32 version | u32 entry count | u32 reserved | u64 driver hash |
+//   entries of u64 source hash | u32 binary format | u32 length | u64 offset |
+//   each program's binary, back to back
+// A binary only means anything to the driver that made it, so a different vendor, renderer or
+// version string throws the whole file away.
+constexpr char     SHADER_CACHE_MAGIC[4] = { 'L', 'L', 'S', 'C' };
+constexpr uint32_t SHADER_CACHE_VERSION  = 1;
+constexpr size_t   HEADER_SIZE = 24;
+constexpr size_t   ENTRY_SIZE  = 24;
+
+// Whole names only, so an extension isn't mistaken for a longer one that starts the same
+static bool has_extension(const char *extensions, const char *name)
+{
+    size_t length = strlen(name);
+    for (const char *found = strstr(extensions, name); found != nullptr; found = strstr(found + length, name))
+    {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) return true;
+    }
+    return false;
+}
+
+void ShaderManager::add(ShaderProgram *program, std::string vertex_source, std::string fragment_source,
+                        const char *label)
+{
+    Build build;
+    build.program         = program;
+    build.vertex_source   = std::move(vertex_source);
+    build.fragment_source = std::move(fragment_source);
+    build.label           = label;
+    m_builds.push_back(std::move(build));
+}
+
+// ————— BUILDING ————— //
+void ShaderManager::start()
+{
+    const char *extensions = gl_string(GL_EXTENSIONS);
+    int major = 0, minor = 0;
+    sscanf(gl_string(GL_VERSION), "%d.%d", &major, &minor);
+
+    m_parallel = has_extension(extensions, "GL_KHR_parallel_shader_compile");
+    if (m_parallel) g_gl.MaxShaderCompilerThreadsKHR(0xFFFFFFFF);   // As many as the driver wants
+
+    // Core since 4.1. The count matters too: some drivers have the entry points and no formats.
+    m_has_binaries = major * 10 + minor >= 41 || has_extension(extensions, "GL_ARB_get_program_binary");
+    if (m_has_binaries)
+    {
+        GLint format_count = 0;
+        g_gl.GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+        m_has_binaries = format_count > 0;
+    }
+
+    m_driver_hash = FNV_OFFSET_BASIS;
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const char *value = gl_string(name);
+        m_driver_hash = hash_bytes(value, strlen(value) + 1, m_driver_hash);
+    }
+    if (m_has_binaries && m_cache_path != nullptr) open_cache();
+
+    // Every compile is issued before any link, and nothing asks for a result until finish()
+    m_cached_count = 0;
+    for (Build &build : m_builds)
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+        build.source_hash = hash_bytes(build.fragment_source.data(), build.fragment_source.size(),
+                                       hash_bytes(build.vertex_source.data(), build.vertex_source.size()));
+
+        build.from_cache = false;
+        for (const CachedBinary &cached : m_cached_binaries)
+        {
+            if (cached.source_hash != build.source_hash) continue;
+            build.from_cache = build.program->load_binary(cached.format, m_cache.get_data() + cached.offset,
+                                                          (GLsizei) cached.length, build.label);
+            break;
+        }
+        if (build.from_cache)
+        {
+            m_cached_count++;
+            m_binary_ticks += SDL_GetPerformanceCounter() - start;
+            continue;
+        }
+
+        build.program->compile(build.vertex_source, build.fragment_source, build.label, m_has_binaries);
+        m_compile_ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    Uint64 link_start = SDL_GetPerformanceCounter();
+    for (Build &build : m_builds)
+    {
+        if (!build.from_cache) build.program->link();
+    }
+    m_link_ticks += SDL_GetPerformanceCounter() - link_start;
+}
+
+bool ShaderManager::finish()
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // Programs are finished in whatever order the driver completes them. Without parallel
+    // compiles every one already counts as complete, and asking how it went is what waits.
+    std::vector<bool> finished(m_builds.size(), false);
+    size_t remaining = m_builds.size();
+    bool success = true;
+    while (remaining > 0)
+    {
+        bool progressed = false;
+        for (size_t i = 0; i < m_builds.size(); i++)
+        {
+            if (finished[i]) continue;
+
+            GLint complete = GL_TRUE;
+            if (m_parallel && !m_builds[i].from_cache)
+                g_gl.GetProgramiv(m_builds[i].program->get_program_id(), GL_COMPLETION_STATUS_KHR, &complete);
+            if (complete == GL_FALSE) continue;
+
+            success = m_builds[i].program->finish_load() && success;
+            finished[i] = true;
+            remaining--;
+            progressed  = true;
+        }
+        if (!progressed) std::this_thread::yield();
+    }
+    m_wait_ticks += SDL_GetPerformanceCounter() - start;
+
+    // A program that failed to build isn't worth keeping, and would only fail again next run
+    if (m_has_binaries && m_cache_path != nullptr && m_cached_count < (int) m_builds.size() && success)
+        write_cache();
+
+    m_cached_binaries.clear();
+    m_cache.close();
+    return success;
+}
+
+// ————— CACHE FILE ————— //
+bool ShaderManager::open_cache()
+{
+    m_cached_binaries.clear();
+    if (!m_cache.open(m_cache_path)) return false;
+
+    const unsigned char *data = m_cache.get_data();
+    size_t size = m_cache.get_size();
+    bool valid = size >= HEADER_SIZE &&
+                 memcmp(data, SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC)) == 0 &&
+                 get_u32(data + 4) == SHADER_CACHE_VERSION &&
+                 get_u64(data + 16) == m_driver_hash;
+
+    uint32_t count = valid ? get_u32(data + 8) : 0;
+    valid = valid && HEADER_SIZE + (size_t) count * ENTRY_SIZE <= size;
+
+    for (uint32_t i = 0; valid && i < count; i++)
+    {
+        const unsigned char *record = data + HEADER_SIZE + i * ENTRY_SIZE;
+        CachedBinary cached = { get_u64(record), get_u32(record + 8), get_u32(record + 12), get_u64(record + 16) };
+
+        // A truncated file must not hand the driver bytes past its end
+        valid = cached.offset <= size && cached.length <= size - cached.offset;
+        m_cached_binaries.push_back(cached);
+    }
+
+    if (!valid)
+    {
+        m_cached_binaries.clear();
+        m_cache.close();
+    }
+    return valid;
+}
+
+void ShaderManager::write_cache()
+{
+    std::vector<GLenum> formats(m_builds.size(), 0);
+    std::vector<std::vector<unsigned char>> binaries(m_builds.size());
+    for (size_t i = 0; i < m_builds.size(); i++) m_builds[i].program->get_binary(formats[i], binaries[i]);
+
+    // The old file may be mapped, and Windows won't rename over a mapped file
+    m_cached_binaries.clear();
+    m_cache.close();
+
+    FILE *file = open_replacement(m_cache_path);
+    if (file == nullptr) return;
+
+    fwrite(SHADER_CACHE_MAGIC, 1, sizeof(SHADER_CACHE_MAGIC), file);
+    write_u32(file, SHADER_CACHE_VERSION);
+    write_u32(file, (uint32_t) m_builds.size());
+    write_u32(file, 0);
+    write_u64(file, m_driver_hash);
+
+    uint64_t offset = HEADER_SIZE + m_builds.size() * ENTRY_SIZE;
+    for (size_t i = 0; i < m_builds.size(); i++)
+    {
+        write_u64(file, m_builds[i].source_hash);
+        write_u32(file, formats[i]);
+        write_u32(file, (uint32_t) binaries[i].size());
+        write_u64(file, offset);
+        offset += binaries[i].size();
+    }
+    for (const std::vector<unsigned char> &binary : binaries) fwrite(binary.data(), 1, binary.size(), file);
+
+    replace_file_atomically(file, m_cache_path);
+}
@@ -0,0 +1,77 @@
+#ifndef SHADER_MANAGER_H
+#define SHADER_MANAGER_H
+
+#include <SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "ShaderProgram.h"
+
+// Builds every shader program the game uses in one go. start() issues all the compiles and
+// links without waiting on any of them, so with KHR_parallel_shader_compile the driver works
+// on them on its own threads while the caller uploads textures, and finish() collects them.
+// Where the driver can hand back linked programs, their binaries go in a cache file keyed by
+// the driver and a hash of the sources, and later runs load those instead of compiling.
+class ShaderManager
+{
+private:
+    struct Build
+    {
+        ShaderProgram *program;
+        std::string    vertex_source;
+        std::string    fragment_source;
+        const char    *label;
+        uint64_t       source_hash = 0;
+        bool           from_cache  = false;
+    };
+
+    struct CachedBinary
+    {
+        uint64_t source_hash;
+        uint32_t format;
+        uint32_t length;
+        uint64_t offset;
+    };
+
+    std::vector<Build>        m_builds;
+    MappedFile                m_cache;
+    std::vector<CachedBinary> m_cached_binaries;
+    const char *m_cache_path    = nullptr;
+    uint64_t    m_driver_hash   = 0;
+    bool        m_has_binaries  = false;
+    bool        m_parallel      = false;
+    uint64_t    m_compile_ticks = 0;   // Issuing compiles, which a driver without parallel compiles does right there
+    uint64_t    m_link_ticks    = 0;
+    uint64_t    m_binary_ticks  = 0;   // Loading cached binaries
+    uint64_t    m_wait_ticks    = 0;   // finish() waiting on whatever the driver hadn't done yet
+    int         m_cached_count  = 0;
+
+    bool open_cache();
+    void write_cache();
+
+public:
+    // Sources ready to compile, with any includes already spliced in. `label` must outlive the
+    // program. Call before start().
+    void add(ShaderProgram *program, std::string vertex_source, std::string fragment_source, const char *label);
+
+    // Loads programs from, and saves them to, the binary cache at `filepath`. Call before start().
+    void use_cache(const char *filepath) { m_cache_path = filepath; }
+
+    // GL thread, with a current context
+    void start();
+
+    // Waits for every program started, looks up their uniforms and attributes, and rewrites the
+    // cache if any had to be compiled. False if any failed to build.
+    bool finish();
+
+    int   const get_program_count() const { return (int) m_builds.size(); }
+    int   const get_cached_count()  const { return m_cached_count; }
+    bool  const is_parallel()       const { return m_parallel; }
+    float const get_compile_ms()    const { return m_compile_ticks * 1000.0f / SDL_GetPerformanceFrequency(); }
+    float const get_link_ms()       const { return m_link_ticks    * 1000.0f / SDL_GetPerformanceFrequency(); }
+    float const get_binary_ms()     const { return m_binary_ticks  * 1000.0f / SDL_GetPerformanceFrequency(); }
+    float const get_wait_ms()       const { return m_wait_ticks    * 1000.0f / SDL_GetPerformanceFrequency(); }
+};
+
+#endif // SHADER_MANAGER_H
@@ -15,88 +15,146 @@
 
 #define GL_SILENCE_DEPRECATION
 #include "ShaderProgram.h"
+#include "GLDispatch.h"
+#include "GLResources.h"
+#include "TextureFormat.h"
 
-void ShaderProgram::load(const char *vertex_shader_file, const char *fragment_shader_file) {
-    
+const char *const SHADER_UNIFORM_NAMES[UNIFORM_COUNT] =
+{
+    "modelMatrix", "cameraMatrix", "color", "diffuse", "palette"
+};
+
+const char *const SHADER_ATTRIBUTE_NAMES[ATTRIBUTE_COUNT] = { "position", "texCoord", "instanceModel" };
+
+void ShaderProgram::compile(const std::string &vertex_source, const std::string &fragment_source, const char *label,
+                            bool retrievable)
+{
     // create the vertex shader
-    m_vertex_shader = load_shader_from_file(vertex_shader_file, GL_VERTEX_SHADER);
+    m_vertex_shader = load_shader_from_string(vertex_source, GL_VERTEX_SHADER);
     // create the fragment shader
-    m_fragment_shader = load_shader_from_file(fragment_shader_file, GL_FRAGMENT_SHADER);
+    m_fragment_shader = load_shader_from_string(fragment_source, GL_FRAGMENT_SHADER);
     
     // Create the final shader program from our vertex and fragment shaders
-    m_program_id = glCreateProgram();
-    glAttachShader(m_program_id, m_vertex_shader);
-    glAttachShader(m_program_id, m_fragment_shader);
-    glLinkProgram(m_program_id);
-    
+    m_program_id = g_gl.CreateProgram();
+    g_gl.AttachShader(m_program_id, m_vertex_shader);
+    g_gl.AttachShader(m_program_id, m_fragment_shader);
+    if (retrievable) g_gl.ProgramParameteri(m_program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    g_gl_resources.add(GL_RESOURCE_SHADER, m_vertex_shader, 0, label);
+    g_gl_resources.add(GL_RESOURCE_SHADER, m_fragment_shader, 0, label);
+    g_gl_resources.add(GL_RESOURCE_PROGRAM, m_program_id, 0, label);
+}
+
+void ShaderProgram::link()
+{
+    g_gl.LinkProgram(m_program_id);
+}
+
+bool ShaderProgram::load_binary(GLenum format, const void *binary, GLsizei length, const char *label)
+{
+    m_program_id = g_gl.CreateProgram();
+    g_gl.ProgramParameteri(m_program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    g_gl.ProgramBinary(m_program_id, format, binary, length);
+
+    // A driver update or a different GPU makes old binaries fail here rather than at draw time
+    GLint link_success;
+    g_gl.GetProgramiv(m_program_id, GL_LINK_STATUS, &link_success);
+    if (link_success == GL_FALSE)
+    {
+        g_gl.DeleteProgram(m_program_id);
+        m_program_id = 0;
+        return false;
+    }
+
+    m_vertex_shader = m_fragment_shader = 0;
+    g_gl_resources.add(GL_RESOURCE_PROGRAM, m_program_id, 0, label);
+    return true;
+}
+
+bool ShaderProgram::finish_load()
+{
+    // Shaders only report how they compiled once the link is done with them
+    bool success = true;
+    for (GLuint shader : { m_vertex_shader, m_fragment_shader })
+    {
+        if (shader == 0) continue;
+
+        GLint compile_success;
+        g_gl.GetShaderiv(shader, GL_COMPILE_STATUS, &compile_success);
+        
+        // If the shader did not compile, print the error to stdout
+        if (compile_success == GL_FALSE)
+        {
+            GLchar messages[512];
+            g_gl.GetShaderInfoLog(shader, sizeof(messages), 0, &messages[0]);
+            std::cout << messages << std::endl;
+            success = false;
+        }
+    }
+
     GLint link_success;
-    glGetProgramiv(m_program_id, GL_LINK_STATUS, &link_success);
+    g_gl.GetProgramiv(m_program_id, GL_LINK_STATUS, &link_success);
     
     if(link_success == GL_FALSE)
     {
         printf("Error linking shader program!\n");
+        success = false;
     }
     
-    m_model_matrix_uniform      = glGetUniformLocation(m_program_id, "modelMatrix");
-    m_projection_matrix_uniform = glGetUniformLocation(m_program_id, "projectionMatrix");
-    m_view_matrix_uniform       = glGetUniformLocation(m_program_id, "viewMatrix");
-    m_colour_uniform            = glGetUniformLocation(m_program_id, "color");
-    
-    m_position_attribute  = glGetAttribLocation(m_program_id, "position");
-    m_tex_coord_attribute = glGetAttribLocation(m_program_id, "texCoord");
+    // The only name lookups the program ever gets; drawing indexes these tables
+    for (int uniform = 0; uniform < UNIFORM_COUNT; uniform++)
+        m_uniforms[uniform] = g_gl.GetUniformLocation(m_program_id, SHADER_UNIFORM_NAMES[uniform]);
+    for (int attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+        m_attributes[attribute] = g_gl.GetAttribLocation(m_program_id, SHADER_ATTRIBUTE_NAMES[attribute]);
+
+    // The palette variants' second sampler reads the unit palettes are bound to. Other variants
+    // have no such uniform, and GL ignores the -1 they get for it.
+    g_gl.UseProgram(m_program_id);
+    g_gl.Uniform1i(m_uniforms[UNIFORM_PALETTE], PALETTE_TEXTURE_UNIT);
     
     set_colour(1.0f, 1.0f, 1.0f, 1.0f);
-    
+    return success;
 }
 
-void ShaderProgram::cleanup()
+bool ShaderProgram::get_binary(GLenum &format, std::vector<unsigned char> &binary) const
 {
-    glDeleteProgram(m_program_id);
-    glDeleteShader(m_vertex_shader);
-    glDeleteShader(m_fragment_shader);
+    GLint length = 0;
+    g_gl.GetProgramiv(m_program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    binary.resize((size_t) length);
+    if (length <= 0) return false;
+
+    GLsizei written = 0;
+    g_gl.GetProgramBinary(m_program_id, length, &written, &format, binary.data());
+    binary.resize((size_t) written);
+    return written > 0;
 }
 
-GLuint ShaderProgram::load_shader_from_file(const std::string &shaderFile, GLenum type)
+void ShaderProgram::cleanup()
 {
-    //Open a file stream with the file name
-    std::ifstream infile(shaderFile);
-    
-    if(infile.fail()) {
-        std::cout << "Error opening shader file:" << shaderFile << std::endl;
-    }
-    
-    //Create a string buffer and stream the file to it
-    std::stringstream buffer;
-    buffer << infile.rdbuf();
-    
-    // Load the shader from the contents of the file
-    return load_shader_from_string(buffer.str(), type);
+    // Nothing to do if the program was never compiled or loaded, or cleanup() already did
+    if (m_program_id == 0) return;
+
+    g_gl_resources.release(GL_RESOURCE_PROGRAM, m_program_id);
+    if (m_vertex_shader != 0)   g_gl_resources.release(GL_RESOURCE_SHADER, m_vertex_shader);
+    if (m_fragment_shader != 0) g_gl_resources.release(GL_RESOURCE_SHADER, m_fragment_shader);
+    m_program_id = m_vertex_shader = m_fragment_shader = 0;
 }
 
 GLuint ShaderProgram::load_shader_from_string(const std::string &shaderContents, GLenum type)
+{
+    return load_shader_from_source(shaderContents.c_str(), (GLint) shaderContents.size(), type);
+}
+
+GLuint ShaderProgram::load_shader_from_source(const char *shader_string, GLint shader_string_length, GLenum type)
 {
     // Create a shader of specified type
-    GLuint shaderID = glCreateShader(type);
-    
-    // Get the pointer to the C string from the STL string
-    const char *shader_string  = shaderContents.c_str();
-    GLint shader_string_length = (GLint) shaderContents.size();
+    GLuint shaderID = g_gl.CreateShader(type);
     
     // Set the shader source to the string and compile shader
-    glShaderSource(shaderID, 1, &shader_string, &shader_string_length);
-    glCompileShader(shaderID);
+    g_gl.ShaderSource(shaderID, 1, &shader_string, &shader_string_length);
+    g_gl.CompileShader(shaderID);
     
-    // Check if the shader compiled properly
-    GLint compile_success;
-    glGetShaderiv(shaderID, GL_COMPILE_STATUS, &compile_success);
-    
-    // If the shader did not compile, print the error to stdout
-    if (compile_success == GL_FALSE)
-    {
-        GLchar messages[512];
-        glGetShaderInfoLog(shaderID, sizeof(messages), 0, &messages[0]);
-        std::cout << messages << std::endl;
-    }
+    // Whether it compiled is asked in finish_load(), so compiles needn't wait on each other
     
     // return the shader id
     return shaderID;
@@ -104,24 +162,18 @@ GLuint ShaderProgram::load_shader_from_string(const std::string &shaderContents,
 
 void ShaderProgram::set_colour(float red, float green, float blue, float alpha)
 {
-    glUseProgram(m_program_id);
-    glUniform4f(m_colour_uniform, red, green, blue, alpha);
-}
-
-void ShaderProgram::set_view_matrix(const glm::mat4 &matrix)
-{
-    glUseProgram(m_program_id);
-    glUniformMatrix4fv(m_view_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+    g_gl.UseProgram(m_program_id);
+    g_gl.Uniform4f(m_uniforms[UNIFORM_COLOUR], red, green, blue, alpha);
 }
 
 void ShaderProgram::set_model_matrix(const glm::mat4 &matrix)
 {
-    glUseProgram(m_program_id);
-    glUniformMatrix4fv(m_model_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+    g_gl.UseProgram(m_program_id);
+    g_gl.UniformMatrix4fv(m_uniforms[UNIFORM_MODEL_MATRIX], 1, GL_FALSE, &matrix[0][0]);
 }
 
-void ShaderProgram::set_projection_matrix(const glm::mat4 &matrix)
+void ShaderProgram::set_camera_matrix(const glm::mat4 &matrix)
 {
-    glUseProgram(m_program_id);
-    glUniformMatrix4fv(m_projection_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+    g_gl.UseProgram(m_program_id);
+    g_gl.UniformMatrix4fv(m_uniforms[UNIFORM_CAMERA_MATRIX], 1, GL_FALSE, &matrix[0][0]);
 }
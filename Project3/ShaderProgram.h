@@ -18,41 +18,81 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include "glm/mat4x4.hpp"
 
+// Every uniform and attribute a sprite shader variant may declare. Each program looks all of
+// them up once when it links, and drawing only indexes the table; a variant without one gets -1.
+enum ShaderUniform
+{
+    UNIFORM_MODEL_MATRIX,
+    UNIFORM_CAMERA_MATRIX,
+    UNIFORM_COLOUR,
+    UNIFORM_DIFFUSE,
+    UNIFORM_PALETTE,
+    UNIFORM_COUNT
+};
+
+enum ShaderAttribute
+{
+    ATTRIBUTE_POSITION,
+    ATTRIBUTE_TEX_COORD,
+    ATTRIBUTE_INSTANCE_MODEL,   // A mat4, so it takes four locations from here
+    ATTRIBUTE_COUNT
+};
+
+extern const char *const SHADER_UNIFORM_NAMES[UNIFORM_COUNT];
+extern const char *const SHADER_ATTRIBUTE_NAMES[ATTRIBUTE_COUNT];
+
 class ShaderProgram
 {
 private:
-    void cleanup();
-    
     GLuint load_shader_from_string(const std::string &shader_contents, GLenum shader_type);
-    GLuint load_shader_from_file(const std::string &shader_file, GLenum shader_type);
+    GLuint load_shader_from_source(const char *source, GLint length, GLenum shader_type);
 
     GLuint m_program_id;
 
-    GLuint m_projection_matrix_uniform;
-    GLuint m_model_matrix_uniform;
-    GLuint m_view_matrix_uniform;
-    GLuint m_colour_uniform;
-
-    GLuint m_position_attribute;
-    GLuint m_tex_coord_attribute;
+    GLint m_uniforms[UNIFORM_COUNT];
+    GLint m_attributes[ATTRIBUTE_COUNT];
 
     GLuint m_vertex_shader;
     GLuint m_fragment_shader;
     
 public:
 
-    void load(const char *vertex_shader_file, const char *fragment_shader_file);
+    // Start compiling both shaders, then linking them, without asking GL how either went, so
+    // a driver that compiles on its own threads can work on several programs at once.
+    // `retrievable` asks for the linked binary to be kept for get_binary().
+    // `label` names the program in GL resource reports, so it must outlive it.
+    void compile(const std::string &vertex_source, const std::string &fragment_source, const char *label,
+                 bool retrievable);
+    void link();
+
+    // Creates the program from a binary get_binary() returned on an earlier run. False if the
+    // driver won't take it any more, which leaves nothing behind.
+    bool load_binary(GLenum format, const void *binary, GLsizei length, const char *label);
+
+    // Waits for the link if it's still going, then looks up the uniforms and attributes.
+    // False if compiling or linking failed.
+    bool finish_load();
+
+    // The linked program as the driver stores it. Empty if it has no binary formats.
+    bool get_binary(GLenum &format, std::vector<unsigned char> &binary) const;
+
+    // Hands the program and its shaders back to the GL resource registry for deletion
+    void cleanup();
 
     void set_model_matrix(const glm::mat4 &matrix);
-    void set_projection_matrix(const glm::mat4 &matrix);
-    void set_view_matrix(const glm::mat4 &matrix);
+    void set_camera_matrix(const glm::mat4 &matrix);   // Projection times view
     void set_colour(float red, float green, float blue, float alpha);
     
-    GLuint const get_program_id()               const { return m_program_id;          };
-    GLuint const get_position_attribute()       const { return m_position_attribute;  };
-    GLuint const get_tex_coordinate_attribute() const { return m_tex_coord_attribute; };
+    GLuint const get_program_id()                         const { return m_program_id;                          };
+    GLuint const get_position_attribute()                 const { return m_attributes[ATTRIBUTE_POSITION];  };
+    GLuint const get_tex_coordinate_attribute()           const { return m_attributes[ATTRIBUTE_TEX_COORD]; };
+    GLint  const get_uniform(ShaderUniform uniform)       const { return m_uniforms[uniform];               };
+    GLint  const get_attribute(ShaderAttribute attribute) const { return m_attributes[attribute];           };
+    GLuint const get_vertex_shader()                      const { return m_vertex_shader;                   };   // 0 when loaded from a binary
+    GLuint const get_fragment_shader()                    const { return m_fragment_shader;                 };
     
     void set_program_id(GLuint program_id)                         { m_program_id = program_id;                   };
 };
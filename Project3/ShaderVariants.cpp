@@ -0,0 +1,143 @@
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+
+#include "ShaderVariants.h"
+#include <iostream>
+#include "AssetFileSystem.h"
+#include "GLDispatch.h"
+
+constexpr int MAX_INCLUDE_DEPTH = 8;   // Deeper than any real nesting, so it only stops a cycle
+
+const char *const SHADER_FEATURE_NAMES[SHADER_FEATURE_COUNT] = { "UNTEXTURED", "PALETTE", "BATCHED", "INSTANCED" };
+
+// ————— PREPROCESSING ————— //
+static bool append_shader(const std::string &path, std::string &out, int depth)
+{
+    AssetFile file = g_assets.open(path.c_str());
+    if (!file.is_open())
+    {
+        LOG("Error opening shader file:" << path);
+        return false;
+    }
+
+    std::string folder = path.substr(0, path.find_last_of('/') + 1);
+    const char *text = (const char *) file.get_data(), *end = text + file.get_size();
+    bool success = true;
+    while (text < end)
+    {
+        const char *line_end = text;
+        while (line_end < end && *line_end != '\n') line_end++;
+
+        const char *directive = text;
+        while (directive < line_end && (*directive == ' ' || *directive == '\t')) directive++;
+
+        std::string line(directive, line_end);
+        size_t open = line.find('"'), close = line.rfind('"');
+        if (line.compare(0, 8, "#include") == 0 && open != std::string::npos && close > open)
+        {
+            if (depth >= MAX_INCLUDE_DEPTH)
+            {
+                LOG("Error: shader includes nest too deeply in " << path);
+                return false;
+            }
+            success = append_shader(folder + line.substr(open + 1, close - open - 1), out, depth + 1) && success;
+        }
+        else
+        {
+            out.append(text, line_end);
+        }
+        out += '\n';
+        text = line_end + 1;
+    }
+    return success;
+}
+
+bool preprocess_shader(const char *path, const std::string &defines, std::string &out)
+{
+    std::string source;
+    bool success = append_shader(path, source, 0);
+
+    // #version must stay the first thing the compiler sees
+    size_t insert_at = 0;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        insert_at = source.find('\n');
+        insert_at = insert_at == std::string::npos ? source.size() : insert_at + 1;
+    }
+    out = source.substr(0, insert_at) + defines + source.substr(insert_at);
+    return success;
+}
+
+// ————— VARIANTS ————— //
+void ShaderVariants::set_sources(const char *vertex_path, const char *fragment_path)
+{
+    m_vertex_path   = vertex_path;
+    m_fragment_path = fragment_path;
+}
+
+bool ShaderVariants::add(ShaderManager &shaders, uint32_t key)
+{
+    if (!is_valid_shader_key(key)) return false;
+
+    // The name is only ever built once, since a built program's resources point at it
+    std::string defines, name = "sprite";
+    for (int feature = 0; feature < SHADER_FEATURE_COUNT; feature++)
+    {
+        if ((key & (1u << feature)) == 0) continue;
+        defines += std::string("#define ") + SHADER_FEATURE_NAMES[feature] + "\n";
+        name    += std::string(" ") + SHADER_FEATURE_NAMES[feature];
+    }
+    if (m_names[key].empty()) m_names[key] = name;
+
+    std::string vertex_source, fragment_source;
+    bool success = preprocess_shader(m_vertex_path, defines, vertex_source);
+    success = preprocess_shader(m_fragment_path, defines, fragment_source) && success;
+
+    // Even a missing file gets a program, which fails to link and says so
+    shaders.add(&m_programs[key], std::move(vertex_source), std::move(fragment_source), m_names[key].c_str());
+    return success;
+}
+
+// ————— CAMERA ————— //
+void ShaderVariants::set_view_matrix(const glm::mat4 &matrix)
+{
+    if (matrix == m_view) return;
+    m_view   = matrix;
+    m_camera = m_projection * m_view;
+    m_camera_version++;
+}
+
+void ShaderVariants::set_projection_matrix(const glm::mat4 &matrix)
+{
+    if (matrix == m_projection) return;
+    m_projection = matrix;
+    m_camera     = m_projection * m_view;
+    m_camera_version++;
+}
+
+ShaderProgram *ShaderVariants::use(uint32_t key)
+{
+    ShaderProgram &program = m_programs[key];
+    if (m_uploaded_camera_versions[key] == m_camera_version)
+    {
+        g_gl.UseProgram(program.get_program_id());
+        return &program;
+    }
+
+    program.set_camera_matrix(m_camera);
+    m_uploaded_camera_versions[key] = m_camera_version;
+    return &program;
+}
+
+void ShaderVariants::forget_camera_uploads()
+{
+    for (uint32_t &version : m_uploaded_camera_versions) version = 0;
+}
+
+void ShaderVariants::cleanup()
+{
+    for (ShaderProgram &program : m_programs) program.cleanup();
+
+    // A program built again later starts without the camera
+    forget_camera_uploads();
+}
@@ -0,0 +1,84 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <cstdint>
+#include <string>
+#include "glm/mat4x4.hpp"
+#include "ShaderManager.h"
+#include "ShaderProgram.h"
+
+// What a sprite shader variant does differently. A variant's key is its features OR'd together,
+// and is compiled from the same sources with a #define for each one.
+enum ShaderFeature : uint32_t
+{
+    SHADER_UNTEXTURED = 1 << 0,   // Flat colour, with no texture coordinates
+    SHADER_PALETTE    = 1 << 1,   // Indexed texture, with its palette on PALETTE_TEXTURE_UNIT
+    SHADER_BATCHED    = 1 << 2,   // Positions arrive with their model matrix already applied
+    SHADER_INSTANCED  = 1 << 3,   // The model matrix is a per-instance attribute
+};
+
+constexpr int SHADER_FEATURE_COUNT = 4;
+constexpr int SHADER_VARIANT_COUNT = 1 << SHADER_FEATURE_COUNT;
+
+// The #define each feature bit turns on, in bit order
+extern const char *const SHADER_FEATURE_NAMES[SHADER_FEATURE_COUNT];
+
+// Palettes need a texture, and a model matrix comes either pre-applied or per instance
+inline bool is_valid_shader_key(uint32_t key)
+{
+    return key < SHADER_VARIANT_COUNT &&
+           (key & (SHADER_UNTEXTURED | SHADER_PALETTE))  != (SHADER_UNTEXTURED | SHADER_PALETTE) &&
+           (key & (SHADER_BATCHED    | SHADER_INSTANCED)) != (SHADER_BATCHED    | SHADER_INSTANCED);
+}
+
+// Reads the shader at `path` through the asset file system, splicing in each `#include "file"`
+// line from the including file's folder, and puts `defines` after any #version line. False if
+// a file is missing or includes nest too deeply, which leaves `out` holding what was read.
+bool preprocess_shader(const char *path, const std::string &defines, std::string &out);
+
+// Every variant of the sprite shaders, indexed by key, so picking one while drawing is an
+// array lookup. Only the variants asked for are built.
+// The camera is one matrix, projection times view, that all the variants share. The legacy
+// contexts the game runs on have no uniform blocks, so each program keeps its own copy, and
+// use() uploads it only to a program that hasn't seen the latest camera.
+class ShaderVariants
+{
+private:
+    ShaderProgram m_programs[SHADER_VARIANT_COUNT] = {};
+    std::string   m_names[SHADER_VARIANT_COUNT];   // Resource labels and reports, e.g. "sprite PALETTE BATCHED"
+    const char   *m_vertex_path   = nullptr;
+    const char   *m_fragment_path = nullptr;
+
+    glm::mat4 m_view           = glm::mat4(1.0f);
+    glm::mat4 m_projection     = glm::mat4(1.0f);
+    glm::mat4 m_camera         = glm::mat4(1.0f);
+    uint32_t  m_camera_version = 1;
+    uint32_t  m_uploaded_camera_versions[SHADER_VARIANT_COUNT] = {};   // 0 for never
+
+public:
+    // Both paths must outlive the variants
+    void set_sources(const char *vertex_path, const char *fragment_path);
+
+    // Preprocesses the variant's sources and hands them to `shaders` to build. False for an
+    // invalid key or unreadable sources.
+    bool add(ShaderManager &shaders, uint32_t key);
+
+    // Setting the matrix the camera already has uploads nothing
+    void set_view_matrix(const glm::mat4 &matrix);
+    void set_projection_matrix(const glm::mat4 &matrix);
+
+    // Makes the variant current, with the camera as it is now. GL thread only.
+    ShaderProgram *use(uint32_t key);
+
+    // Every variant uploads the camera again on its next use()
+    void forget_camera_uploads();
+
+    void cleanup();
+
+    // Only variants that were added and built have a program
+    ShaderProgram *get(uint32_t key)             { return &m_programs[key]; }
+    bool        const is_built(uint32_t key) const { return m_programs[key].get_program_id() != 0; }
+    const char *const get_name(uint32_t key) const { return m_names[key].c_str(); }
+};
+
+#endif // SHADER_VARIANTS_H
@@ -0,0 +1,104 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "glm/mat4x4.hpp"
+#include "RenderCommands.h"
+
+enum RasterPath
+{
+    RASTER_SCALAR,
+    RASTER_SSE2,    // Four pixels at a time
+    RASTER_AVX2,    // Eight, with a hardware gather for the texels
+    RASTER_PATH_COUNT
+};
+
+extern const char* const RASTER_PATH_NAMES[RASTER_PATH_COUNT];
+
+struct SoftwareTexture
+{
+    std::vector<uint32_t> texels;   // RGBA8, top row first
+    int width  = 0;
+    int height = 0;
+};
+
+// A quad maps screen pixels back into its texture: s runs 0 to 1 across it and t 0 to 1 down
+// it, both affine in the pixel position, and a pixel is covered while both are in range
+struct SoftwareQuad
+{
+    const SoftwareTexture *texture;
+    int   min_x, min_y, max_x, max_y;   // Pixel bounds, max exclusive
+    float s_origin, s_dx, s_dy;         // s at the centre of pixel (0, 0), and its steps
+    float t_origin, t_dx, t_dy;
+    float texel_x, texel_width;         // Texel position at s = 0, and the span s covers
+    float texel_y, texel_height;
+};
+
+// Draws a RenderCommandList on the CPU, for machines with no usable GL. Every sprite and text
+// character is a textured quad; quads are binned into screen tiles and the tiles are shaded
+// on the job system, each in command order, so the result matches a single-threaded draw.
+// Sampling is nearest and blending SRC_ALPHA/ONE_MINUS_SRC_ALPHA, as the GL path sets them up.
+// Texture ids are the ones load_texture got from GL, so both paths share the command lists.
+class SoftwareRenderer
+{
+public:
+    static constexpr int TILE_SIZE = 64;   // Pixels on a side; a tile's rows stay in L1 while it is shaded
+
+private:
+    int        m_width   = 0;
+    int        m_height  = 0;
+    int        m_stride  = 0;   // Padded to whole tiles, so SIMD spans never cross into another tile
+    int        m_tiles_x = 0;
+    int        m_tiles_y = 0;
+    RasterPath m_path    = RASTER_SCALAR;
+
+    std::vector<uint32_t>        m_colour;
+    std::vector<SoftwareTexture> m_textures;   // Indexed by texture id
+    uint32_t  m_clear_colour = 0;
+    glm::mat4 m_projection   = glm::mat4(1.0f);
+    glm::mat4 m_view         = glm::mat4(1.0f);
+    glm::mat4 m_camera       = glm::mat4(1.0f);   // Projection times view, redone only when either changes
+
+    // Rebuilt every frame; cleared rather than freed, so a steady scene stops allocating
+    std::vector<SoftwareQuad>          m_quads;
+    std::vector<std::vector<uint32_t>> m_bins;           // Quad indices per tile, in draw order
+    std::vector<uint8_t>               m_tile_cleared;   // Whether a clear comes before the tile's quads
+
+    const SoftwareTexture *find_texture(GLuint texture_id) const;
+
+    // `transform` takes the unit quad to clip space
+    void add_quad(const SoftwareTexture *texture, const glm::mat4 &transform, const float *uv_rect);
+    void shade_tile(int tile);
+
+public:
+    // Picks the widest SIMD path this CPU has
+    bool create(int width, int height);
+    void destroy();
+
+    // Takes a copy of RGBA8 pixels, top row first, for the GL texture `texture_id`
+    void add_texture(GLuint texture_id, const unsigned char *pixels, int width, int height);
+
+    void set_clear_colour(float red, float green, float blue, float alpha);
+    void set_projection_matrix(const glm::mat4 &matrix) { m_projection = matrix; m_camera = m_projection * m_view; }
+    void set_path(RasterPath path);
+
+    RenderStats render(const RenderCommandList &commands);
+
+    // Copies the frame into the window's surface and shows it
+    void present(SDL_Window *window) const;
+
+    // The last frame as RGBA8, top row first, into `width * height * 4` bytes
+    void copy_pixels(unsigned char *out) const;
+
+    int        const get_width()  const { return m_width; }
+    int        const get_height() const { return m_height; }
+    RasterPath const get_path()   const { return m_path; }
+};
+
+#endif // SOFTWARE_RENDERER_H
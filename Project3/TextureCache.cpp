@@ -0,0 +1,124 @@
+#include "TextureCache.h"
+#include <cstdio>
+#include <cstring>
+#include "BinaryFile.h"
+
+// File layout, all little-endian:
+//   "LLTC" | u32 version | u32 entry count | u32 reserved |
+//   entries of u64 path hash | u64 source hash | u32 width | u32 height | u32 format |
+//   u32 reserved | u64 offset |
+//   texels for each entry in its TextureFormat, then its palette if indexed, starting on
+//   PIXEL_ALIGNMENT boundaries
+constexpr char     TEXTURE_CACHE_MAGIC[4] = { 'L', 'L', 'T', 'C' };
+constexpr uint32_t TEXTURE_CACHE_VERSION  = 2;   // 2: packed texels instead of RGBA8
+constexpr size_t   HEADER_SIZE     = 16;
+constexpr size_t   ENTRY_SIZE      = 40;
+constexpr size_t   PIXEL_ALIGNMENT = 64;   // A cache line, so uploads read whole lines
+
+// Texels followed by the palette, as laid out in the file
+static uint64_t entry_bytes(uint32_t format, uint32_t width, uint32_t height)
+{
+    uint64_t bytes = (uint64_t) width * height * TEXTURE_FORMATS[format].texel_bytes;
+    return format == TEXTURE_INDEXED ? bytes + PALETTE_BYTES : bytes;
+}
+
+bool TextureCache::open(const char *filepath)
+{
+    close();
+    if (!m_file.open(filepath)) return false;
+
+    const unsigned char *data = m_file.get_data();
+    size_t size = m_file.get_size();
+    bool valid = size >= HEADER_SIZE &&
+                 memcmp(data, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) == 0 &&
+                 get_u32(data + 4) == TEXTURE_CACHE_VERSION;
+
+    uint32_t count = valid ? get_u32(data + 8) : 0;
+    valid = valid && HEADER_SIZE + (size_t) count * ENTRY_SIZE <= size;
+
+    for (uint32_t i = 0; valid && i < count; i++)
+    {
+        const unsigned char *record = data + HEADER_SIZE + i * ENTRY_SIZE;
+        Entry entry = { get_u64(record), get_u64(record + 8), get_u32(record + 16), get_u32(record + 20),
+                        get_u32(record + 24), get_u64(record + 32) };
+
+        // A truncated file must not hand out texels past its end
+        valid = entry.format < TEXTURE_FORMAT_COUNT && entry.offset <= size &&
+                entry_bytes(entry.format, entry.width, entry.height) <= size - entry.offset;
+        m_entries.push_back(entry);
+    }
+
+    if (!valid) close();
+    return valid;
+}
+
+void TextureCache::close()
+{
+    m_entries.clear();
+    m_file.close();
+}
+
+bool TextureCache::find(const char *source_path, uint64_t source_hash, CachedImage &image) const
+{
+    uint64_t path_hash = hash_bytes(source_path, strlen(source_path));
+    for (const Entry &entry : m_entries)
+    {
+        if (entry.path_hash != path_hash || entry.source_hash != source_hash) continue;
+
+        const unsigned char *texels = m_file.get_data() + entry.offset;
+        image.filepath    = source_path;
+        image.source_hash = source_hash;
+        image.width       = (int) entry.width;
+        image.height      = (int) entry.height;
+        image.format      = (TextureFormat) entry.format;
+        image.texels      = texels;
+        image.palette     = nullptr;
+        if (image.format == TEXTURE_INDEXED)
+            image.palette = texels + texture_bytes(TEXTURE_INDEXED, image.width, image.height) - PALETTE_BYTES;
+        return true;
+    }
+    return false;
+}
+
+bool TextureCache::write(const char *filepath, const std::vector<CachedImage> &images)
+{
+    FILE *file = open_replacement(filepath);
+    if (file == nullptr) return false;
+
+    fwrite(TEXTURE_CACHE_MAGIC, 1, sizeof(TEXTURE_CACHE_MAGIC), file);
+    write_u32(file, TEXTURE_CACHE_VERSION);
+    write_u32(file, (uint32_t) images.size());
+    write_u32(file, 0);
+
+    size_t offset = align_up(HEADER_SIZE + images.size() * ENTRY_SIZE, PIXEL_ALIGNMENT);
+    for (const CachedImage &image : images)
+    {
+        write_u64(file, hash_bytes(image.filepath, strlen(image.filepath)));
+        write_u64(file, image.source_hash);
+        write_u32(file, (uint32_t) image.width);
+        write_u32(file, (uint32_t) image.height);
+        write_u32(file, (uint32_t) image.format);
+        write_u32(file, 0);
+        write_u64(file, offset);
+        offset = align_up(offset + texture_bytes(image.format, image.width, image.height), PIXEL_ALIGNMENT);
+    }
+
+    static const unsigned char PADDING[PIXEL_ALIGNMENT] = {};
+    size_t written = HEADER_SIZE + images.size() * ENTRY_SIZE;
+    for (const CachedImage &image : images)
+    {
+        fwrite(PADDING, 1, align_up(written, PIXEL_ALIGNMENT) - written, file);
+        written = align_up(written, PIXEL_ALIGNMENT);
+
+        size_t bytes = texture_bytes(image.format, image.width, image.height);
+        if (image.format == TEXTURE_INDEXED)
+        {
+            fwrite(image.texels, 1, bytes - PALETTE_BYTES, file);
+            fwrite(image.palette, 1, PALETTE_BYTES, file);
+        }
+        else fwrite(image.texels, 1, bytes, file);
+        written += bytes;
+    }
+
+    return replace_file_atomically(file, filepath);
+}
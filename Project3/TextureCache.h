@@ -0,0 +1,56 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MappedFile.h"
+#include "TextureFormat.h"
+
+struct CachedImage
+{
+    const char          *filepath;
+    uint64_t             source_hash;   // Of the source file's bytes
+    int                  width;
+    int                  height;
+    TextureFormat        format;
+    const unsigned char *texels;        // Packed into `format`, top row first
+    const unsigned char *palette;       // PALETTE_BYTES of RGBA8 for TEXTURE_INDEXED, else null
+};
+
+// Images decoded and packed, baked into one file, so a warm start uploads straight from a
+// mapping of it instead of inflating and packing PNGs. Entries are keyed by path and stay valid
+// only while the source's bytes hash the same; a changed source simply misses, and the file is
+// rewritten after loading.
+class TextureCache
+{
+private:
+    struct Entry
+    {
+        uint64_t path_hash;
+        uint64_t source_hash;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format;
+        uint64_t offset;   // Of the texels from the start of the file, with any palette after them
+    };
+
+    MappedFile         m_file;
+    std::vector<Entry> m_entries;
+
+public:
+    // False if there is no usable cache at `filepath`, which leaves this one empty
+    bool open(const char *filepath);
+    void close();
+
+    // Fills `image` with texels inside the mapping, valid until close(). False on a miss.
+    bool find(const char *source_path, uint64_t source_hash, CachedImage &image) const;
+
+    // Writes beside `filepath` and renames over it, so a crash midway leaves the old file intact.
+    // The cache at `filepath` must not be open.
+    static bool write(const char *filepath, const std::vector<CachedImage> &images);
+
+    int const get_count() const { return (int) m_entries.size(); }
+};
+
+#endif // TEXTURE_CACHE_H
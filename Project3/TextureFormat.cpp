@@ -0,0 +1,264 @@
+#define GL_SILENCE_DEPRECATION
+
+#include "TextureFormat.h"
+#include <cstdint>
+#include <cstring>
+
+const TextureFormatInfo TEXTURE_FORMATS[TEXTURE_FORMAT_COUNT] =
+{
+    { "RGBA8",           GL_RGBA8,              GL_RGBA,            GL_UNSIGNED_BYTE,          4 },
+    { "RGBA4",           GL_RGBA4,              GL_RGBA,            GL_UNSIGNED_SHORT_4_4_4_4, 2 },
+    { "RGB5_A1",         GL_RGB5_A1,            GL_RGBA,            GL_UNSIGNED_SHORT_5_5_5_1, 2 },
+    { "LUMINANCE_ALPHA", GL_LUMINANCE8_ALPHA8,  GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,          2 },
+    { "LUMINANCE",       GL_LUMINANCE8,         GL_LUMINANCE,       GL_UNSIGNED_BYTE,          1 },
+    { "ALPHA",           GL_ALPHA8,             GL_ALPHA,           GL_UNSIGNED_BYTE,          1 },
+    { "INDEXED",         GL_LUMINANCE8,         GL_LUMINANCE,       GL_UNSIGNED_BYTE,          1 },
+};
+
+// Open addressing over twice the palette size, so a full palette still finds colours quickly
+constexpr int      COLOUR_SLOTS = PALETTE_SIZE * 2;
+// Hidden pixels are all canonicalised to 0, so no colour has zero alpha and any other bits.
+// (All ones would be opaque white.)
+constexpr uint32_t EMPTY_SLOT   = 0x00FFFFFF;
+
+TexturePalettes g_texture_palettes;
+
+size_t texture_bytes(TextureFormat format, int width, int height)
+{
+    size_t bytes = (size_t) width * height * TEXTURE_FORMATS[format].texel_bytes;
+    return format == TEXTURE_INDEXED ? bytes + PALETTE_BYTES : bytes;
+}
+
+// ————— ANALYSIS ————— //
+// Every pixel nothing shows through becomes transparent black, so hidden colours neither
+// break a palette nor block a narrower format
+static uint32_t canonical_colour(const unsigned char *pixel)
+{
+    if (pixel[3] == 0) return 0;
+    return (uint32_t) pixel[0] | (uint32_t) pixel[1] << 8 | (uint32_t) pixel[2] << 16 | (uint32_t) pixel[3] << 24;
+}
+
+// Whether an 8-bit channel comes back unchanged from 5 bits. Drivers widen 5-bit channels
+// either by rounding or by repeating the top bits, which disagree on a few values, so only
+// values both give back count.
+static bool const is_exact_in_five_bits(uint32_t value)
+{
+    uint32_t reduced = value >> 3;
+    return ((reduced << 3) | (reduced >> 2)) == value && (reduced * 255 + 15) / 31 == value;
+}
+
+// The colours seen so far, up to a full palette. The slot table maps a colour to its index.
+struct ColourTable
+{
+    uint32_t slots[COLOUR_SLOTS];
+    uint8_t  indices[COLOUR_SLOTS];
+    uint32_t colours[PALETTE_SIZE];
+    int      count = 0;
+    bool     full  = false;   // Hit a colour past the last index, so the image can't be indexed
+
+    ColourTable() { for (uint32_t &slot : slots) slot = EMPTY_SLOT; }
+
+    // The slot holding `colour`, or the empty one it would go in
+    int find(uint32_t colour) const
+    {
+        int slot = (int) ((colour * 2654435761u) >> 23) & (COLOUR_SLOTS - 1);
+        while (slots[slot] != EMPTY_SLOT && slots[slot] != colour) slot = (slot + 1) & (COLOUR_SLOTS - 1);
+        return slot;
+    }
+
+    void add(uint32_t colour)
+    {
+        if (full) return;
+        int slot = find(colour);
+        if (slots[slot] == colour) return;
+        if (count == PALETTE_SIZE) { full = true; return; }
+
+        slots[slot]     = colour;
+        indices[slot]   = (uint8_t) count;
+        colours[count++] = colour;
+    }
+};
+
+// Every format's test folds into a bit mask, so checking a pixel doesn't branch. A 4-bit
+// channel is exact when both its nibbles match.
+struct PixelTests
+{
+    uint32_t alpha_and    = 0xFF;   // 0xFF while every pixel is opaque
+    uint32_t grey_bits    = 0;
+    uint32_t colour_bits  = 0;      // 0 while every pixel is black or hidden
+    uint32_t nibble_bits  = 0;
+    bool     fits_rgb5_a1 = true;
+
+    void add(uint32_t colour)
+    {
+        uint32_t alpha = colour >> 24;
+        alpha_and   &= alpha;
+        grey_bits   |= (colour ^ (colour >> 8)) & 0xFFFF;
+        colour_bits |= colour & 0xFFFFFF;
+        nibble_bits |= (colour ^ (colour >> 4)) & 0x0F0F0F0F;
+        if (fits_rgb5_a1)
+            fits_rgb5_a1 = (alpha == 0 || alpha == 255) && is_exact_in_five_bits(colour & 0xFF) &&
+                           is_exact_in_five_bits((colour >> 8) & 0xFF) && is_exact_in_five_bits((colour >> 16) & 0xFF);
+    }
+};
+
+// ————— PACKING ————— //
+TextureFormat pack_texture(const unsigned char *pixels, int width, int height, unsigned char *texels,
+                           unsigned char *palette)
+{
+    size_t pixel_count = (size_t) width * height;
+    ColourTable table;
+
+    // Sprite sheets are mostly runs of one colour, so the table is only asked about changes,
+    // and not at all once it is full; the rest of the pass then has nothing to mispredict
+    PixelTests tests;
+    uint32_t previous = canonical_colour(pixels);
+    table.add(previous);
+    size_t i = 0;
+    for (; i < pixel_count && !table.full; i++)
+    {
+        uint32_t colour = canonical_colour(pixels + i * 4);
+        tests.add(colour);
+        if (colour != previous) table.add(colour);
+        previous = colour;
+    }
+    for (; i < pixel_count; i++) tests.add(canonical_colour(pixels + i * 4));
+
+    bool exact[TEXTURE_FORMAT_COUNT];
+    exact[TEXTURE_LUMINANCE]       = tests.alpha_and == 0xFF && tests.grey_bits == 0;
+    exact[TEXTURE_ALPHA]           = tests.colour_bits == 0;
+    exact[TEXTURE_LUMINANCE_ALPHA] = tests.grey_bits == 0;
+    exact[TEXTURE_RGBA4]           = tests.nibble_bits == 0;
+    exact[TEXTURE_RGB5_A1]         = tests.fits_rgb5_a1;
+    exact[TEXTURE_INDEXED]         = !table.full;
+
+    // In order of preference when sizes tie, since indexed textures need a second program
+    const TextureFormat candidates[] = { TEXTURE_LUMINANCE, TEXTURE_ALPHA, TEXTURE_LUMINANCE_ALPHA, TEXTURE_RGBA4,
+                                         TEXTURE_RGB5_A1, TEXTURE_INDEXED };
+
+    TextureFormat format = TEXTURE_RGBA8;
+    for (TextureFormat candidate : candidates)
+        if (exact[candidate] && texture_bytes(candidate, width, height) < texture_bytes(format, width, height))
+            format = candidate;
+
+    // One loop per format, so none of them branches on it per texel. Packed 16-bit texels are
+    // written in native byte order, which is how GL reads them.
+    uint16_t packed;
+    uint32_t index = 0;
+    switch (format)
+    {
+    case TEXTURE_LUMINANCE:
+        for (i = 0; i < pixel_count; i++) texels[i] = pixels[i * 4];
+        break;
+    case TEXTURE_ALPHA:
+        for (i = 0; i < pixel_count; i++) texels[i] = pixels[i * 4 + 3];
+        break;
+    case TEXTURE_LUMINANCE_ALPHA:
+        for (i = 0; i < pixel_count; i++)
+        {
+            texels[i * 2]     = pixels[i * 4 + 3] == 0 ? 0 : pixels[i * 4];
+            texels[i * 2 + 1] = pixels[i * 4 + 3];
+        }
+        break;
+    case TEXTURE_RGBA4:
+        for (i = 0; i < pixel_count; i++)
+        {
+            uint32_t colour = canonical_colour(pixels + i * 4);
+            packed = (uint16_t) ((colour & 0xF0) << 8 | (colour >> 4 & 0xF00) | (colour >> 16 & 0xF0) | colour >> 28);
+            memcpy(texels + i * 2, &packed, sizeof(packed));
+        }
+        break;
+    case TEXTURE_RGB5_A1:
+        for (i = 0; i < pixel_count; i++)
+        {
+            uint32_t colour = canonical_colour(pixels + i * 4);
+            packed = (uint16_t) ((colour & 0xF8) << 8 | (colour >> 5 & 0x7C0) | (colour >> 18 & 0x3E) | colour >> 31);
+            memcpy(texels + i * 2, &packed, sizeof(packed));
+        }
+        break;
+    case TEXTURE_INDEXED:
+        previous = canonical_colour(pixels) + 1;   // Anything but the first colour
+        for (i = 0; i < pixel_count; i++)
+        {
+            uint32_t colour = canonical_colour(pixels + i * 4);
+            if (colour != previous) index = table.indices[table.find(colour)];
+            previous  = colour;
+            texels[i] = (unsigned char) index;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (format == TEXTURE_INDEXED)
+    {
+        memset(palette, 0, PALETTE_BYTES);
+        for (int entry = 0; entry < table.count; entry++)
+        {
+            for (int channel = 0; channel < 4; channel++)
+                palette[entry * 4 + channel] = (unsigned char) (table.colours[entry] >> (8 * channel));
+        }
+    }
+    return format;
+}
+
+// ————— UNPACKING ————— //
+// Packing only picks formats whose channels come back exactly, so widening a 4-bit channel is
+// repeating its nibble and a 5-bit one repeating its top bits
+static void write_pixel(unsigned char *pixel, uint32_t red, uint32_t green, uint32_t blue, uint32_t alpha)
+{
+    pixel[0] = (unsigned char) red;
+    pixel[1] = (unsigned char) green;
+    pixel[2] = (unsigned char) blue;
+    pixel[3] = (unsigned char) alpha;
+}
+
+void unpack_texture(TextureFormat format, const unsigned char *texels, const unsigned char *palette, int width,
+                    int height, unsigned char *pixels)
+{
+    size_t pixel_count = (size_t) width * height;
+    uint16_t packed;
+    switch (format)
+    {
+    case TEXTURE_LUMINANCE:
+        for (size_t i = 0; i < pixel_count; i++) write_pixel(pixels + i * 4, texels[i], texels[i], texels[i], 0xFF);
+        break;
+    case TEXTURE_ALPHA:
+        for (size_t i = 0; i < pixel_count; i++) write_pixel(pixels + i * 4, 0, 0, 0, texels[i]);
+        break;
+    case TEXTURE_LUMINANCE_ALPHA:
+        for (size_t i = 0; i < pixel_count; i++)
+            write_pixel(pixels + i * 4, texels[i * 2], texels[i * 2], texels[i * 2], texels[i * 2 + 1]);
+        break;
+    case TEXTURE_RGBA4:
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            memcpy(&packed, texels + i * 2, sizeof(packed));
+            write_pixel(pixels + i * 4, (packed >> 12) * 0x11, (packed >> 8 & 0xF) * 0x11, (packed >> 4 & 0xF) * 0x11,
+                        (packed & 0xF) * 0x11);
+        }
+        break;
+    case TEXTURE_RGB5_A1:
+        for (size_t i = 0; i < pixel_count; i++)
+        {
+            memcpy(&packed, texels + i * 2, sizeof(packed));
+            uint32_t red = packed >> 11, green = packed >> 6 & 0x1F, blue = packed >> 1 & 0x1F;
+            write_pixel(pixels + i * 4, red << 3 | red >> 2, green << 3 | green >> 2, blue << 3 | blue >> 2,
+                        (packed & 1) ? 0xFF : 0);
+        }
+        break;
+    case TEXTURE_INDEXED:
+        for (size_t i = 0; i < pixel_count; i++) memcpy(pixels + i * 4, palette + texels[i] * 4, 4);
+        break;
+    default:
+        memcpy(pixels, texels, pixel_count * 4);
+        break;
+    }
+}
+
+// ————— PALETTES ————— //
+void TexturePalettes::set(GLuint texture_id, GLuint palette_id)
+{
+    if (texture_id >= m_palettes.size()) m_palettes.resize(texture_id + 1, 0);
+    m_palettes[texture_id] = palette_id;
+}
@@ -0,0 +1,77 @@
+#ifndef TEXTURE_FORMAT_H
+#define TEXTURE_FORMAT_H
+
+#ifdef _WINDOWS
+    #include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstddef>
+#include <vector>
+
+// How a texture is stored on the GPU. Every image is decoded to RGBA8, then uploaded in the
+// smallest of these that draws it exactly the same. Pixels with no alpha count as equal
+// whatever their colour, since blending hides them and sampling is nearest-texel.
+enum TextureFormat
+{
+    TEXTURE_RGBA8,
+    TEXTURE_RGBA4,            // 4 bits a channel
+    TEXTURE_RGB5_A1,          // 5 bits a colour channel and 1 of alpha
+    TEXTURE_LUMINANCE_ALPHA,  // Grey with alpha
+    TEXTURE_LUMINANCE,        // Opaque grey
+    TEXTURE_ALPHA,            // Black with alpha
+    TEXTURE_INDEXED,          // One byte per texel into a palette, drawn with the palette shader
+    TEXTURE_FORMAT_COUNT
+};
+
+struct TextureFormatInfo
+{
+    const char *name;
+    GLint       internal_format;
+    GLenum      format;
+    GLenum      type;
+    int         texel_bytes;
+};
+extern const TextureFormatInfo TEXTURE_FORMATS[TEXTURE_FORMAT_COUNT];
+
+// An indexed texture's palette is a PALETTE_SIZE x 1 RGBA8 texture, bound on its own unit
+constexpr int    PALETTE_SIZE         = 256;
+constexpr size_t PALETTE_BYTES        = PALETTE_SIZE * 4;
+constexpr GLint  PALETTE_TEXTURE_UNIT = 1;
+
+// GPU bytes for a texture of this size, counting an indexed texture's palette
+size_t texture_bytes(TextureFormat format, int width, int height);
+
+// Picks the smallest exact format for RGBA8 `pixels` and converts them into `texels`, which
+// must hold width * height * 2 bytes, and for TEXTURE_INDEXED into `palette`, which must hold
+// PALETTE_BYTES. Nothing is written for TEXTURE_RGBA8; the pixels upload as they are.
+TextureFormat pack_texture(const unsigned char *pixels, int width, int height, unsigned char *texels,
+                           unsigned char *palette);
+
+// Turns packed `texels` back into RGBA8 `pixels`, which must hold width * height * 4 bytes.
+// Pixels nothing shows through come back as transparent black rather than their old colour.
+void unpack_texture(TextureFormat format, const unsigned char *texels, const unsigned char *palette, int width,
+                    int height, unsigned char *pixels);
+
+// Which palette each indexed texture looks its colours up in, by texture id. Filled while
+// textures load, then only read by whichever thread draws.
+class TexturePalettes
+{
+private:
+    std::vector<GLuint> m_palettes;
+
+public:
+    void set(GLuint texture_id, GLuint palette_id);
+    void clear() { m_palettes.clear(); }
+
+    // 0 for a texture that isn't indexed
+    GLuint const get_palette(GLuint texture_id) const
+    {
+        return texture_id < m_palettes.size() ? m_palettes[texture_id] : 0;
+    }
+};
+
+extern TexturePalettes g_texture_palettes;
+
+#endif // TEXTURE_FORMAT_H
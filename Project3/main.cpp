@@ -22,13 +22,47 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "AllocationTracker.h"
+#include "AssetFileSystem.h"
+#include "AssetLoader.h"
+
+// stb_image's buffers come from the load arena while images are decoded at startup, and count
+// towards the allocation totals like everything else
+#define STBI_MALLOC(size)           image_malloc(size)
+#define STBI_REALLOC(pointer, size) image_realloc(pointer, size)
+#define STBI_FREE(pointer)          image_free(pointer)
 #include "stb_image.h"
 #include "cmath"
 #include <ctime>
-#include <cstdlib>  // For rand() and srand()
+#include <cstdlib>
 #include <vector>
+#include "Benchmarks.h"
+#include "BinaryFile.h"
 #include "Entity.h"
+#include "GLDispatch.h"
+#include "GLNull.h"
+#include "GoldenImage.h"
+#include "GLResources.h"
+#include "FramePacer.h"
+#include "Gravity.h"
+#include "Histogram.h"
+#include "JobSystem.h"
+#include "LevelGenerator.h"
+#include "Offscreen.h"
+#include "PerfOverlay.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include "Qoi.h"
+#include "RenderCommands.h"
+#include "RenderThread.h"
+#include "Replay.h"
+#include "Rollback.h"
+#include "ShaderManager.h"
+#include "SoftwareRenderer.h"
+#include "TextureFormat.h"
 #include <string.h>
+#include <thread>
+#include <type_traits>
 
 // ————— CONSTANTS ————— //
 constexpr int WINDOW_WIDTH  = 640 * 2,
@@ -44,29 +78,91 @@ constexpr int VIEWPORT_X = 0,
               VIEWPORT_WIDTH  = WINDOW_WIDTH,
               VIEWPORT_HEIGHT = WINDOW_HEIGHT;
 
-constexpr char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
-               F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
+constexpr char V_SHADER_PATH[] = "shaders/sprite_vertex.glsl",
+               F_SHADER_PATH[] = "shaders/sprite_fragment.glsl",
+               SHADER_INCLUDE_PATH[] = "shaders/sprite_common.glsl";   // Only read through #include
 
 constexpr float MILLISECONDS_IN_SECOND = 1000.0;
+constexpr float DEFAULT_TARGET_FPS     = 60.0f;
+constexpr int   IDLE_WAIT_MS           = 250;  // Longest the idle title screen sleeps between frames
+constexpr char  DEFAULT_TRACE_FILEPATH[] = "trace.json";
+constexpr float STATS_LOG_SECONDS      = 10.0f; // How often the frame-time percentiles are logged
+constexpr uint64_t DEFAULT_SOAK_TICKS     = 1000000;
+constexpr uint64_t SOAK_WARMUP_TICKS      = 36000;  // Ten minutes of play for every buffer to reach its size
+constexpr uint64_t SOAK_RSS_SAMPLE_TICKS  = 100000;
+constexpr size_t   SOAK_RSS_TOLERANCE     = 256 * 1024;
+constexpr uint64_t ROLLBACK_TEST_TICKS    = 3600;   // A minute of play, unless the level ends first
+constexpr int      DEFAULT_ROLLBACK_TEST_DELAY = 8;
+constexpr uint64_t DEFAULT_NULL_GL_FRAMES = 20000;
+constexpr int      NULL_GL_PASSES         = 5;      // The fastest pass is the number to gate on
+constexpr uint64_t BENCHMARK_SEED         = 1;      // Headless runs play this level unless --seed picks another
+constexpr uint64_t DEFAULT_OFFSCREEN_FRAMES = 1800;
+constexpr int      OFFSCREEN_TIMED_PASSES   = 3;    // After the pass that checks the goldens
+constexpr uint64_t GOLDEN_INTERVAL          = 120;  // Every this many frames is checked against a golden image
+constexpr int      DEFAULT_GOLDEN_TOLERANCE = 2;    // Per channel; drivers round blending differently
+constexpr char     GOLDEN_FILENAME_FORMAT[] = "%s/frame_%05llu%s.png";
+constexpr char     DEFAULT_TEXTURE_CACHE_FILEPATH[] = "textures.cache";
+constexpr char     DEFAULT_SHADER_CACHE_FILEPATH[]  = "shaders.cache";
+constexpr char     DEFAULT_ASSET_PACK_FILEPATH[]    = "assets.pack";
 constexpr char  EXPLOSION_FILEPATH[] = "Explosion.png",
+                FULL_FUEL_FILEPATH[]   = "health_10.png",
                 ASTEROIDS_FILEPATH[] = "Asteroids.png",
                 FONTSHEET_FILEPATH[]   = "font1.png",
                 PLATFORM_FILEPATH[]    = "world_tileset.png",
                 SPACESHIP_FILEPATH[]   = "Spaceships.png";
+const char* const FUEL_GAUGE_FILEPATHS[] = { "health_00.png", "health_01.png", "health_02.png", "health_03.png",
+                                             "health_04.png", "health_05.png", "health_06.png", "health_07.png",
+                                             "health_08.png", "health_09.png" };
+constexpr int FUEL_GAUGE_COUNT = sizeof(FUEL_GAUGE_FILEPATHS) / sizeof(FUEL_GAUGE_FILEPATHS[0]);
 
 constexpr GLint NUMBER_OF_TEXTURES = 1;
 constexpr GLint LEVEL_OF_DETAIL    = 0;
 constexpr GLint TEXTURE_BORDER     = 0;
 
-constexpr float FIXED_TIMESTEP = 1.0f / 60.0f;
+constexpr float FIXED_TIMESTEP = 1.0f / 60.0f; // Default; --tick-rate overrides it
 constexpr float ACC_OF_GRAVITY = -9.81f;
 constexpr int   PLATFORM_COUNT = 20;
 constexpr int   ASTEROID_COUNT = 5;
 
+constexpr float FUEL_BURN_RATE = 18.0f; // Per second of thrust
+constexpr float ASTEROID_MASS  = 0.05f; // Pulls about as hard as the planet from a couple of units away
+constexpr int   DEFAULT_GRAVITY_BENCHMARK_BODIES = 100000;
+constexpr int   DEFAULT_JOBS_BENCHMARK_ENTITIES  = 100000;
+constexpr int   DEFAULT_SOFTWARE_BENCHMARK_SPRITES = 4000;
+
+constexpr int   ROLLBACK_CAPACITY       = 120; // Two seconds of ticks at 60 Hz
+constexpr float PRACTICE_REWIND_SECONDS = 2.0f;
+constexpr int   REPLAY_BENCHMARK_RUNS   = 200; // Replays are short, so time many runs back to back
+
+
+const char* const VSYNC_MODE_NAMES[] = { "off", "on", "adaptive" };
 
 // ————— STRUCTS AND ENUMS —————//
 enum AppStatus { RUNNING, TERMINATED };
 
+// Every texture the game loads, in the order they are queued for decoding
+enum TextureSlot
+{
+    TEXTURE_PLAYER,
+    TEXTURE_PLATFORM,
+    TEXTURE_ASTEROIDS,
+    TEXTURE_FONT,
+    TEXTURE_EXPLOSION,
+    TEXTURE_FULL_FUEL,
+    TEXTURE_FUEL_GAUGE,   // The first of FUEL_GAUGE_COUNT
+    TEXTURE_SLOT_COUNT = TEXTURE_FUEL_GAUGE + FUEL_GAUGE_COUNT
+};
+
+// What checking one offscreen frame against its golden image came to
+enum GoldenResult
+{
+    GOLDEN_MATCHED,
+    GOLDEN_MISMATCHED,
+    GOLDEN_RECORDED,       // There was none, so this frame becomes it
+    GOLDEN_NOT_RECORDED,   // There was none and it couldn't be written
+    GOLDEN_RESULT_COUNT
+};
+
 struct GameState
 {
     Entity* player;
@@ -74,170 +170,552 @@ struct GameState
     Entity* others;
 };
 
+// Everything a fixed step can change. Kept trivially copyable so the rollback buffer can
+// store and delta-compress it as raw bytes.
+struct SimState
+{
+    Entity player;
+    physics_scalar fuel;
+    bool   isRunning;
+    int    gameMessage;
+    int    gameStat;
+
+    // Asteroids only move in the asteroid gravity mode, but are always kept for simplicity
+    glm::vec2 asteroid_positions[ASTEROID_COUNT];
+    glm::vec2 asteroid_velocities[ASTEROID_COUNT];
+};
+
+static_assert(std::is_trivially_copyable<SimState>::value, "SimState must be snapshottable bytewise");
+
 // ————— VARIABLES ————— //
 GameState g_game_state;
+Entity g_full_fuel_gauge;
 
 SDL_Window* g_display_window;
+SDL_GLContext g_gl_context;
+RenderThread g_render_thread;
+bool g_threaded_rendering = true;
+bool g_software_rendering = false;
+SoftwareRenderer g_software_renderer;
+bool g_show_overlay = false;
+MainThreadTimings g_main_timings;
+
+// Counts every GL call per frame; the path also gets one CSV row per frame
+bool g_count_gl_calls = false;
+const char* g_gl_calls_path = nullptr;
+
+// Timings since the last periodic log line, folded into the session totals after each one
+SessionStats g_window_stats;
+SessionStats g_session_stats;
+Uint64 g_stats_window_start = 0;
+const char* g_stats_out_path = nullptr;
+const char* g_compare_stats_paths[2] = { nullptr, nullptr };
+
+// Allocations since the main loop started, and per frame
+AllocationCounts g_loop_allocations[ALLOCATION_PHASE_COUNT];
+AllocationCounts g_frame_allocation_start;
+uint64_t g_allocating_frames = 0;
+uint64_t g_worst_frame_allocations = 0;
+uint64_t g_soak_ticks = 0;
+int g_rollback_test_delay = 0;
+bool g_rewind_every_input = false; // Rollback test: treat every delayed input as a misprediction
+uint64_t g_null_gl_frames = 0;
+uint64_t g_offscreen_frames = 0;
+const char* g_golden_directory = nullptr;
+int g_golden_tolerance = DEFAULT_GOLDEN_TOLERANCE;
+const char* g_trace_path = DEFAULT_TRACE_FILEPATH;
+FramePacer g_frame_pacer;
+VsyncMode g_vsync_mode = VSYNC_ADAPTIVE;
+float g_target_fps = DEFAULT_TARGET_FPS;
 AppStatus g_app_status = RUNNING;
 
-ShaderProgram g_shader_program = ShaderProgram();
+ShaderVariants g_shaders;
+bool           g_shader_report = false;   // Builds every variant and lists their locations
 glm::mat4 g_view_matrix, g_projection_matrix;
 
 float g_previous_ticks   = 0.0f;
 float g_time_accumulator = 0.0f;
+float g_fixed_timestep   = FIXED_TIMESTEP;
+bool  g_run_integrator_benchmark = false;
+bool  g_run_profiler_benchmark   = false;
 bool isRunning = false;
-float fuel = 100;
-constexpr int FONTBANK_SIZE = 16;
+physics_scalar fuel(100.0f); // Simulated, so it follows the physics build's arithmetic
 GLuint g_font_texture_id;
 int gameMessage = 0;
 int gameStat = 0;
+GLuint g_explosion_texture_id;
+
+// ————— LEVEL ————— //
+uint64_t g_level_seed;
+bool g_has_level_seed = false;
+bool g_restart_requested = false;
+LevelParameters g_level_parameters;
+LevelLayout g_level_layout;
+GLuint g_player_texture_id, g_platform_texture_id, g_asteroid_texture_id;
+
+// Owns every texture; the ids above and in entities are only borrowed
+std::vector<GLTexture> g_textures;
+
+// ————— STARTUP ————— //
+AssetLoader g_asset_loader;
+GLuint g_texture_ids[TEXTURE_SLOT_COUNT];
+bool   g_serial_load = false;
+bool   g_pack_texture_formats = true;   // Off, every texture is uploaded as RGBA8
+bool   g_texture_report = false;
+size_t g_texture_bytes = 0, g_rgba8_texture_bytes = 0;   // What the textures take, and would as RGBA8
+const char* g_texture_cache_path = DEFAULT_TEXTURE_CACHE_FILEPATH;   // Null turns the cache off
+const char* g_shader_cache_path  = DEFAULT_SHADER_CACHE_FILEPATH;    // Null compiles every launch
+std::string g_texture_cache_location, g_shader_cache_location;       // The default caches beside the executable
+const char* g_asset_pack_path    = DEFAULT_ASSET_PACK_FILEPATH;      // Null reads loose files only
+const char* g_build_pack_path    = nullptr;
+bool        g_pack_qoi           = false;   // Stores the pack's images as QOI
+const char* g_convert_qoi_paths[2] = { nullptr, nullptr };
+bool        g_run_qoi_benchmark  = false;
+Uint64 g_startup_counter = 0;     // When main() was entered; cleared once the first frame is out
+float  g_textures_ready_ms = 0.0f;
+
+// ————— ROLLBACK ————— //
+uint32_t g_tick = 0;
+uint32_t g_confirmed_ticks = 0; // Every tick below this has its real input
+TickInput g_last_confirmed_input;
+bool g_start_requested  = false;
+bool g_rewind_requested = false;
+
+SimState g_sim_scratch = SimState(); // Value-initialised so padding bytes stay zero in snapshots
+RollbackBuffer g_rollback(ROLLBACK_CAPACITY, sizeof(SimState));
+DelayedInputSource g_input_source;
+
+// ————— REPLAYS ————— //
+const char* g_record_path = nullptr;
+const char* g_replay_path = nullptr;
+Replay   g_replay;
+uint32_t g_replay_start_tick = 0;
+
+uint32_t g_resimulated_ticks   = 0;
+Uint64   g_resimulation_counts = 0;
+
+// ————— GRAVITY ————— //
+GravityMode   g_gravity_mode  = GRAVITY_CONSTANT;
+float         g_opening_angle = DEFAULT_OPENING_ANGLE;
+BarnesHutTree g_gravity_tree;
+glm::vec2     g_asteroid_positions[ASTEROID_COUNT];
+float         g_asteroid_masses[ASTEROID_COUNT];
+int           g_gravity_benchmark_bodies = 0;
+
+// ————— JOBS ————— //
+int g_thread_count = 0; // 0 uses every hardware thread
+int g_jobs_benchmark_entities = 0;
+int g_software_benchmark_sprites = 0;
 
 // ———— GENERAL FUNCTIONS ———— //
-GLuint load_texture(const char* filepath);
-void draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index,
-                                    int rows, int cols);
+void texture_filepaths(const char* filepaths[TEXTURE_SLOT_COUNT]);
+void queue_textures();
+GLuint upload_texture(const DecodedImage &image);
+void mount_assets();
+bool encode_as_qoi(const unsigned char* data, size_t size, std::vector<unsigned char> &out);
+int run_build_pack(const char* pack_path);
+int run_qoi_conversion(const char* source_path, const char* qoi_path);
 
 void initialise();
+void load_scene();
+void initialise_simulation();
+void reset_player();
+void reset_run_state();
+void build_level(uint64_t seed);
+void restart_level();
+void start_recording();
+void finish_recording();
+float milliseconds_since(Uint64 start_counter);
+uint64_t microseconds_since(Uint64 start_counter);
+void record_frame_stats(bool sampled);
+void record_frame_allocations();
+void log_allocations();
+void log_startup();
+void log_shader_variants();
+TickInput soak_input(uint64_t tick);
+int run_soak(uint64_t ticks);
+int run_rollback_test(int delay_ticks);
+int run_null_gl_benchmark(uint64_t frames);
+bool apply_replay(const char* filepath);
+GoldenResult check_golden(uint64_t frame, const unsigned char* pixels, int width, int height);
+int run_offscreen(uint64_t frames);
+void handle_event(const SDL_Event &event);
 void process_input();
+void apply_asteroid_gravity();
+void simulate_tick(TickInput input);
+void resimulate_from(uint32_t tick);
+void receive_inputs(uint32_t current_tick);
+void rewind_to_tick(uint32_t tick);
+void advance_tick(TickInput local_input);
 void update();
+void record_scene(RenderCommandList &commands);
 void render();
 void shutdown();
 
-GLuint load_texture(const char* filepath)
+// Starts decoding every texture on the job system, so the decodes overlap creating the window
+// and context and compiling the shaders. Only the first call queues anything.
+void queue_textures()
 {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components,
-                                     STBI_rgb_alpha);
+    if (g_asset_loader.get_count() > 0) return;
+    g_asset_loader.set_parallel(!g_serial_load);
+    g_asset_loader.set_pack_formats(g_pack_texture_formats);
+    g_asset_loader.set_keep_pixels(g_software_rendering);
+    if (g_texture_cache_path != nullptr) g_asset_loader.use_cache(g_texture_cache_path);
+
+    const char* filepaths[TEXTURE_SLOT_COUNT];
+    texture_filepaths(filepaths);
+    for (const char* filepath : filepaths) g_asset_loader.queue(filepath);
+}
+
+void texture_filepaths(const char* filepaths[TEXTURE_SLOT_COUNT])
+{
+    filepaths[TEXTURE_PLAYER]    = SPACESHIP_FILEPATH;
+    filepaths[TEXTURE_PLATFORM]  = PLATFORM_FILEPATH;
+    filepaths[TEXTURE_ASTEROIDS] = ASTEROIDS_FILEPATH;
+    filepaths[TEXTURE_FONT]      = FONTSHEET_FILEPATH;
+    filepaths[TEXTURE_EXPLOSION] = EXPLOSION_FILEPATH;
+    filepaths[TEXTURE_FULL_FUEL] = FULL_FUEL_FILEPATH;
+    for (int i = 0; i < FUEL_GAUGE_COUNT; i++) filepaths[TEXTURE_FUEL_GAUGE + i] = FUEL_GAUGE_FILEPATHS[i];
+}
 
-    if (image == NULL)
+// ————— ASSETS ————— //
+// Looks for the pack beside the executable before the working directory, and loose files the
+// same way, so the game runs from wherever it is launched. The caches live beside the
+// executable too, unless the command line put them somewhere else.
+void mount_assets()
+{
+    char* base_path = SDL_GetBasePath();
+    g_assets.set_base_path(base_path);
+    if (base_path != nullptr && g_texture_cache_path == DEFAULT_TEXTURE_CACHE_FILEPATH)
     {
-        LOG("Unable to load image. Make sure the path is correct.");
-        assert(false);
+        g_texture_cache_location = std::string(base_path) + DEFAULT_TEXTURE_CACHE_FILEPATH;
+        g_texture_cache_path     = g_texture_cache_location.c_str();
     }
+    if (base_path != nullptr && g_shader_cache_path == DEFAULT_SHADER_CACHE_FILEPATH)
+    {
+        g_shader_cache_location = std::string(base_path) + DEFAULT_SHADER_CACHE_FILEPATH;
+        g_shader_cache_path     = g_shader_cache_location.c_str();
+    }
+    SDL_free(base_path);
 
-    GLuint textureID;
-    glGenTextures(NUMBER_OF_TEXTURES, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER,
-                 GL_RGBA, GL_UNSIGNED_BYTE, image);
+    if (g_asset_pack_path != nullptr && g_assets.mount(g_asset_pack_path))
+        LOG("Assets: " << g_assets.get_file_count() << " files from " << g_assets.get_pack_path() << " ("
+            << g_assets.get_pack_size() / 1024 << " KB, one mapping)");
+    else
+        LOG("Assets: " << (g_asset_pack_path != nullptr ? "no pack found, " : "") << "reading loose files");
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+// Packs every texture and shader the game loads, under the paths it loads them by
+int run_build_pack(const char* pack_path)
+{
+    const char* textures[TEXTURE_SLOT_COUNT];
+    texture_filepaths(textures);
+
+    std::vector<const char*> paths(textures, textures + TEXTURE_SLOT_COUNT);
+    paths.push_back(V_SHADER_PATH);
+    paths.push_back(F_SHADER_PATH);
+    paths.push_back(SHADER_INCLUDE_PATH);
+
+    char* base_path = SDL_GetBasePath();
+    g_assets.set_base_path(base_path);
+    SDL_free(base_path);
+
+    // The loader tells QOI apart by its magic bytes, so converted images keep their paths.
+    // Anything stb_image can't read, like the shaders, goes in as it is.
+    AssetFileSystem::PackTransform transform = nullptr;
+    if (g_pack_qoi)
+        transform = [](const char*, const AssetFile &source, std::vector<unsigned char> &out)
+        {
+            return encode_as_qoi(source.get_data(), source.get_size(), out);
+        };
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (!g_assets.build_pack(pack_path, paths, transform))
+    {
+        LOG("ERROR: Could not build the asset pack " << pack_path);
+        return 1;
+    }
+    LOG("Asset pack: " << paths.size() << " files written to " << pack_path << (g_pack_qoi ? ", images as QOI" : ""));
+    return 0;
+}
 
-    stbi_image_free(image);
+// Any image stb_image reads, re-encoded losslessly as QOI
+bool encode_as_qoi(const unsigned char* data, size_t size, std::vector<unsigned char> &out)
+{
+    int width, height, number_of_components;
+    unsigned char* pixels = stbi_load_from_memory(data, (int) size, &width, &height, &number_of_components, STBI_rgb_alpha);
+    if (pixels == NULL) return false;
 
-    return textureID;
+    bool has_alpha = number_of_components == 2 || number_of_components == 4;
+    qoi_encode(pixels, width, height, has_alpha ? 4 : 3, out);
+    stbi_image_free(pixels);
+    return true;
 }
 
-void draw_text(ShaderProgram *shader_program, GLuint font_texture_id, std::string text,
-               float font_size, float spacing, glm::vec3 position)
+int run_qoi_conversion(const char* source_path, const char* qoi_path)
 {
-    // Scale the size of the fontbank in the UV-plane
-    // We will use this for spacing and positioning
-    float width = 1.0f / FONTBANK_SIZE;
-    float height = 1.0f / FONTBANK_SIZE;
-
-    // Instead of having a single pair of arrays, we'll have a series of pairs—one for
-    // each character. Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    AssetFile source = g_assets.open(source_path);
+    std::vector<unsigned char> encoded;
+    if (!source.is_open() || !encode_as_qoi(source.get_data(), source.get_size(), encoded))
+    {
+        LOG("ERROR: Could not read the image " << source_path);
+        return 1;
+    }
 
-    // For every character...
-    for (int i = 0; i < text.size(); i++) {
-        // 1. Get their index in the spritesheet, as well as their offset (i.e. their
-        //    position relative to the whole sentence)
-        int spritesheet_index = (int) text[i];  // ascii value of character
-        float offset = (font_size + spacing) * i;
+    FILE* file = fopen(qoi_path, "wb");
+    bool written = file != nullptr && fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    if (file != nullptr) written = fclose(file) == 0 && written;
+    if (!written)
+    {
+        LOG("ERROR: Could not write " << qoi_path);
+        return 1;
+    }
 
-        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
-        float u_coordinate = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
-        float v_coordinate = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
+    LOG("QOI: " << source_path << " (" << source.get_size() << " bytes) -> " << qoi_path << " (" << encoded.size() << " bytes)");
+    return 0;
+}
 
-        // 3. Inset the current pair in both vectors
-        vertices.insert(vertices.end(), {
-            offset + (-0.5f * font_size), 0.5f * font_size,
-            offset + (-0.5f * font_size), -0.5f * font_size,
-            offset + (0.5f * font_size), 0.5f * font_size,
-            offset + (0.5f * font_size), -0.5f * font_size,
-            offset + (0.5f * font_size), 0.5f * font_size,
-            offset + (-0.5f * font_size), -0.5f * font_size,
-        });
+GLuint upload_texture(const DecodedImage &decoded)
+{
+    PROFILE_FUNCTION();
+    int width = decoded.width, height = decoded.height;
 
-        texture_coordinates.insert(texture_coordinates.end(), {
-            u_coordinate, v_coordinate,
-            u_coordinate, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate + width, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate, v_coordinate + height,
-        });
+    if (decoded.texels == NULL)
+    {
+        LOG("Unable to load image " << decoded.filepath << ". Make sure the path is correct.");
+        assert(false);
     }
 
-    // 4. And render all of them using the pairs
-    glm::mat4 model_matrix = glm::mat4(1.0f);
-    model_matrix = glm::translate(model_matrix, position);
+    const TextureFormatInfo &format = TEXTURE_FORMATS[decoded.format];
+    GLuint textureID;
+    g_gl.GenTextures(NUMBER_OF_TEXTURES, &textureID);
+    g_gl.BindTexture(GL_TEXTURE_2D, textureID);
+    g_gl.TexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, format.internal_format, width, height, TEXTURE_BORDER,
+                 format.format, format.type, decoded.texels);
+
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    shader_program->set_model_matrix(model_matrix);
-    glUseProgram(shader_program->get_program_id());
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    glVertexAttribPointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
-                          vertices.data());
-    glEnableVertexAttribArray(shader_program->get_position_attribute());
+    // The software renderer samples the RGBA8 pixels whatever the GPU copy was packed into
+    if (g_software_rendering) g_software_renderer.add_texture(textureID, decoded.pixels, width, height);
 
-    glVertexAttribPointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
-                          false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    // The path doubles as the leak report label, so it must be a constant
+    size_t texel_bytes = texture_bytes(decoded.format, width, height);
+    g_textures.emplace_back(textureID, texel_bytes - (decoded.format == TEXTURE_INDEXED ? PALETTE_BYTES : 0),
+                            decoded.filepath);
 
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int) (text.size() * 6));
+    if (decoded.format == TEXTURE_INDEXED)
+    {
+        GLuint palette_id;
+        g_gl.GenTextures(NUMBER_OF_TEXTURES, &palette_id);
+        g_gl.BindTexture(GL_TEXTURE_2D, palette_id);
+        g_gl.TexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA8, PALETTE_SIZE, 1, TEXTURE_BORDER,
+                        GL_RGBA, GL_UNSIGNED_BYTE, decoded.palette);
+        g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        g_gl.TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        g_textures.emplace_back(palette_id, PALETTE_BYTES, decoded.filepath);
+        g_texture_palettes.set(textureID, palette_id);
+    }
 
-    glDisableVertexAttribArray(shader_program->get_position_attribute());
-    glDisableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    size_t rgba8_bytes = texture_bytes(TEXTURE_RGBA8, width, height);
+    g_texture_bytes       += texel_bytes;
+    g_rgba8_texture_bytes += rgba8_bytes;
+    if (g_texture_report)
+    {
+        char line[128];
+        snprintf(line, sizeof(line), "Texture: %-20s %4dx%-4d %-15s %7zu bytes, %7zu as RGBA8 (%.0f%% saved)",
+                 decoded.filepath, width, height, format.name, texel_bytes, rgba8_bytes,
+                 100.0 * (1.0 - (double) texel_bytes / rgba8_bytes));
+        LOG(line);
+    }
+    return textureID;
 }
 
 void initialise()
 {
+    queue_textures();
     SDL_Init(SDL_INIT_VIDEO);
     g_display_window = SDL_CreateWindow("Project 3",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
         WINDOW_WIDTH, WINDOW_HEIGHT,
-        SDL_WINDOW_OPENGL);
+        g_software_rendering ? 0 : SDL_WINDOW_OPENGL);
 
-    SDL_GLContext context = SDL_GL_CreateContext(g_display_window);
-    SDL_GL_MakeCurrent(g_display_window, context);
-    
-    if (context == nullptr)
+    if (g_software_rendering)
     {
-        LOG("ERROR: Could not create OpenGL context.\n");
-        shutdown();
+        // No context at all: the null backend takes the GL calls, so shaders and textures
+        // still get ids, and the CPU draws the frames
+        g_software_renderer.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+        gl_load_null();
+        LOG("Software rendering: " << RASTER_PATH_NAMES[g_software_renderer.get_path()] << " on "
+            << g_job_system.get_thread_count() << " threads");
     }
+    else
+    {
+        g_gl_context = SDL_GL_CreateContext(g_display_window);
+        SDL_GL_MakeCurrent(g_display_window, g_gl_context);
+
+        if (g_gl_context == nullptr)
+        {
+            LOG("ERROR: Could not create OpenGL context.\n");
+            shutdown();
+        }
 
 #ifdef _WINDOWS
-    glewInit();
+        glewInit();
 #endif
 
-    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+        gl_load_native();
+    }
+    if (g_count_gl_calls) gl_enable_call_counting();
+    if (g_gl_calls_path != nullptr && !gl_open_call_log(g_gl_calls_path))
+        LOG("ERROR: Could not write GL call counts to " << g_gl_calls_path);
+
+    load_scene();
+
+    // The swap interval belongs to the context, so set it before handing the context over. A
+    // window surface has none, so the pacer times software frames.
+    if (g_software_rendering) g_vsync_mode = VSYNC_OFF;
+    VsyncMode requested_vsync = g_vsync_mode;
+    g_vsync_mode = apply_swap_interval(requested_vsync);
+    if (g_vsync_mode != requested_vsync) LOG("Vsync: driver refused the requested mode, using " << VSYNC_MODE_NAMES[g_vsync_mode]);
+    g_frame_pacer.start(g_target_fps, g_vsync_mode == VSYNC_OFF);
+
+    // A step slower than the timestep means the simulation can't keep up
+    uint64_t frame_budget = (uint64_t) (1.0e6f / g_target_fps);
+    for (SessionStats *stats : { &g_window_stats, &g_session_stats })
+    {
+        stats->metrics[METRIC_FRAME].set_budget(frame_budget);
+        stats->metrics[METRIC_STEP].set_budget((uint64_t) (g_fixed_timestep * 1.0e6f));
+        stats->metrics[METRIC_RENDER].set_budget(frame_budget);
+    }
+    g_stats_window_start = SDL_GetPerformanceCounter();
+
+    // From here on only the render thread touches GL
+    if (g_threaded_rendering && !g_software_rendering) SDL_GL_MakeCurrent(g_display_window, nullptr);
+    g_render_thread.start(g_display_window, g_gl_context, &g_shaders, g_font_texture_id,
+                          g_threaded_rendering, g_software_rendering ? &g_software_renderer : nullptr);
+}
+
+// Everything the game needs from GL: shaders, textures and state. Works against whichever
+// backend g_gl points at.
+void load_scene()
+{
+    g_gl.Viewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
-    g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
+    // The driver can compile the shaders while the textures upload
+    ShaderManager shaders;
+    g_shaders.set_sources(V_SHADER_PATH, F_SHADER_PATH);
+    if (g_shader_report)
+    {
+        for (uint32_t key = 0; key < SHADER_VARIANT_COUNT; key++)
+            if (is_valid_shader_key(key)) g_shaders.add(shaders, key);
+    }
+    else
+    {
+        for (uint32_t key : RENDER_SHADER_KEYS) g_shaders.add(shaders, key);
+    }
+    if (g_shader_cache_path != nullptr) shaders.use_cache(g_shader_cache_path);
+    shaders.start();
+
+    // Load textures only once. Font and explosion are loaded up front too, so that fixed
+    // steps never touch GL and can be re-simulated freely. Each is uploaded as soon as its
+    // decode is done, whatever order that is in.
+    // Packed rows of one and two byte texels needn't end on four-byte boundaries
+    g_gl.PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    queue_textures();
+    g_texture_bytes = g_rgba8_texture_bytes = 0;
+    g_asset_loader.upload_all([](int index, const DecodedImage &image) { g_texture_ids[index] = upload_texture(image); });
+    g_asset_loader.release();
+    if (g_startup_counter != 0) g_textures_ready_ms = milliseconds_since(g_startup_counter);
+    if (g_texture_report)
+        LOG("Textures: " << g_texture_bytes / 1024 << " KB, " << g_rgba8_texture_bytes / 1024 << " KB as RGBA8 ("
+            << (int) (100.0 * (1.0 - (double) g_texture_bytes / g_rgba8_texture_bytes)) << "% saved)");
+
+    if (!shaders.finish()) LOG("ERROR: Could not build every shader program.");
+    bool compiled_any = shaders.get_cached_count() < shaders.get_program_count();
+    LOG("Shaders: " << shaders.get_program_count() << " programs, " << shaders.get_cached_count()
+        << " from the binary cache; " << shaders.get_compile_ms() << " ms compiling, " << shaders.get_link_ms()
+        << " ms linking, " << shaders.get_binary_ms() << " ms loading binaries, " << shaders.get_wait_ms()
+        << " ms finishing" << (shaders.is_parallel() && compiled_any ? " (compiled in parallel by the driver)" : ""));
+    if (g_shader_report) log_shader_variants();
 
     g_view_matrix       = glm::mat4(1.0f);
     g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
 
-    g_shader_program.set_projection_matrix(g_projection_matrix);
-    g_shader_program.set_view_matrix(g_view_matrix);
+    g_shaders.set_projection_matrix(g_projection_matrix);
+    g_shaders.set_view_matrix(g_view_matrix);
+    g_shaders.use(RENDER_SHADER_KEYS[0]);
+
+    g_gl.ClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    if (g_software_rendering)
+    {
+        g_software_renderer.set_projection_matrix(g_projection_matrix);
+        g_software_renderer.set_clear_colour(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    }
+
+    g_player_texture_id    = g_texture_ids[TEXTURE_PLAYER];
+    g_platform_texture_id  = g_texture_ids[TEXTURE_PLATFORM];
+    g_asteroid_texture_id  = g_texture_ids[TEXTURE_ASTEROIDS];
+    g_font_texture_id      = g_texture_ids[TEXTURE_FONT];
+    g_explosion_texture_id = g_texture_ids[TEXTURE_EXPLOSION];
+
+    initialise_simulation();
+
+    // ————— OTHERS ————— //
+    g_game_state.others = new Entity[FUEL_GAUGE_COUNT];
+    for (int i = 0; i < FUEL_GAUGE_COUNT; i++)
+    {
+        GLuint fuel_texture_id = g_texture_ids[TEXTURE_FUEL_GAUGE + i];
+        g_game_state.others[i] = Entity(fuel_texture_id, 0.0f, 1, 1, 1);
+        g_game_state.others[i].set_position(glm::vec3(4.5f, 3.5f, 0.0f));
+        g_game_state.others[i].set_scale(glm::vec3(0.5f, 0.25f, 0.0f));
+        g_game_state.others[i].face_right();
+        g_game_state.others[i].update(0.0f, nullptr, 0);
+    }
 
-    glUseProgram(g_shader_program.get_program_id());
+    // Shown before the run starts. Loaded here rather than every frame, since GL now lives on
+    // the render thread.
+    g_full_fuel_gauge = Entity(g_texture_ids[TEXTURE_FULL_FUEL], 0.0f, 1, 1, 1);
+    g_full_fuel_gauge.set_position(glm::vec3(4.5f, 3.5f, 0.0f));
+    g_full_fuel_gauge.set_scale(glm::vec3(0.5f, 0.25f, 0.0f));
+    g_full_fuel_gauge.face_right();
+    g_full_fuel_gauge.update(0.0f, nullptr, 0);
 
-    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    // ————— GENERAL ————— //
+    g_gl.Enable(GL_BLEND);
+    g_gl.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
 
+// Everything the fixed steps need, without touching SDL or GL, so that replays can run headless
+void initialise_simulation()
+{
     // ————— PLAYER ————— //
-    GLuint player_texture_id = load_texture(SPACESHIP_FILEPATH);
+    g_game_state.player = new Entity();
+    reset_player();
+
+    // ————— COLLIDABLES ————— //
+    // Allocate memory for collidables
+    g_game_state.collidables = new Entity[PLATFORM_COUNT + ASTEROID_COUNT];
+
+    if (!g_has_level_seed) g_level_seed = (uint64_t) std::time(nullptr);
 
-    g_game_state.player = new Entity(
-        player_texture_id,         // texture id
+    g_level_parameters.max_asteroids    = ASTEROID_COUNT;
+    g_level_parameters.platform_count   = PLATFORM_COUNT;
+    g_level_parameters.spawn_position   = glm::vec2(g_game_state.player->get_position());
+    build_level(g_level_seed);
+
+    start_recording();
+}
+
+void reset_player()
+{
+    *g_game_state.player = Entity(
+        g_player_texture_id,       // texture id
         1.0f,                      // speed
         9,                         // current animation index
         5,                         // animation column amount
@@ -249,265 +727,1543 @@ void initialise()
     g_game_state.player->set_width(g_game_state.player->get_width() * 0.5f);
     g_game_state.player->set_acceleration(glm::vec3(0.0f, ACC_OF_GRAVITY * 0.005, 0.0f));
     g_game_state.player->update(0.0f, nullptr, 0);
+}
 
-    // ————— COLLIDABLES ————— //
-    // Allocate memory for collidables
-    g_game_state.collidables = new Entity[PLATFORM_COUNT + ASTEROID_COUNT];
-    
+// ————— REPLAYS ————— //
+// Hashes the raw bits of the simulated state. In the fixed-point build every one of these floats
+// is an exact image of a Q16.16 value, so equal hashes mean bit-identical simulations.
+uint64_t hash_sim_state()
+{
+    glm::vec3 position     = g_game_state.player->get_position(),
+              velocity     = g_game_state.player->get_velocity(),
+              acceleration = g_game_state.player->get_acceleration();
+
+    uint64_t hash = hash_bytes(&position, sizeof(position));
+    hash = hash_bytes(&velocity,     sizeof(velocity),     hash);
+    hash = hash_bytes(&acceleration, sizeof(acceleration), hash);
+    hash = hash_bytes(&fuel,         sizeof(fuel),         hash);
+    hash = hash_bytes(&isRunning,    sizeof(isRunning),    hash);
+    hash = hash_bytes(&gameStat,     sizeof(gameStat),     hash);
+
+    for (int i = PLATFORM_COUNT; i < PLATFORM_COUNT + ASTEROID_COUNT; i++)
+    {
+        glm::vec3 asteroid_position = g_game_state.collidables[i].get_position(),
+                  asteroid_velocity = g_game_state.collidables[i].get_velocity();
+        hash = hash_bytes(&asteroid_position, sizeof(asteroid_position), hash);
+        hash = hash_bytes(&asteroid_velocity, sizeof(asteroid_velocity), hash);
+    }
+    return hash;
+}
 
-    // Seed the random number generator
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+void start_recording()
+{
+    if (g_record_path == nullptr) return;
+
+    g_replay.seed         = g_level_seed;
+    g_replay.physics_mode = BUILD_PHYSICS_MODE;
+    g_replay.tick_rate    = (uint32_t) std::lround(1.0f / g_fixed_timestep);
+    g_replay.integrator   = (uint32_t) g_integrator;
+    g_replay.gravity_mode  = (uint32_t) g_gravity_mode;
+    g_replay.opening_angle = g_opening_angle;
+    g_replay.inputs.clear();
+    g_replay_start_tick   = g_tick;
+}
 
-    // Load textures only once
-    GLuint platform_texture_id = load_texture(PLATFORM_FILEPATH);
-    GLuint asteroid_texture_id = load_texture(ASTEROIDS_FILEPATH);
+void record_input(uint32_t tick, TickInput input)
+{
+    if (g_record_path == nullptr || tick < g_replay_start_tick) return;
 
-    // Generate a random index for a special platform
-    int randomInt = std::rand() % PLATFORM_COUNT;
+    size_t index = tick - g_replay_start_tick;
+    if (index == g_replay.inputs.size()) g_replay.inputs.push_back(input);
+}
 
-    for (int i = 0; i < PLATFORM_COUNT + ASTEROID_COUNT; i++) {
-        if (i < PLATFORM_COUNT){
-            if (i == randomInt) {
-                g_game_state.collidables[i] = Entity(platform_texture_id, 0.0f, 0, 16, 16);
-                g_game_state.collidables[i].set_landingStatus(true);  // Special landing platform
-            } else {
-                g_game_state.collidables[i] = Entity(platform_texture_id, 0.0f, 5, 16, 16);
-                g_game_state.collidables[i].set_landingStatus(false); // Regular platform
-            }
-            
-            g_game_state.collidables[i].face_right();
-            g_game_state.collidables[i].set_position(glm::vec3(-4.75f + (i * 0.5f), -3.5f, 0.0f));
-            g_game_state.collidables[i].update(0.0f, nullptr, 0);
-        }
-        else {
-            float randomX = -4.0f + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX / 8.0f)); // Range -4.0 to 4.0
-            float randomY = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * 3.0f - 1.0f; // Range -1.0 to 2.0
-            g_game_state.collidables[i] = Entity(asteroid_texture_id, 0.0f, 0, 4, 1);
-            g_game_state.collidables[i].set_position(glm::vec3(randomX, randomY, 0.0f));
-            g_game_state.collidables[i].set_landingStatus(false);
-        }
-        g_game_state.collidables[i].set_scale(glm::vec3(0.5f, 0.5f, 0.0f));
-        //Drag the height and width closer to rendered entity
-        g_game_state.collidables[i].set_width(g_game_state.collidables[i].get_width() * 0.1f);
-        g_game_state.collidables[i].set_height(g_game_state.collidables[i].get_height() * 0.1f);
-        g_game_state.collidables[i].update(0.0f, nullptr, 0);
+void finish_recording()
+{
+    if (g_record_path == nullptr) return;
+
+    // Ticks still waiting on delayed input were simulated on a guess, so the live state
+    // can't vouch for the hash in that case
+    bool fully_confirmed = g_confirmed_ticks == g_tick;
+    g_replay.final_hash  = fully_confirmed ? hash_sim_state() : 0;
+
+    if (save_replay(g_record_path, g_replay))
+    {
+        LOG("Recorded " << g_replay.inputs.size() << " ticks to " << g_record_path
+            << ", state hash " << std::hex << g_replay.final_hash << std::dec);
     }
-    
-    
-    // ————— OTHERS ————— //
-    std::string first = "health_0";
-    std::string ext = ".png";
-    
-    g_game_state.others = new Entity[10];
-    for (int i = 0; i < 10; i++)
+    else
     {
-        std::string curr = first + std::to_string(i) + ext;
-        GLuint fuel_texture_id = load_texture(curr.c_str());
-        g_game_state.others[i] = Entity(fuel_texture_id, 0.0f, 1, 1, 1);
-        g_game_state.others[i].set_position(glm::vec3(4.5f, 3.5f, 0.0f));
-        g_game_state.others[i].set_scale(glm::vec3(0.5f, 0.25f, 0.0f));
-        g_game_state.others[i].face_right();
-        g_game_state.others[i].update(0.0f, nullptr, 0);
+        LOG("ERROR: Could not write replay to " << g_record_path);
     }
+    g_record_path = nullptr;
+}
 
-    
-
-
+// Loads a replay into g_replay and switches the simulation to the settings it was recorded with
+bool apply_replay(const char* filepath)
+{
+    if (!load_replay(filepath, g_replay))
+    {
+        LOG("ERROR: Could not read replay " << filepath);
+        return false;
+    }
+    if (g_replay.physics_mode != BUILD_PHYSICS_MODE)
+    {
+        LOG("WARNING: Replay was recorded with the other physics mode; hashes won't match");
+    }
 
-    // ————— GENERAL ————— //
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    g_level_seed     = g_replay.seed;
+    g_has_level_seed = true;
+    g_fixed_timestep = 1.0f / (float) g_replay.tick_rate;
+    g_integrator     = (Integrator) g_replay.integrator;
+    g_gravity_mode   = (GravityMode) g_replay.gravity_mode;
+    g_opening_angle  = g_replay.opening_angle;
+    return true;
 }
 
-void process_input()
+// Plays a replay back with no window or GL context and checks its final state hash. The run
+// is repeated to time the simulation, which is how the float and fixed-point builds compare.
+int run_replay(const char* filepath)
 {
-    // VERY IMPORTANT: If nothing is pressed, we don't want to go anywhere
-    g_game_state.player->set_movement(glm::vec3(0.0f));
+    if (!apply_replay(filepath)) return 1;
+    initialise_simulation();
 
-    SDL_Event event;
-    while (SDL_PollEvent(&event))
+    Uint64 start_counter = SDL_GetPerformanceCounter();
+    for (int run = 0; run < REPLAY_BENCHMARK_RUNS; run++)
     {
-        switch (event.type) {
-            // End game
-        case SDL_QUIT:
-        case SDL_WINDOWEVENT_CLOSE:
-            g_app_status = TERMINATED;
-            break;
+        reset_run_state();
+        for (const TickInput &input : g_replay.inputs) simulate_tick(input);
+    }
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start_counter;
 
-        case SDL_KEYDOWN:
-            switch (event.key.keysym.sym) {
-            case SDLK_q:
-                // Quit the game with a keystroke
-                g_app_status = TERMINATED;
-                break;
-            case SDLK_SPACE:
-                isRunning = true;
+    uint64_t hash = hash_sim_state();
+    double ticks  = (double) g_replay.inputs.size() * REPLAY_BENCHMARK_RUNS;
+    double ns_per_tick = ticks > 0 ? (double) elapsed * 1.0e9 / (double) SDL_GetPerformanceFrequency() / ticks : 0.0;
 
-            default:
-                break;
-            }
+    LOG("Replay: " << g_replay.inputs.size() << " ticks, "
+        << (BUILD_PHYSICS_MODE == PHYSICS_FIXED ? "fixed-point" : "float") << " physics, "
+        << ns_per_tick << "ns per tick");
+    LOG("State hash: " << std::hex << hash << std::dec);
 
-        default:
-            break;
-        }
+    bool matches = g_replay.final_hash == 0 || g_replay.final_hash == hash;
+    if (!matches)
+    {
+        LOG("MISMATCH: recording ended on " << std::hex << g_replay.final_hash << std::dec);
     }
 
-    const Uint8* key_state = SDL_GetKeyboardState(NULL);
-    
-    if (isRunning) {
-        if (key_state[SDL_SCANCODE_LEFT]){
-            if (fuel > 0) {
-                g_game_state.player->move_left();
-                fuel -= 0.3;
-            }
-        }
-        else if (key_state[SDL_SCANCODE_RIGHT]) {
-            if (fuel > 0) {
-                g_game_state.player->move_right();
-                fuel -= 0.3;
-            }
-        
-        }
-        else {
-            g_game_state.player->face_up();
-        }
-        
-        // This makes sure that the player can't move faster diagonally
-        if (glm::length(g_game_state.player->get_movement()) > 1.0f)
-            g_game_state.player->normalise_movement();
-    }
+    delete   g_game_state.player;
+    delete[] g_game_state.collidables;
+    return matches ? 0 : 1;
 }
 
-void update()
+// A scripted pilot for the soak test: launches, then swings left and right until the run ends
+TickInput soak_input(uint64_t tick)
 {
-    // ————— DELTA TIME ————— //
-    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
-    float delta_time = ticks - g_previous_ticks;
-    g_previous_ticks = ticks;
-
-    // ————— FIXED TIMESTEP ————— //
-    // STEP 1: Keep track of how much time has passed since last step
-    delta_time += g_time_accumulator;
-
-    // STEP 2: Accumulate the ammount of time passed while we're under our fixed timestep
-    if (delta_time < FIXED_TIMESTEP)
-    {
-        g_time_accumulator = delta_time;
-        return;
-    }
-
-    // STEP 3: Once we exceed our fixed timestep, apply that elapsed time into the
-    //         objects' update function invocation
-    while (delta_time >= FIXED_TIMESTEP)
-    {
-        // Notice that we're using FIXED_TIMESTEP as our delta time
-        if(isRunning){
-            g_font_texture_id = load_texture(FONTSHEET_FILEPATH);
-            int gameStatus = g_game_state.player->update(FIXED_TIMESTEP, g_game_state.collidables,
-                                                         PLATFORM_COUNT + ASTEROID_COUNT);
-            if(gameStatus == 1) {
-                gameMessage = 1;
-                gameStat = 1;
-                isRunning = false;
-            }
-            else if (gameStatus == 2) {
-                gameMessage = 2;
-                gameStat = 2;
-                isRunning = false;
-            }
-            if (g_game_state.player->get_position().x > 5.0f || g_game_state.player->get_position().x < -5.0f || gameStatus == 3) {
-                glm::vec3 curr_pos = g_game_state.player->get_position();
-                GLuint explosion_texture_id = load_texture(EXPLOSION_FILEPATH);
-                g_game_state.player = nullptr;
-                g_game_state.player = new Entity(
-                     explosion_texture_id,
-                     0.0f,
-                     1,
-                     8,
-                     1
-                );
-                g_game_state.player->set_position(curr_pos);
-                g_game_state.player->update(0.0f, nullptr, 0);
-                isRunning = false;
-                gameMessage = 2;
-                gameStat = 3;
-            }
-        }
-        delta_time -= FIXED_TIMESTEP;
-    }
+    TickInput input;
+    if (!isRunning) input.buttons |= INPUT_START;
 
-    g_time_accumulator = delta_time;
+    uint64_t phase = tick % 150;
+    if (phase < 40)                      input.buttons |= INPUT_LEFT;
+    else if (phase >= 75 && phase < 115) input.buttons |= INPUT_RIGHT;
+    return input;
 }
 
-void render()
+// Plays `ticks` fixed steps headless, restarting on a fresh level whenever a run ends, and
+// records and executes a frame of render commands against the null GL backend after every
+// step. Once warmed up, no step or frame may touch the heap, and the resident set must stay flat.
+int run_soak(uint64_t ticks)
 {
-    // ————— GENERAL ————— //
-    glClear(GL_COLOR_BUFFER_BIT);
+    gl_load_null();
+    load_scene();
+
+    RenderCommandList commands;
+    uint64_t warmup_ticks = std::min(SOAK_WARMUP_TICKS, ticks / 2);
+    AllocationCounts steady_start;
+    size_t steady_rss = 0;
+    uint64_t first_allocating_tick = 0;
+    uint64_t levels = 0;
+
+    Uint64 start_counter = SDL_GetPerformanceCounter();
+    for (uint64_t tick = 0; tick < ticks; tick++)
+    {
+        if (tick == warmup_ticks)
+        {
+            steady_start = allocation_totals();
+            steady_rss   = current_rss_bytes();
+        }
 
-    // ————— PLAYER ————— //
-    g_game_state.player->render(&g_shader_program);
+        if (gameStat != 0)
+        {
+            restart_level();
+            levels++;
+        }
 
-    // ————— COLLIDABLES ————— //
-    for (int i = 0; i < PLATFORM_COUNT + ASTEROID_COUNT; i++)
-        g_game_state.collidables[i].render(&g_shader_program);
-    
-    // ————— OTHERS ————— //
-    if (!isRunning) {
-        if(gameStat != 1 && gameStat != 2 && gameStat != 3) {
-            char INITHEALTH_FILEPATH[]   = "health_10.png";
-            GLuint init_health_texture_id = load_texture(INITHEALTH_FILEPATH);
-            Entity init_health = Entity(init_health_texture_id, 0.0f, 1, 1, 1);
-            init_health.set_position(glm::vec3(4.5f, 3.5f, 0.0f));
-            init_health.set_scale(glm::vec3(0.5f, 0.25f, 0.0f));
-            init_health.face_right();
-            init_health.update(0.0f, nullptr, 0);
-            init_health.render(&g_shader_program);
+        {
+            AllocationPhaseScope phase(ALLOCATION_UPDATE);
+            advance_tick(soak_input(tick));
         }
-    }
-    else {
-        if (static_cast<int>(std::round(fuel / 10.0f) == 0)) {
-            g_game_state.others[static_cast<int>(std::round(fuel / 10.0f))].render(&g_shader_program);
+        {
+            AllocationPhaseScope phase(ALLOCATION_RECORD);
+            commands.reset();
+            record_scene(commands);
         }
-        else {
-            g_game_state.others[static_cast<int>(std::round(fuel / 10.0f)) - 1].render(&g_shader_program);
+        {
+            AllocationPhaseScope phase(ALLOCATION_PRESENT);
+            commands.execute(&g_shaders);
+            g_gl_resources.collect();
         }
-    }
-    
-    
-    if(!isRunning && gameMessage != 0) {
-        if(gameMessage == 1)
+
+        if (tick >= warmup_ticks && first_allocating_tick == 0 &&
+            allocation_totals().allocations != steady_start.allocations)
         {
-            draw_text(&g_shader_program, g_font_texture_id, "MISSION SUCCESS", 0.5f, 0.05f,
-                      glm::vec3(-3.5f, 2.5f, 0.0f));
+            first_allocating_tick = tick;
+            LOG("Soak: first steady-state allocation at tick " << tick);
         }
-        else if(gameMessage == 2) {
-            draw_text(&g_shader_program, g_font_texture_id, "MISSION FAIL", 0.5f, 0.05f,
-                      glm::vec3(-2.5f, 2.5f, 0.0f));
+        if (tick % SOAK_RSS_SAMPLE_TICKS == 0)
+        {
+            LOG("Soak: tick " << tick << ", " << levels << " levels, RSS " << current_rss_bytes() / 1024 << " KB");
         }
     }
-    // ————— GENERAL ————— //
-    SDL_GL_SwapWindow(g_display_window);
-}
+    double seconds = (double) (SDL_GetPerformanceCounter() - start_counter) / (double) SDL_GetPerformanceFrequency();
+
+    AllocationCounts steady = allocation_totals();
+    uint64_t allocations = steady.allocations - steady_start.allocations;
+    size_t final_rss = current_rss_bytes();
+    bool rss_flat = final_rss <= steady_rss + SOAK_RSS_TOLERANCE;
+
+    LOG("Soak: " << ticks << " ticks over " << levels << " levels in " << seconds << "s, "
+        << allocations << " allocations (" << steady.bytes - steady_start.bytes << " bytes) after "
+        << warmup_ticks << " warm-up ticks");
+    LOG("Soak: RSS " << steady_rss / 1024 << " KB after warm-up, " << final_rss / 1024 << " KB at the end"
+        << (rss_flat ? "" : ", GROWING"));
+    uint64_t rejected_calls = gl_null_stats().errors;
+    if (rejected_calls > 0) LOG("Soak: " << rejected_calls << " GL calls rejected by the null backend");
+    for (int phase = 0; phase < ALLOCATION_PHASE_COUNT; phase++)
+    {
+        AllocationCounts counts = allocation_phase_totals((AllocationPhase) phase);
+        if (counts.allocations > 0) LOG("  " << ALLOCATION_PHASE_NAMES[phase] << ": " << counts.allocations
+                                        << " allocations since startup");
+    }
+
+    g_shaders.cleanup();
+    g_textures.clear();
+    g_texture_palettes.clear();
+    g_gl_resources.collect_all();
 
-void shutdown()
-{
-    SDL_Quit();
-    
     delete   g_game_state.player;
     delete[] g_game_state.collidables;
     delete[] g_game_state.others;
-}
 
+    bool passed = allocations == 0 && rss_flat && rejected_calls == 0;
+    LOG((passed ? "Soak: PASSED" : "Soak: FAILED"));
+    return passed ? 0 : 1;
+}
 
-int main(int argc, char* argv[])
+// Plays the scripted pilot three times from the same level: with inputs arriving on time, then
+// `delay_ticks` late so that mispredicted ticks get re-simulated, then late again but rewinding
+// on every arrival, so that every tick goes through the snapshot ring and its deltas whether
+// or not the guess was right. All three must end on the same state hash.
+int run_rollback_test(int delay_ticks)
 {
-    initialise();
+    if (delay_ticks >= ROLLBACK_CAPACITY)
+    {
+        LOG("ERROR: Input delay must be under " << ROLLBACK_CAPACITY << " ticks, the rollback history");
+        return 1;
+    }
+    if (!g_has_level_seed)
+    {
+        g_level_seed     = BENCHMARK_SEED;
+        g_has_level_seed = true;
+    }
+    const uint64_t level_seed = g_level_seed;
+    initialise_simulation();
+
+    // The pilot reacts to what it sees, which a guess changes, so its inputs are scripted once
+    // from the run without delay and both runs are fed the same ones
+    std::vector<TickInput> inputs;
+    inputs.reserve(ROLLBACK_TEST_TICKS);
+    const int RUN_COUNT = 3;
+    uint64_t hashes[RUN_COUNT] = { 0, 0, 0 };
+    bool confirmed = true;
+
+    for (int run = 0; run < RUN_COUNT; run++)
+    {
+        int delay = run == 0 ? 0 : delay_ticks;
+        g_input_source.set_delay_ticks(delay);
+        g_rewind_every_input = run == 2;
+        g_level_seed = level_seed - 1;
+        restart_level();
+
+        uint32_t resimulated_before = g_resimulated_ticks;
+        Uint64   counts_before      = g_resimulation_counts;
+        Uint64   start_counter      = SDL_GetPerformanceCounter();
+        for (uint64_t tick = 0; tick < ROLLBACK_TEST_TICKS; tick++)
+        {
+            if (run == 0)
+            {
+                if (gameStat != 0) break;
+                inputs.push_back(soak_input(tick));
+            }
+            else if (tick == inputs.size())
+            {
+                break;
+            }
+            advance_tick(inputs[tick]);
+        }
 
-    while (g_app_status == RUNNING)
+        // The inputs still on their way arrive as though the delay had run out
+        receive_inputs(g_tick + delay);
+        double seconds = (double) (SDL_GetPerformanceCounter() - start_counter) / (double) SDL_GetPerformanceFrequency();
+
+        confirmed   = confirmed && g_confirmed_ticks == g_tick;
+        hashes[run] = hash_sim_state();
+
+        uint32_t resimulated = g_resimulated_ticks - resimulated_before;
+        double resimulation_us = (double) (g_resimulation_counts - counts_before) * 1000000.0 /
+                                 (double) SDL_GetPerformanceFrequency();
+        LOG("Rollback test: " << inputs.size() << " ticks with " << delay << " ticks of input delay"
+            << (g_rewind_every_input ? ", rewinding on every input," : "") << " in "
+            << seconds * 1000.0 << "ms, " << resimulated << " ticks re-simulated at "
+            << (resimulated > 0 ? resimulation_us / resimulated : 0.0) << "us per tick, state hash "
+            << std::hex << hashes[run] << std::dec);
+    }
+
+    g_rewind_every_input = false;
+    delete   g_game_state.player;
+    delete[] g_game_state.collidables;
+
+    bool passed = confirmed && hashes[0] == hashes[1] && hashes[0] == hashes[2];
+    LOG((passed ? "Rollback test: PASSED" : "Rollback test: FAILED, the delayed run ended on a different state"));
+    return passed ? 0 : 1;
+}
+
+// Plays and draws `frames` frames against the null GL backend, so the whole frame can be timed
+// with no GPU, display or context. The frames are split into identical passes from the same
+// level; every pass must draw exactly the same thing, and the null driver must not reject
+// anything.
+int run_null_gl_benchmark(uint64_t frames)
+{
+    gl_load_null();
+    if (g_count_gl_calls) gl_enable_call_counting();
+    if (!g_has_level_seed)
     {
-        process_input();
-        update();
-        render();
+        g_level_seed     = BENCHMARK_SEED;
+        g_has_level_seed = true;
+    }
+    const uint64_t level_seed = g_level_seed;
+    load_scene();
+
+    // Each pass resets the null backend's counts for its checksum, so rejected calls are added
+    // up across loading, every pass and the cleanup
+    uint64_t rejected_calls = gl_null_stats().errors;
+
+    RenderCommandList commands;
+    Histogram frame_times[NULL_GL_PASSES];   // Nanoseconds
+    uint64_t checksums[NULL_GL_PASSES];
+    uint64_t update_ns = 0, record_ns = 0, execute_ns = 0;
+    uint64_t frames_per_pass = std::max(frames / NULL_GL_PASSES, (uint64_t) 1);
+    double to_ns = 1.0e9 / (double) SDL_GetPerformanceFrequency();
+    GLNullStats null_stats;
+
+    for (int pass = 0; pass < NULL_GL_PASSES; pass++)
+    {
+        // Back to the start of the same level, so every pass plays the same frames
+        g_level_seed = level_seed - 1;
+        restart_level();
+        gl_null_reset_stats();
+
+        // The camera is only uploaded when it changes, so every pass starts with none uploaded
+        g_shaders.forget_camera_uploads();
+
+        for (uint64_t frame = 0; frame < frames_per_pass; frame++)
+        {
+            if (gameStat != 0) restart_level();
+
+            Uint64 frame_start = SDL_GetPerformanceCounter();
+            advance_tick(soak_input(frame));
+            Uint64 record_start = SDL_GetPerformanceCounter();
+            commands.reset();
+            record_scene(commands);
+            Uint64 execute_start = SDL_GetPerformanceCounter();
+            commands.execute(&g_shaders);
+            gl_end_frame();
+            g_gl_resources.collect();
+            Uint64 frame_end = SDL_GetPerformanceCounter();
+
+            frame_times[pass].record((uint64_t) ((double) (frame_end - frame_start) * to_ns));
+            update_ns  += (uint64_t) ((double) (record_start - frame_start) * to_ns);
+            record_ns  += (uint64_t) ((double) (execute_start - record_start) * to_ns);
+            execute_ns += (uint64_t) ((double) (frame_end - execute_start) * to_ns);
+        }
+
+        null_stats = gl_null_stats();
+        checksums[pass] = null_stats.checksum;
+        rejected_calls += null_stats.errors;
+        LOG("Null GL: pass " << pass + 1 << ", p50 " << frame_times[pass].value_at_percentile(50.0) / 1000.0
+            << "us, p99 " << frame_times[pass].value_at_percentile(99.0) / 1000.0 << "us, checksum "
+            << std::hex << checksums[pass] << std::dec);
+    }
+
+    uint64_t best_p50 = frame_times[0].value_at_percentile(50.0), worst_p50 = best_p50;
+    bool deterministic = true;
+    for (int pass = 1; pass < NULL_GL_PASSES; pass++)
+    {
+        best_p50  = std::min(best_p50, frame_times[pass].value_at_percentile(50.0));
+        worst_p50 = std::max(worst_p50, frame_times[pass].value_at_percentile(50.0));
+        if (checksums[pass] != checksums[0]) deterministic = false;
+    }
+    double measured = (double) (frames_per_pass * NULL_GL_PASSES);
+
+    LOG("Null GL: " << frames_per_pass * NULL_GL_PASSES << " frames in " << NULL_GL_PASSES << " passes, seed "
+        << level_seed << ", best p50 " << best_p50 / 1000.0 << "us per frame, passes within "
+        << (best_p50 > 0 ? 100.0 * (double) (worst_p50 - best_p50) / (double) best_p50 : 0.0) << "%");
+    LOG("Null GL: update " << update_ns / measured / 1000.0 << "us, record " << record_ns / measured / 1000.0
+        << "us, execute " << execute_ns / measured / 1000.0 << "us per frame");
+    LOG("Null GL: " << null_stats.calls / (double) frames_per_pass << " calls and "
+        << null_stats.vertices / (double) frames_per_pass << " vertices per frame");
+    if (!deterministic) LOG("Null GL: MISMATCH, passes drew different frames");
+
+    gl_log_call_stats();
+    g_shaders.cleanup();
+    g_textures.clear();
+    g_texture_palettes.clear();
+    g_gl_resources.collect_all();
+    g_gl_resources.report_leaks();
+
+    rejected_calls += gl_null_stats().errors - null_stats.errors;
+    LOG("Null GL: " << rejected_calls << " rejected calls");
+    if (rejected_calls > 0)
+    {
+        LOG("Null GL: last calls before the end of the run:");
+        gl_null_log_recent_calls();
+    }
+
+    delete   g_game_state.player;
+    delete[] g_game_state.collidables;
+    delete[] g_game_state.others;
+
+    return deterministic && rejected_calls == 0 ? 0 : 1;
+}
+
+// Compares a frame read back from the offscreen framebuffer with its golden image, or records
+// the golden image if there isn't one yet. A mismatch is written next to it as _actual.
+GoldenResult check_golden(uint64_t frame, const unsigned char* pixels, int width, int height)
+{
+    char path[512];
+    snprintf(path, sizeof(path), GOLDEN_FILENAME_FORMAT, g_golden_directory, (unsigned long long) frame, "");
+
+    int golden_width, golden_height, number_of_components;
+    unsigned char* golden = stbi_load(path, &golden_width, &golden_height, &number_of_components, STBI_rgb_alpha);
+    if (golden == NULL)
+    {
+        if (!write_png(path, pixels, width, height))
+        {
+            LOG("ERROR: Could not write golden image " << path);
+            return GOLDEN_NOT_RECORDED;
+        }
+        LOG("Offscreen: recorded golden image " << path);
+        return GOLDEN_RECORDED;
+    }
+
+    bool same_size = golden_width == width && golden_height == height;
+    ImageDiff diff;
+    if (same_size) diff = diff_images(golden, pixels, (size_t) width * height, g_golden_tolerance);
+    stbi_image_free(golden);
+    if (same_size && diff.differing_pixels == 0) return GOLDEN_MATCHED;
+
+    snprintf(path, sizeof(path), GOLDEN_FILENAME_FORMAT, g_golden_directory, (unsigned long long) frame, "_actual");
+    write_png(path, pixels, width, height);
+    if (!same_size)
+    {
+        LOG("MISMATCH: frame " << frame << " is " << width << "x" << height << ", its golden image "
+            << golden_width << "x" << golden_height << "; wrote " << path);
+    }
+    else
+    {
+        LOG("MISMATCH: frame " << frame << ", " << diff.differing_pixels << " pixels differ by up to "
+            << diff.max_difference << "; wrote " << path);
+    }
+    return GOLDEN_MISMATCHED;
+}
+
+// Renders frames into an offscreen framebuffer with no window: a replay's ticks if --replay is
+// given, otherwise the scripted pilot. Frames are read back a few behind the one being drawn.
+// The first pass checks every GOLDEN_INTERVAL-th frame against the golden images; the passes
+// after it replay the same frames to time rendering and readback. With --software the CPU
+// rasterizer draws them instead, so its frames are checked against goldens recorded from GL.
+int run_offscreen(uint64_t frames)
+{
+    if (g_replay_path != nullptr)
+    {
+        if (!apply_replay(g_replay_path)) return 1;
+        frames = g_replay.inputs.size();
+    }
+    else if (!g_has_level_seed)
+    {
+        g_level_seed     = BENCHMARK_SEED;
+        g_has_level_seed = true;
+    }
+    const uint64_t level_seed = g_level_seed;
+
+    // Missing goldens get recorded, so the directory only has to be there once, not filled
+    if (g_golden_directory != nullptr && !ensure_directory(g_golden_directory))
+    {
+        LOG("ERROR: Could not create the golden image directory " << g_golden_directory);
+        return 1;
+    }
+
+    OffscreenContext context;
+    FrameReadback readback;
+    bool ready;
+    if (g_software_rendering)
+    {
+        gl_load_null();
+        ready = g_software_renderer.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+        LOG("Offscreen: software rasterizer, " << RASTER_PATH_NAMES[g_software_renderer.get_path()] << " on "
+            << g_job_system.get_thread_count() << " threads");
+    }
+    else
+    {
+        if (!context.create())
+        {
+            LOG("ERROR: Could not create an offscreen OpenGL context.");
+            return 1;
+        }
+#ifdef _WINDOWS
+        glewInit();
+#endif
+        gl_load_native();
+        LOG("Offscreen: " << gl_string(GL_RENDERER) << ", OpenGL " << gl_string(GL_VERSION));
+
+        ready = readback.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (ready) readback.bind();
+    }
+    if (g_count_gl_calls) gl_enable_call_counting();
+    if (ready) load_scene();
+
+    // The software renderer's frame is ready as soon as render() returns, so it skips the readback
+    std::vector<unsigned char> software_pixels(g_software_rendering ? (size_t) WINDOW_WIDTH * WINDOW_HEIGHT * 4 : 0);
+
+    RenderCommandList commands;
+    uint64_t golden_results[GOLDEN_RESULT_COUNT] = {};
+    uint64_t sprites = 0, draws = 0;
+    double best_render_seconds = 0.0, worst_render_seconds = 0.0, best_wall_seconds = 0.0;
+    double to_seconds = 1.0 / (double) SDL_GetPerformanceFrequency();
+
+    for (int pass = 0; ready && pass <= OFFSCREEN_TIMED_PASSES; pass++)
+    {
+        bool checking = pass == 0 && g_golden_directory != nullptr;
+
+        // Back to the start of the same level, so every pass draws the same frames
+        g_level_seed = level_seed - 1;
+        restart_level();
+        sprites = 0;
+        draws   = 0;
+        Uint64 render_ticks = 0;
+        Uint64 pass_start   = SDL_GetPerformanceCounter();
+
+        for (uint64_t frame = 0; frame <= frames; frame++)
+        {
+            Uint64 render_start;
+            if (frame < frames)
+            {
+                if (g_replay_path == nullptr && gameStat != 0) restart_level();
+                simulate_tick(g_replay_path != nullptr ? g_replay.inputs[frame] : soak_input(frame));
+                commands.reset();
+                record_scene(commands);
+
+                render_start = SDL_GetPerformanceCounter();
+                if (!g_software_rendering)
+                {
+                    RenderStats stats = commands.execute(&g_shaders);
+                    sprites += stats.sprites;
+                    draws   += stats.draw_calls;
+                }
+                else
+                {
+                    RenderStats stats = g_software_renderer.render(commands);
+                    sprites += stats.sprites;
+                    draws   += stats.draw_calls;
+                    if (checking && frame % GOLDEN_INTERVAL == 0)
+                    {
+                        g_software_renderer.copy_pixels(software_pixels.data());
+                        golden_results[check_golden(frame, software_pixels.data(), WINDOW_WIDTH, WINDOW_HEIGHT)]++;
+                    }
+                }
+            }
+            else
+            {
+                render_start = SDL_GetPerformanceCounter();
+            }
+
+            // Past the last frame, drain whatever is still in flight
+            while (readback.is_full() || (frame == frames && readback.has_pending()))
+            {
+                uint64_t collected_frame;
+                const unsigned char* pixels = readback.collect(collected_frame);
+                if (checking && pixels != nullptr && collected_frame % GOLDEN_INTERVAL == 0)
+                {
+                    golden_results[check_golden(collected_frame, pixels, readback.get_width(), readback.get_height())]++;
+                }
+            }
+            if (frame < frames && !g_software_rendering) readback.queue(frame);
+            render_ticks += SDL_GetPerformanceCounter() - render_start;
+        }
+
+        double render_seconds = (double) render_ticks * to_seconds;
+        double wall_seconds   = (double) (SDL_GetPerformanceCounter() - pass_start) * to_seconds;
+        if (pass == 0) continue;
+
+        if (pass == 1 || render_seconds < best_render_seconds)
+        {
+            best_render_seconds = render_seconds;
+            best_wall_seconds   = wall_seconds;
+        }
+        worst_render_seconds = std::max(worst_render_seconds, render_seconds);
+    }
+
+    if (ready)
+    {
+        if (g_golden_directory != nullptr)
+        {
+            LOG("Offscreen: " << golden_results[GOLDEN_MATCHED] + golden_results[GOLDEN_MISMATCHED]
+                << " golden images checked, " << golden_results[GOLDEN_MISMATCHED] << " mismatched (tolerance "
+                << g_golden_tolerance << "), " << golden_results[GOLDEN_RECORDED] << " recorded");
+            if (golden_results[GOLDEN_NOT_RECORDED] > 0)
+                LOG("ERROR: " << golden_results[GOLDEN_NOT_RECORDED] << " golden images could not be recorded");
+        }
+        LOG("Offscreen: " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << ", " << frames << " frames, best of "
+            << OFFSCREEN_TIMED_PASSES << " passes: " << frames / best_render_seconds << " frames/s and "
+            << sprites / best_render_seconds << " sprites/s drawn and read back in "
+            << (double) draws / frames << " draw calls a frame, " << frames / best_wall_seconds
+            << " frames/s with the simulation (passes within "
+            << 100.0 * (worst_render_seconds - best_render_seconds) / best_render_seconds << "%)");
+    }
+
+    gl_log_call_stats();
+    readback.destroy();
+    g_software_renderer.destroy();
+    g_shaders.cleanup();
+    g_textures.clear();
+    g_texture_palettes.clear();
+    g_gl_resources.collect_all();
+    g_gl_resources.report_leaks();
+    context.destroy();
+
+    delete   g_game_state.player;
+    delete[] g_game_state.collidables;
+    delete[] g_game_state.others;
+
+    bool passed = golden_results[GOLDEN_MISMATCHED] == 0 && golden_results[GOLDEN_NOT_RECORDED] == 0;
+    return ready && passed ? 0 : 1;
+}
+
+// Lays out the platforms and asteroids for `seed`. The same seed always gives the same level.
+void build_level(uint64_t seed)
+{
+    generate_level(seed, g_level_parameters, g_level_layout);
+    LOG("Level seed: " << seed);
+
+    for (int i = 0; i < PLATFORM_COUNT + ASTEROID_COUNT; i++) {
+        if (i < PLATFORM_COUNT){
+            if (i == g_level_layout.landing_pad) {
+                g_game_state.collidables[i] = Entity(g_platform_texture_id, 0.0f, 0, 16, 16);
+                g_game_state.collidables[i].set_landingStatus(true);  // Special landing platform
+            } else {
+                g_game_state.collidables[i] = Entity(g_platform_texture_id, 0.0f, 5, 16, 16);
+                g_game_state.collidables[i].set_landingStatus(false); // Regular platform
+            }
+            
+            g_game_state.collidables[i].face_right();
+            g_game_state.collidables[i].set_position(glm::vec3(g_level_parameters.platform_start_x +
+                                                               (i * g_level_parameters.platform_step_x), -3.5f, 0.0f));
+            g_game_state.collidables[i].update(0.0f, nullptr, 0);
+        }
+        else {
+            // A dense enough field could come back with fewer asteroids than we have slots for;
+            // park the spares far off-screen where nothing can reach them
+            int asteroid = i - PLATFORM_COUNT;
+            glm::vec2 position = asteroid < (int) g_level_layout.asteroids.size() ?
+                                 g_level_layout.asteroids[asteroid] : glm::vec2(0.0f, 100.0f);
+            g_game_state.collidables[i] = Entity(g_asteroid_texture_id, 0.0f, 0, 4, 1);
+            g_game_state.collidables[i].set_position(glm::vec3(position, 0.0f));
+            g_game_state.collidables[i].set_landingStatus(false);
+
+            // Spares have no mass, so they stay parked even when asteroids pull on each other
+            g_asteroid_masses[asteroid] = asteroid < (int) g_level_layout.asteroids.size() ? ASTEROID_MASS : 0.0f;
+        }
+        g_game_state.collidables[i].set_scale(glm::vec3(0.5f, 0.5f, 0.0f));
+        //Drag the height and width closer to rendered entity
+        g_game_state.collidables[i].set_width(g_game_state.collidables[i].get_width() * 0.1f);
+        g_game_state.collidables[i].set_height(g_game_state.collidables[i].get_height() * 0.1f);
+        g_game_state.collidables[i].update(0.0f, nullptr, 0);
+    }
+}
+
+// Fresh level from the next seed. The layout isn't part of the rollback snapshots, so the
+// history from the previous level is dropped.
+void reset_run_state()
+{
+    reset_player();
+
+    fuel        = physics_scalar(100.0f);
+    isRunning   = false;
+    gameMessage = 0;
+    gameStat    = 0;
+}
+
+void restart_level()
+{
+    // A replay covers a single level, so it ends here
+    finish_recording();
+
+    g_level_seed++;
+    build_level(g_level_seed);
+    reset_run_state();
+
+    g_rollback.reset();
+    g_input_source.clear();
+    g_confirmed_ticks      = g_tick;
+    g_last_confirmed_input = TickInput();
+}
+
+float milliseconds_since(Uint64 start_counter)
+{
+    return (float) ((double) (SDL_GetPerformanceCounter() - start_counter) * MILLISECONDS_IN_SECOND /
+                    (double) SDL_GetPerformanceFrequency());
+}
+
+uint64_t microseconds_since(Uint64 start_counter)
+{
+    return (uint64_t) ((double) (SDL_GetPerformanceCounter() - start_counter) * 1.0e6 /
+                       (double) SDL_GetPerformanceFrequency());
+}
+
+void handle_event(const SDL_Event &event)
+{
+    switch (event.type) {
+        // End game
+    case SDL_QUIT:
+    case SDL_WINDOWEVENT_CLOSE:
+        g_app_status = TERMINATED;
+        break;
+
+    case SDL_KEYDOWN:
+        switch (event.key.keysym.sym) {
+        case SDLK_q:
+            // Quit the game with a keystroke
+            g_app_status = TERMINATED;
+            break;
+        case SDLK_SPACE:
+            // Consumed by the next fixed step so that it ends up in the rollback history
+            g_start_requested = true;
+            break;
+        case SDLK_r:
+            g_restart_requested = true;
+            break;
+        case SDLK_BACKSPACE:
+            // Practice mode: jump back a couple of seconds and try again
+            g_rewind_requested = true;
+            break;
+        case SDLK_F1:
+            g_show_overlay = !g_show_overlay;
+            break;
+#ifdef ENABLE_PROFILER
+        case SDLK_F2:
+            // Snapshot of the last few seconds of zones on every thread
+            if (profiler_write_chrome_trace(g_trace_path)) LOG("Wrote trace to " << g_trace_path);
+            break;
+#endif
+
+        default:
+            break;
+        }
+
+    default:
+        break;
+    }
+}
+
+// Nothing moves until the player starts, so there is no point drawing frames that look
+// exactly like the last one
+bool const is_idle()
+{
+    return !isRunning && !g_start_requested && !g_restart_requested && !g_rewind_requested;
+}
+
+void process_input()
+{
+    PROFILE_FUNCTION();
+    SDL_Event event;
+
+    // Nothing is on screen until the first frame is out, so don't wait for input before that
+    if (is_idle() && g_startup_counter == 0)
+    {
+        g_frame_pacer.note_idle_wait();
+        if (SDL_WaitEventTimeout(&event, IDLE_WAIT_MS)) handle_event(event);
+    }
+
+    while (SDL_PollEvent(&event)) handle_event(event);
+}
+
+TickInput sample_local_input()
+{
+    TickInput input;
+    const Uint8* key_state = SDL_GetKeyboardState(NULL);
+
+    if (key_state[SDL_SCANCODE_LEFT])  input.buttons |= INPUT_LEFT;
+    if (key_state[SDL_SCANCODE_RIGHT]) input.buttons |= INPUT_RIGHT;
+    if (g_start_requested)
+    {
+        input.buttons |= INPUT_START;
+        g_start_requested = false;
+    }
+    return input;
+}
+
+// Until a tick's real input shows up we assume the player is still holding whatever they
+// held last. Start is an edge, not a held button, so it is never predicted.
+TickInput predict_input()
+{
+    TickInput prediction = g_last_confirmed_input;
+    prediction.buttons &= ~INPUT_START;
+    return prediction;
+}
+
+void save_sim_state(SimState &state)
+{
+    state.player      = *g_game_state.player;
+    state.fuel        = fuel;
+    state.isRunning   = isRunning;
+    state.gameMessage = gameMessage;
+    state.gameStat    = gameStat;
+
+    for (int i = 0; i < ASTEROID_COUNT; i++)
+    {
+        const Entity &asteroid = g_game_state.collidables[PLATFORM_COUNT + i];
+        state.asteroid_positions[i]  = glm::vec2(asteroid.get_position());
+        state.asteroid_velocities[i] = glm::vec2(asteroid.get_velocity());
+    }
+}
+
+void load_sim_state(const SimState &state)
+{
+    *g_game_state.player = state.player;
+    fuel        = state.fuel;
+    isRunning   = state.isRunning;
+    gameMessage = state.gameMessage;
+    gameStat    = state.gameStat;
+
+    for (int i = 0; i < ASTEROID_COUNT; i++)
+    {
+        Entity &asteroid = g_game_state.collidables[PLATFORM_COUNT + i];
+        asteroid.set_position(glm::vec3(state.asteroid_positions[i], 0.0f));
+        asteroid.set_velocity(glm::vec3(state.asteroid_velocities[i], 0.0f));
+        asteroid.update(0.0f, nullptr, 0);
+    }
+}
+
+// Asteroid gravity mode: every asteroid pulls on the lander and on every other asteroid. The
+// tree is rebuilt every tick since the asteroids move; with a handful of bodies it is a single
+// leaf, but the same path holds up for fields of 100k (see --gravity-benchmark). The field itself
+// is summed in float, so it is only as reproducible as the compiler flags are.
+void apply_asteroid_gravity()
+{
+    Entity *asteroids = g_game_state.collidables + PLATFORM_COUNT;
+    for (int i = 0; i < ASTEROID_COUNT; i++) g_asteroid_positions[i] = glm::vec2(asteroids[i].get_position());
+    g_gravity_tree.build(g_asteroid_positions, g_asteroid_masses, ASTEROID_COUNT);
+
+    glm::vec2 pull = g_gravity_tree.acceleration_at(glm::vec2(g_game_state.player->get_position()), g_opening_angle);
+    g_game_state.player->set_field_acceleration(glm::vec3(pull, 0.0f));
+
+    for (int i = 0; i < ASTEROID_COUNT; i++)
+    {
+        if (g_asteroid_masses[i] == 0.0f) continue;
+
+        glm::vec2 field = g_gravity_tree.acceleration_at(g_asteroid_positions[i], g_opening_angle, i);
+        glm::vec3 position = asteroids[i].get_position(),
+                  velocity = asteroids[i].get_velocity();
+
+        integrate_free_motion<physics_scalar>(position, velocity, glm::vec3(field, 0.0f), g_fixed_timestep, g_integrator);
+        asteroids[i].set_position(position);
+        asteroids[i].set_velocity(velocity);
+        asteroids[i].update(0.0f, nullptr, 0);
+    }
+}
+
+void simulate_tick(TickInput input)
+{
+    PROFILE_SCOPE("fixed step");
+
+    // VERY IMPORTANT: If nothing is pressed, we don't want to go anywhere
+    g_game_state.player->set_movement(glm::vec3(0.0f));
+
+    if (input.is_down(INPUT_START)) isRunning = true;
+    if (!isRunning) return;
+
+    if (input.is_down(INPUT_LEFT)) {
+        if (fuel > physics_scalar(0.0f)) {
+            g_game_state.player->move_left();
+            fuel -= physics_scalar(FUEL_BURN_RATE) * physics_scalar(g_fixed_timestep);
+        }
+    }
+    else if (input.is_down(INPUT_RIGHT)) {
+        if (fuel > physics_scalar(0.0f)) {
+            g_game_state.player->move_right();
+            fuel -= physics_scalar(FUEL_BURN_RATE) * physics_scalar(g_fixed_timestep);
+        }
+    }
+    else {
+        g_game_state.player->face_up();
+    }
+
+    // This makes sure that the player can't move faster diagonally
+    if (glm::length(g_game_state.player->get_movement()) > 1.0f)
+        g_game_state.player->normalise_movement();
+
+    if (g_gravity_mode == GRAVITY_ASTEROIDS) apply_asteroid_gravity();
+
+    int gameStatus = g_game_state.player->update(g_fixed_timestep, g_game_state.collidables,
+                                                 PLATFORM_COUNT + ASTEROID_COUNT);
+    if(gameStatus == 1) {
+        gameMessage = 1;
+        gameStat = 1;
+        isRunning = false;
+    }
+    else if (gameStatus == 2) {
+        gameMessage = 2;
+        gameStat = 2;
+        isRunning = false;
+    }
+    if (g_game_state.player->get_position().x > 5.0f || g_game_state.player->get_position().x < -5.0f || gameStatus == 3) {
+        glm::vec3 curr_pos = g_game_state.player->get_position();
+        *g_game_state.player = Entity(
+             g_explosion_texture_id,
+             0.0f,
+             1,
+             8,
+             1
+        );
+        g_game_state.player->set_position(curr_pos);
+        g_game_state.player->update(0.0f, nullptr, 0);
+        isRunning = false;
+        gameMessage = 2;
+        gameStat = 3;
+    }
+}
+
+// Rewinds to `tick` and replays every tick up to the present with the (possibly replaced)
+// inputs stored in the rollback buffer. The ring is sized so this fits in one frame.
+void resimulate_from(uint32_t tick)
+{
+    if (!g_rollback.has_tick(tick) || tick >= g_tick) return;
+
+    Uint64 start_counter = SDL_GetPerformanceCounter();
+
+    int tick_count = (int) (g_tick - tick);
+    TickInput inputs[ROLLBACK_CAPACITY];
+    for (int i = 0; i < tick_count; i++)
+    {
+        inputs[i] = tick + i < g_confirmed_ticks ? g_rollback.get_input(tick + i) : predict_input();
+    }
+
+    g_rollback.load(tick, &g_sim_scratch);
+    load_sim_state(g_sim_scratch);
+    g_rollback.discard_after(tick);
+    g_rollback.set_input(tick, inputs[0]);
+    simulate_tick(inputs[0]);
+
+    for (int i = 1; i < tick_count; i++)
+    {
+        save_sim_state(g_sim_scratch);
+        g_rollback.push(tick + i, &g_sim_scratch, inputs[i]);
+        simulate_tick(inputs[i]);
+    }
+
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start_counter;
+    g_resimulated_ticks   += tick_count;
+    g_resimulation_counts += elapsed;
+
+    float elapsed_ms = (float) elapsed * MILLISECONDS_IN_SECOND / (float) SDL_GetPerformanceFrequency();
+    if (elapsed_ms > g_fixed_timestep * MILLISECONDS_IN_SECOND)
+    {
+        LOG("Rollback of " << tick_count << " ticks took " << elapsed_ms << "ms, over the frame budget");
+    }
+}
+
+// Practice-mode rewind: restores `tick` and forgets everything that happened after it
+void rewind_to_tick(uint32_t tick)
+{
+    if (!g_rollback.has_tick(tick)) tick = g_rollback.get_oldest_tick();
+    if (!g_rollback.has_tick(tick)) return;
+
+    g_rollback.load(tick, &g_sim_scratch);
+    load_sim_state(g_sim_scratch);
+
+    // The snapshot for `tick` itself is pushed again when it gets simulated
+    if (tick > g_rollback.get_oldest_tick()) g_rollback.discard_after(tick - 1);
+    else g_rollback.reset();
+
+    g_tick = tick;
+    g_confirmed_ticks = tick;
+    g_input_source.clear();
+
+    if (g_record_path != nullptr && tick >= g_replay_start_tick)
+    {
+        g_replay.inputs.resize(std::min<size_t>(g_replay.inputs.size(), tick - g_replay_start_tick));
+    }
+}
+
+// Takes every input that has arrived by `current_tick`, and re-simulates from the earliest
+// tick that was simulated on a wrong guess (or on any guess, with g_rewind_every_input)
+void receive_inputs(uint32_t current_tick)
+{
+    uint32_t earliest_misprediction = g_tick;
+    uint32_t arrived_tick;
+    TickInput arrived_input;
+    while (g_input_source.poll(current_tick, arrived_tick, arrived_input))
+    {
+        g_confirmed_ticks      = arrived_tick + 1;
+        g_last_confirmed_input = arrived_input;
+        record_input(arrived_tick, arrived_input);
+
+        if (arrived_tick < g_tick && g_rollback.has_tick(arrived_tick) &&
+            (g_rollback.get_input(arrived_tick) != arrived_input || g_rewind_every_input))
+        {
+            g_rollback.set_input(arrived_tick, arrived_input);
+            if (arrived_tick < earliest_misprediction) earliest_misprediction = arrived_tick;
+        }
+    }
+
+    if (earliest_misprediction < g_tick) resimulate_from(earliest_misprediction);
+}
+
+void advance_tick(TickInput local_input)
+{
+    g_input_source.push(g_tick, local_input);
+
+    // Delayed inputs may correct ticks we already simulated on a guess
+    receive_inputs(g_tick);
+
+    TickInput input = g_tick < g_confirmed_ticks ? g_last_confirmed_input : predict_input();
+
+    save_sim_state(g_sim_scratch);
+    g_rollback.push(g_tick, &g_sim_scratch, input);
+    simulate_tick(input);
+    g_tick++;
+}
+
+void update()
+{
+    PROFILE_FUNCTION();
+
+    // ————— DELTA TIME ————— //
+    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    float delta_time = ticks - g_previous_ticks;
+    g_previous_ticks = ticks;
+
+    // ————— FIXED TIMESTEP ————— //
+    // STEP 1: Keep track of how much time has passed since last step
+    delta_time += g_time_accumulator;
+
+    // STEP 2: Accumulate the ammount of time passed while we're under our fixed timestep
+    if (delta_time < g_fixed_timestep)
+    {
+        g_time_accumulator = delta_time;
+        return;
+    }
+
+    // STEP 3: Once we exceed our fixed timestep, apply that elapsed time into the
+    //         objects' update function invocation
+    if (g_restart_requested)
+    {
+        g_restart_requested = false;
+        restart_level();
+    }
+
+    if (g_rewind_requested)
+    {
+        g_rewind_requested = false;
+        uint32_t rewind_ticks = (uint32_t) (PRACTICE_REWIND_SECONDS / g_fixed_timestep);
+        rewind_to_tick(g_tick > rewind_ticks ? g_tick - rewind_ticks : 0);
+    }
+
+    while (delta_time >= g_fixed_timestep)
+    {
+        // Notice that we're using the fixed timestep as our delta time
+        Uint64 step_start = SDL_GetPerformanceCounter();
+        advance_tick(sample_local_input());
+        g_window_stats.metrics[METRIC_STEP].record(microseconds_since(step_start));
+        delta_time -= g_fixed_timestep;
+    }
+
+    g_time_accumulator = delta_time;
+}
+
+// Everything on screen. Nothing here may touch GL.
+void record_scene(RenderCommandList &commands)
+{
+    // ————— GENERAL ————— //
+    commands.push_clear();
+
+    // ————— PLAYER ————— //
+    g_game_state.player->record_render(commands);
+
+    // ————— COLLIDABLES ————— //
+    for (int i = 0; i < PLATFORM_COUNT + ASTEROID_COUNT; i++)
+        g_game_state.collidables[i].record_render(commands);
+    
+    // ————— OTHERS ————— //
+    if (!isRunning) {
+        if(gameStat != 1 && gameStat != 2 && gameStat != 3) {
+            g_full_fuel_gauge.record_render(commands);
+        }
+    }
+    else {
+        float fuel_left = (float) fuel;
+        if (static_cast<int>(std::round(fuel_left / 10.0f) == 0)) {
+            g_game_state.others[static_cast<int>(std::round(fuel_left / 10.0f))].record_render(commands);
+        }
+        else {
+            g_game_state.others[static_cast<int>(std::round(fuel_left / 10.0f)) - 1].record_render(commands);
+        }
+    }
+    
+    
+    if(!isRunning && gameMessage != 0) {
+        if(gameMessage == 1)
+        {
+            commands.push_text(g_font_texture_id, "MISSION SUCCESS", 0.5f, 0.05f,
+                               glm::vec3(-3.5f, 2.5f, 0.0f));
+        }
+        else if(gameMessage == 2) {
+            commands.push_text(g_font_texture_id, "MISSION FAIL", 0.5f, 0.05f,
+                               glm::vec3(-2.5f, 2.5f, 0.0f));
+        }
+    }
+}
+
+// Records the frame for the render thread
+void render()
+{
+    PROFILE_FUNCTION();
+    Uint64 record_start = SDL_GetPerformanceCounter();
+    RenderCommandList &commands = g_render_thread.begin_frame();
+    record_scene(commands);
+
+    g_main_timings.record_ms = milliseconds_since(record_start);
+    commands.set_overlay(g_main_timings, g_show_overlay);
+    g_render_thread.submit_frame();
+    g_window_stats.metrics[METRIC_RENDER].record(microseconds_since(record_start));
+}
+
+// Logs the percentiles every STATS_LOG_SECONDS, then starts a new window
+void record_frame_stats(bool sampled)
+{
+    if (sampled)
+    {
+        g_window_stats.metrics[METRIC_FRAME].record((uint64_t) (g_frame_pacer.get_last_interval() * 1.0e6));
+    }
+
+    float window_seconds = milliseconds_since(g_stats_window_start) / MILLISECONDS_IN_SECOND;
+    if (window_seconds < STATS_LOG_SECONDS) return;
+
+    for (int metric = 0; metric < METRIC_COUNT; metric++)
+    {
+        g_window_stats.metrics[metric].log_summary(SESSION_METRIC_NAMES[metric]);
+        g_session_stats.metrics[metric].merge(g_window_stats.metrics[metric]);
+        g_window_stats.metrics[metric].reset();
+    }
+    g_stats_window_start = SDL_GetPerformanceCounter();
+}
+
+// On every thread, including the render thread's work for the frame before
+void record_frame_allocations()
+{
+    AllocationCounts now = allocation_totals();
+    uint64_t allocations = now.allocations - g_frame_allocation_start.allocations;
+    g_frame_allocation_start = now;
+
+    if (allocations > 0) g_allocating_frames++;
+    g_worst_frame_allocations = std::max(g_worst_frame_allocations, allocations);
+}
+
+// Each built variant's location table, with - for what it doesn't declare
+void log_shader_variants()
+{
+    for (uint32_t key = 0; key < SHADER_VARIANT_COUNT; key++)
+    {
+        if (!g_shaders.is_built(key)) continue;
+
+        ShaderProgram *program = g_shaders.get(key);
+        std::string uniforms, attributes;
+        for (int uniform = 0; uniform < UNIFORM_COUNT; uniform++)
+        {
+            GLint location = program->get_uniform((ShaderUniform) uniform);
+            uniforms += std::string(" ") + SHADER_UNIFORM_NAMES[uniform] + "=" + (location < 0 ? "-" : std::to_string(location));
+        }
+        for (int attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+        {
+            GLint location = program->get_attribute((ShaderAttribute) attribute);
+            attributes += std::string(" ") + SHADER_ATTRIBUTE_NAMES[attribute] + "=" + (location < 0 ? "-" : std::to_string(location));
+        }
+        LOG("Shader variant " << key << " (" << g_shaders.get_name(key) << "): uniforms" << uniforms << ", attributes" << attributes);
+    }
+}
+
+// From entering main() to the first frame being handed to the renderer
+void log_startup()
+{
+    LOG("Startup: first frame after " << milliseconds_since(g_startup_counter) << " ms, textures ready after "
+        << g_textures_ready_ms << " ms (" << g_asset_loader.get_decoded_count() << " images decoded, "
+        << g_asset_loader.get_cached_count() << " from the texture cache, " << g_asset_loader.get_decode_ms()
+        << " ms of loading " << (g_asset_loader.is_parallel() ? "across " + std::to_string(g_job_system.get_thread_count()) + " threads"
+                                                                  : std::string("on the main thread"))
+        << ", " << g_asset_loader.get_arena_bytes() / 1024 << " KB load arena)");
+    g_startup_counter = 0;
+}
+
+void log_allocations()
+{
+    LOG("Allocations: " << g_allocating_frames << " frames allocated, at most " << g_worst_frame_allocations
+        << " in one frame, " << allocation_live_bytes() << " bytes live");
+    for (int phase = 0; phase < ALLOCATION_PHASE_COUNT; phase++)
+    {
+        AllocationCounts counts = allocation_phase_totals((AllocationPhase) phase);
+        uint64_t allocations = counts.allocations - g_loop_allocations[phase].allocations;
+        if (allocations == 0) continue;
+
+        LOG("  " << ALLOCATION_PHASE_NAMES[phase] << ": " << allocations << " allocations, "
+            << counts.bytes - g_loop_allocations[phase].bytes << " bytes");
+    }
+}
+
+void shutdown()
+{
+    finish_recording();
+    g_render_thread.stop();
+    g_render_thread.log_stats();
+    gl_log_call_stats();
+
+    // The context is current here again, so everything can go at once
+    g_gl_resources.log_stats();
+    g_shaders.cleanup();
+    g_textures.clear();
+    g_texture_palettes.clear();
+    g_software_renderer.destroy();
+    g_gl_resources.collect_all();
+    if (g_gl_resources.report_leaks() == 0) LOG("GL objects: all released");
+    g_frame_pacer.log_stats();
+
+    LOG("Session percentiles:");
+    for (int metric = 0; metric < METRIC_COUNT; metric++)
+    {
+        g_session_stats.metrics[metric].merge(g_window_stats.metrics[metric]);
+        g_session_stats.metrics[metric].log_summary(SESSION_METRIC_NAMES[metric]);
+    }
+    log_allocations();
+    if (g_stats_out_path != nullptr)
+    {
+        if (save_session_stats(g_stats_out_path, g_session_stats)) LOG("Saved session stats to " << g_stats_out_path);
+        else LOG("ERROR: Could not write session stats to " << g_stats_out_path);
+    }
+#ifdef ENABLE_PROFILER
+    if (profiler_write_chrome_trace(g_trace_path)) LOG("Wrote trace to " << g_trace_path);
+#endif
+    g_job_system.stop();
+    SDL_Quit();
+
+    if (g_resimulated_ticks > 0)
+    {
+        double total_us = (double) g_resimulation_counts * 1000000.0 / (double) SDL_GetPerformanceFrequency();
+        LOG("Rollback: re-simulated " << g_resimulated_ticks << " ticks at "
+            << total_us / g_resimulated_ticks << "us per tick");
+    }
+    LOG("Rollback: " << g_rollback.get_count() << " snapshots held in "
+        << g_rollback.get_memory_usage() << " bytes");
+    
+    delete   g_game_state.player;
+    delete[] g_game_state.collidables;
+    delete[] g_game_state.others;
+}
+
+
+void parse_arguments(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc)
+        {
+            // Simulated input latency in ticks, to exercise prediction and rollback locally
+            g_input_source.set_delay_ticks(std::atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            g_record_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            g_replay_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc)
+        {
+            g_fixed_timestep = 1.0f / (float) std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--integrator") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            if      (strcmp(name, "euler") == 0)       g_integrator = SEMI_IMPLICIT_EULER;
+            else if (strcmp(name, "verlet") == 0)      g_integrator = VELOCITY_VERLET;
+            else if (strcmp(name, "closed-form") == 0) g_integrator = CLOSED_FORM;
+            else LOG("Unknown integrator " << name << ", expected euler, verlet or closed-form");
+        }
+        else if (strcmp(argv[i], "--integrator-benchmark") == 0)
+        {
+            g_run_integrator_benchmark = true;
+        }
+        else if (strcmp(argv[i], "--gravity") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            if      (strcmp(name, "constant") == 0)  g_gravity_mode = GRAVITY_CONSTANT;
+            else if (strcmp(name, "asteroids") == 0) g_gravity_mode = GRAVITY_ASTEROIDS;
+            else LOG("Unknown gravity mode " << name << ", expected constant or asteroids");
+        }
+        else if (strcmp(argv[i], "--opening-angle") == 0 && i + 1 < argc)
+        {
+            g_opening_angle = std::max((float) std::atof(argv[++i]), 0.0f);
+        }
+        else if (strcmp(argv[i], "--gravity-benchmark") == 0)
+        {
+            // Body count is optional
+            g_gravity_benchmark_bodies = DEFAULT_GRAVITY_BENCHMARK_BODIES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_gravity_benchmark_bodies = std::max(std::atoi(argv[++i]), 10);
+        }
+        else if (strcmp(argv[i], "--render-thread") == 0 && i + 1 < argc)
+        {
+            // "off" records and executes the same command lists inline, for comparison
+            g_threaded_rendering = strcmp(argv[++i], "off") != 0;
+        }
+        else if (strcmp(argv[i], "--software") == 0)
+        {
+            g_software_rendering = true;
+        }
+        else if (strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+        {
+            g_asset_pack_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-pack") == 0)
+        {
+            g_asset_pack_path = nullptr;
+        }
+        else if (strcmp(argv[i], "--build-pack") == 0)
+        {
+            // Output path is optional
+            g_build_pack_path = DEFAULT_ASSET_PACK_FILEPATH;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_build_pack_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--pack-qoi") == 0)
+        {
+            g_pack_qoi = true;
+        }
+        else if (strcmp(argv[i], "--convert-qoi") == 0 && i + 2 < argc)
+        {
+            g_convert_qoi_paths[0] = argv[++i];
+            g_convert_qoi_paths[1] = argv[++i];
+        }
+        else if (strcmp(argv[i], "--qoi-benchmark") == 0)
+        {
+            g_run_qoi_benchmark = true;
+        }
+        else if (strcmp(argv[i], "--texture-cache") == 0 && i + 1 < argc)
+        {
+            g_texture_cache_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-texture-cache") == 0)
+        {
+            g_texture_cache_path = nullptr;
+        }
+        else if (strcmp(argv[i], "--shader-variants") == 0)
+        {
+            g_shader_report = true;
+        }
+        else if (strcmp(argv[i], "--shader-cache") == 0 && i + 1 < argc)
+        {
+            g_shader_cache_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-shader-cache") == 0)
+        {
+            g_shader_cache_path = nullptr;
+        }
+        else if (strcmp(argv[i], "--rgba8-textures") == 0)
+        {
+            g_pack_texture_formats = false;
+        }
+        else if (strcmp(argv[i], "--texture-formats") == 0)
+        {
+            g_texture_report = true;
+        }
+        else if (strcmp(argv[i], "--serial-load") == 0)
+        {
+            // Decodes every image on the main thread after the context is up, for comparison
+            g_serial_load = true;
+        }
+        else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc)
+        {
+            const char* name = argv[++i];
+            if      (strcmp(name, "off") == 0)      g_vsync_mode = VSYNC_OFF;
+            else if (strcmp(name, "on") == 0)       g_vsync_mode = VSYNC_ON;
+            else if (strcmp(name, "adaptive") == 0) g_vsync_mode = VSYNC_ADAPTIVE;
+            else LOG("Unknown vsync mode " << name << ", expected off, on or adaptive");
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            // Only used when vsync is off
+            g_target_fps = std::max((float) std::atof(argv[++i]), 1.0f);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            g_trace_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gl-stats") == 0)
+        {
+            g_count_gl_calls = true;
+        }
+        else if (strcmp(argv[i], "--gl-calls") == 0 && i + 1 < argc)
+        {
+            g_count_gl_calls = true;
+            g_gl_calls_path  = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stats-out") == 0 && i + 1 < argc)
+        {
+            g_stats_out_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--compare-stats") == 0 && i + 2 < argc)
+        {
+            g_compare_stats_paths[0] = argv[++i];
+            g_compare_stats_paths[1] = argv[++i];
+        }
+        else if (strcmp(argv[i], "--soak") == 0)
+        {
+            g_soak_ticks = DEFAULT_SOAK_TICKS;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_soak_ticks = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--rollback-test") == 0)
+        {
+            g_rollback_test_delay = DEFAULT_ROLLBACK_TEST_DELAY;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_rollback_test_delay = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--null-gl") == 0)
+        {
+            g_null_gl_frames = DEFAULT_NULL_GL_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_null_gl_frames = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--offscreen") == 0)
+        {
+            g_offscreen_frames = DEFAULT_OFFSCREEN_FRAMES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_offscreen_frames = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+        {
+            g_golden_directory = argv[++i];
+        }
+        else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc)
+        {
+            g_golden_tolerance = std::max(std::atoi(argv[++i]), 0);
+        }
+        else if (strcmp(argv[i], "--profiler-benchmark") == 0)
+        {
+            g_run_profiler_benchmark = true;
+        }
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+        {
+            g_thread_count = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--jobs-benchmark") == 0)
+        {
+            // Entity count is optional
+            g_jobs_benchmark_entities = DEFAULT_JOBS_BENCHMARK_ENTITIES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_jobs_benchmark_entities = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--software-benchmark") == 0)
+        {
+            g_software_benchmark_sprites = DEFAULT_SOFTWARE_BENCHMARK_SPRITES;
+            if (i + 1 < argc && argv[i + 1][0] != '-') g_software_benchmark_sprites = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            g_level_seed     = std::strtoull(argv[++i], nullptr, 10);
+            g_has_level_seed = true;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    g_startup_counter = SDL_GetPerformanceCounter();
+    parse_arguments(argc, argv);
+    if (g_thread_count == 0) g_thread_count = std::max((int) std::thread::hardware_concurrency(), 1);
+
+    if (g_build_pack_path != nullptr) return run_build_pack(g_build_pack_path);
+    mount_assets();
+    if (g_convert_qoi_paths[0] != nullptr) return run_qoi_conversion(g_convert_qoi_paths[0], g_convert_qoi_paths[1]);
+    if (g_run_qoi_benchmark)
+    {
+        const char* textures[TEXTURE_SLOT_COUNT];
+        texture_filepaths(textures);
+        return run_qoi_benchmark(textures, TEXTURE_SLOT_COUNT);
+    }
+
+    // Offscreen rendering uses --replay as its source of frames rather than replaying headless.
+    // The software rasterizer shades its tiles on the job system.
+    if (g_offscreen_frames > 0)
+    {
+        g_job_system.start(g_thread_count);
+        return run_offscreen(g_offscreen_frames);
+    }
+
+    // Replays stay on one thread so their timings compare the physics alone
+    if (g_replay_path != nullptr) return run_replay(g_replay_path);
+    if (g_rollback_test_delay > 0) return run_rollback_test(g_rollback_test_delay);
+    if (g_run_integrator_benchmark) return run_integrator_benchmark(ACC_OF_GRAVITY * 0.005f);
+    if (g_run_profiler_benchmark)   return run_profiler_benchmark();
+    if (g_compare_stats_paths[0] != nullptr) return run_stats_comparison(g_compare_stats_paths[0], g_compare_stats_paths[1]);
+    if (g_jobs_benchmark_entities > 0) return run_jobs_benchmark(g_jobs_benchmark_entities, g_thread_count);
+    if (g_software_benchmark_sprites > 0) return run_software_benchmark(g_software_benchmark_sprites, g_thread_count);
+
+    g_job_system.start(g_thread_count);
+    if (g_gravity_benchmark_bodies > 0) return run_gravity_benchmark(g_gravity_benchmark_bodies, g_opening_angle);
+    if (g_soak_ticks > 0) return run_soak(g_soak_ticks);
+    if (g_null_gl_frames > 0) return run_null_gl_benchmark(g_null_gl_frames);
+
+    PROFILE_THREAD_NAME("main");
+    initialise();
+
+    for (int phase = 0; phase < ALLOCATION_PHASE_COUNT; phase++)
+        g_loop_allocations[phase] = allocation_phase_totals((AllocationPhase) phase);
+    g_frame_allocation_start = allocation_totals();
+
+    while (g_app_status == RUNNING)
+    {
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        {
+            AllocationPhaseScope phase(ALLOCATION_INPUT);
+            process_input();
+        }
+        g_main_timings.input_ms = milliseconds_since(frame_start);
+
+        Uint64 update_start = SDL_GetPerformanceCounter();
+        {
+            AllocationPhaseScope phase(ALLOCATION_UPDATE);
+            update();
+        }
+        g_main_timings.update_ms = milliseconds_since(update_start);
+
+        {
+            AllocationPhaseScope phase(ALLOCATION_RECORD);
+            render();
+        }
+        record_frame_stats(g_frame_pacer.end_frame());
+        record_frame_allocations();
+        if (g_startup_counter != 0) log_startup();
     }
 
     shutdown();
@@ -1,5 +0,0 @@
-uniform vec4 color;
-
-void main() {
-    gl_FragColor = color;
-}
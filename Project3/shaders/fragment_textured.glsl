@@ -1,7 +0,0 @@
-
-uniform sampler2D diffuse;
-varying vec2 texCoordVar;
-
-void main() {
-    gl_FragColor = texture2D(diffuse, texCoordVar);
-}
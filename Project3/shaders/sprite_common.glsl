@@ -0,0 +1,5 @@
+// Shared by both sprite shaders. Each variant is compiled with one #define per feature in its
+// key: UNTEXTURED, PALETTE, BATCHED or INSTANCED.
+#ifndef UNTEXTURED
+varying vec2 texCoordVar;
+#endif
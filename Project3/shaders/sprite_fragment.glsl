@@ -0,0 +1,22 @@
+#include "sprite_common.glsl"
+
+#ifdef UNTEXTURED
+uniform vec4 color;
+#else
+uniform sampler2D diffuse;
+#endif
+#ifdef PALETTE
+uniform sampler2D palette;
+#endif
+
+void main() {
+#if defined(UNTEXTURED)
+    gl_FragColor = color;
+#elif defined(PALETTE)
+    // Index i is stored as i / 255, and palette entry i is centred on (i + 0.5) / 256
+    float index = texture2D(diffuse, texCoordVar).r;
+    gl_FragColor = texture2D(palette, vec2(index * (255.0 / 256.0) + 0.5 / 256.0, 0.5));
+#else
+    gl_FragColor = texture2D(diffuse, texCoordVar);
+#endif
+}
@@ -0,0 +1,28 @@
+#include "sprite_common.glsl"
+
+attribute vec4 position;
+#ifndef UNTEXTURED
+attribute vec2 texCoord;
+#endif
+
+// Batched positions already have their model matrix applied; instanced draws carry one each
+#if defined(INSTANCED)
+attribute mat4 instanceModel;
+#elif !defined(BATCHED)
+uniform mat4 modelMatrix;
+#endif
+uniform mat4 cameraMatrix;   // Projection times view, multiplied out once on the CPU
+
+void main()
+{
+#ifndef UNTEXTURED
+    texCoordVar = texCoord;
+#endif
+#if defined(INSTANCED)
+    gl_Position = cameraMatrix * (instanceModel * position);
+#elif defined(BATCHED)
+    gl_Position = cameraMatrix * position;
+#else
+    gl_Position = cameraMatrix * (modelMatrix * position);
+#endif
+}